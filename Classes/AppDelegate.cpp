@@ -25,6 +25,8 @@
 #include "AppDelegate.h"
 #include "ShapeGameScene.h"
 #include "ShapePool.h"
+#include "ShapeTextureAtlas.h"
+#include "ShapeGeometry.h"
 
 // #define USE_AUDIO_ENGINE 1
 
@@ -47,6 +49,8 @@ AppDelegate::~AppDelegate()
 {
     // ShapePool 정리
     ShapePool::DestroyInstance();
+    ShapeTextureAtlas::DestroyInstance();
+    ShapeGeometry::Clear();
     
 #if USE_AUDIO_ENGINE
     AudioEngine::end();
@@ -91,6 +95,9 @@ bool AppDelegate::applicationDidFinishLaunching() {
     // set FPS. the default value is 1.0/60 if you don't call this
     director->setAnimationInterval(1.0f / 60);
 
+    // 도형 아틀라스와 라벨이 섞여 있어도 겹치지 않는 것끼리 묶어서 배치가 끊기지 않게 함
+    director->getRenderer()->setBatchReorderingEnabled(true);
+
     // Set the design resolution
     glview->setDesignResolutionSize(m_designResolutionSize.width, m_designResolutionSize.height, ResolutionPolicy::NO_BORDER);
     auto frameSize = glview->getFrameSize();
@@ -126,6 +133,9 @@ bool AppDelegate::applicationDidFinishLaunching() {
 
 // This function will be called when the app is inactive. Note, when receiving a phone call it is invoked.
 void AppDelegate::applicationDidEnterBackground() {
+    // 중단되기 전에 현재 보드를 저장 (파일 쓰기는 IO 스레드에서 처리)
+    cocos2d::Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(ShapeGameScene::EVENT_SAVE_SNAPSHOT);
+
     cocos2d::Director::getInstance()->stopAnimation();
 
 #if USE_AUDIO_ENGINE
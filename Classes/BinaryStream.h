@@ -0,0 +1,51 @@
+#ifndef __BINARY_STREAM_H__
+#define __BINARY_STREAM_H__
+
+#include <cstring>
+#include <vector>
+
+// 저장 파일(입력 기록, 게임 스냅샷)용 단순 바이너리 쓰기/읽기
+// 값은 메모리 표현 그대로(리틀 엔디언 기기 기준) 기록함
+class BinaryWriter
+{
+public:
+    explicit BinaryWriter(std::vector<unsigned char>& buffer) : buffer(buffer) {}
+
+    template <typename T>
+    void Write(T value)
+    {
+        unsigned char bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+private:
+    std::vector<unsigned char>& buffer;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const unsigned char* data, size_t size) : cursor(data), end(data + size) {}
+
+    // 남은 데이터가 부족하면 false (값은 바뀌지 않음)
+    template <typename T>
+    bool Read(T& value)
+    {
+        if ((size_t)(end - cursor) < sizeof(T))
+            return false;
+
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+
+        return true;
+    }
+
+    size_t GetRemaining() const { return (size_t)(end - cursor); }
+
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+};
+
+#endif // __BINARY_STREAM_H__
\ No newline at end of file
@@ -26,13 +26,17 @@ void ComboSystem::Initialize(const Vec2& labelPosition)
     comboLabel->setVisible(false);
 }
 
-void ComboSystem::Update()
+void ComboSystem::Update(int mergeCount)
 {
+    if (mergeCount <= 0)
+        return;
+    
     float currentTime = getCurrentTime();
     
     if (comboCount == 0 || (currentTime - lastMergeTime) <= comboTimeWindow)
     {
-        comboCount++;
+        // 한 프레임에 여러 번 합쳐지면 한 번에 누적
+        comboCount += mergeCount;
         lastMergeTime = currentTime;
         
         if (comboCount >= 2)
@@ -43,10 +47,8 @@ void ComboSystem::Update()
             {
                 comboLabel->setScale(1.5f);
 
-                auto scaleAction = ScaleTo::create(0.3f, 1.0f);
-                auto easeAction = EaseBackOut::create(scaleAction);
-
-                comboLabel->runAction(easeAction);
+                // 액션 객체를 만들지 않는 트윈 사용 (진행 중인 크기 트윈은 새로 시작됨)
+                comboLabel->getActionManager()->tweenScaleTo(comboLabel, 0.3f, 1.0f, 1.0f, tweenfunc::Back_EaseOut);
             }
         }
     }
@@ -54,7 +56,7 @@ void ComboSystem::Update()
     else
     {
         Reset();
-        Update();
+        Update(mergeCount);
     }
 }
 
@@ -67,6 +69,20 @@ void ComboSystem::Reset()
         comboLabel->setVisible(false);
 }
 
+void ComboSystem::Restore(int comboCount, float elapsedSinceLastMerge)
+{
+    Reset();
+
+    // 콤보 시간이 이미 지났으면 복원하지 않음
+    if (comboCount <= 0 || elapsedSinceLastMerge > comboTimeWindow)
+        return;
+
+    this->comboCount = comboCount;
+    lastMergeTime = getCurrentTime() - elapsedSinceLastMerge;
+
+    UpdateDisplay();
+}
+
 void ComboSystem::UpdateDisplay()
 {
     if (comboLabel && comboCount >= 2)
@@ -117,5 +133,9 @@ void ComboSystem::RemoveFromParent()
 
 float ComboSystem::getCurrentTime() const
 {
+    // 씬의 시뮬레이션 시계를 쓰면 프레임 속도와 무관하게 콤보 시간이 일정함
+    if (timeSource)
+        return timeSource();
+
     return Director::getInstance()->getTotalFrames() / 60.0f;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define __COMBO_SYSTEM_H__
 
 #include "cocos2d.h"
+#include <functional>
 
 class ComboSystem
 {
@@ -10,16 +11,21 @@ public:
     ~ComboSystem();
     
     void Initialize(const cocos2d::Vec2& labelPosition);
-    void Update();
+    void Update(int mergeCount = 1);
     void Reset();
+    void Restore(int comboCount, float elapsedSinceLastMerge); // 스냅샷 복원용
     void UpdateDisplay();
     int CalculateBonus(int baseScore);
     
+    // 콤보 시간 판정에 사용할 시계 (지정하지 않으면 프레임 수 기반)
+    void SetTimeSource(const std::function<float()>& timeSource) { this->timeSource = timeSource; }
+    
     void AddToParent(cocos2d::Node* parent, int zOrder = 100);
     void RemoveFromParent();
     
     int GetComboCount() const { return comboCount; }
     bool IsComboActive() const { return comboCount >= 2; }
+    float GetElapsedSinceLastMerge() const { return getCurrentTime() - lastMergeTime; }
     
 private:
     cocos2d::Label* comboLabel;
@@ -28,6 +34,7 @@ private:
     int comboCount;
     float lastMergeTime;
     float comboTimeWindow;
+    std::function<float()> timeSource;
     
     float getCurrentTime() const;
 };
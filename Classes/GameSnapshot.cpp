@@ -0,0 +1,142 @@
+#include "GameSnapshot.h"
+#include "BinaryStream.h"
+#include "base/CCAsyncTaskPool.h"
+
+USING_NS_CC;
+
+const uint32_t GameSnapshot::FILE_MAGIC = 0x534D534D; // "MSMS"
+const uint16_t GameSnapshot::FILE_VERSION = 1;
+
+namespace
+{
+    // 헤더: magic(4) + version(2) + hasBoard(1) + score(4) + bestScore(4) + comboCount(4) + comboElapsed(4) + count(4)
+    // 도형: level(4) + scale(4) + position(8) + rotation(4) + velocity(8) + angularVelocity(4)
+    const size_t HEADER_SIZE = 27;
+    const size_t SHAPE_SIZE = 32;
+}
+
+GameSnapshot::GameSnapshot()
+    : score(0)
+    , bestScore(0)
+    , comboCount(0)
+    , comboElapsed(0.0f)
+    , hasBoard(false)
+{
+}
+
+std::string GameSnapshot::GetDefaultPath()
+{
+    return FileUtils::getInstance()->getWritablePath() + "GameSnapshot.bin";
+}
+
+bool GameSnapshot::Load(const std::string& path)
+{
+    if (!FileUtils::getInstance()->isFileExist(path))
+        return false;
+
+    Data data = FileUtils::getInstance()->getDataFromFile(path);
+
+    if (data.isNull() || !Deserialize(data.getBytes(), (size_t)data.getSize()))
+    {
+        CCLOG("GameSnapshot: %s is not a valid snapshot", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void GameSnapshot::SaveAsync(const std::string& path) const
+{
+    // 현재 상태를 메인 스레드에서 버퍼로 복사해 두고, 쓰기는 IO 스레드에 맡김
+    auto data = std::make_shared<Data>();
+    std::vector<unsigned char> buffer;
+
+    Serialize(buffer);
+    data->copy(buffer.data(), buffer.size());
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [data, path]()
+    {
+        // 임시 파일에 다 쓴 뒤 교체해서, 쓰는 도중 종료되어도 이전 스냅샷은 남아 있게 함
+        auto fileUtils = FileUtils::getInstance();
+        std::string tempPath = path + ".tmp";
+
+        if (!fileUtils->writeDataToFile(*data, tempPath) || !fileUtils->renameFile(tempPath, path))
+            CCLOG("GameSnapshot: failed to write %s", path.c_str());
+    });
+}
+
+void GameSnapshot::Serialize(std::vector<unsigned char>& buffer) const
+{
+    buffer.reserve(HEADER_SIZE + shapes.size() * SHAPE_SIZE);
+
+    BinaryWriter writer(buffer);
+    writer.Write<uint32_t>(FILE_MAGIC);
+    writer.Write<uint16_t>(FILE_VERSION);
+    writer.Write<uint8_t>(hasBoard ? 1 : 0);
+    writer.Write<int32_t>(score);
+    writer.Write<int32_t>(bestScore);
+    writer.Write<int32_t>(comboCount);
+    writer.Write<float>(comboElapsed);
+    writer.Write<uint32_t>((uint32_t)shapes.size());
+
+    for (const auto& shape : shapes)
+    {
+        writer.Write<int32_t>(shape.level);
+        writer.Write<float>(shape.scale);
+        writer.Write<float>(shape.position.x);
+        writer.Write<float>(shape.position.y);
+        writer.Write<float>(shape.rotation);
+        writer.Write<float>(shape.velocity.x);
+        writer.Write<float>(shape.velocity.y);
+        writer.Write<float>(shape.angularVelocity);
+    }
+}
+
+bool GameSnapshot::Deserialize(const unsigned char* bytes, size_t size)
+{
+    BinaryReader reader(bytes, size);
+
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    uint8_t boardFlag = 0;
+    int32_t savedScore = 0;
+    int32_t savedBestScore = 0;
+    int32_t savedComboCount = 0;
+    uint32_t count = 0;
+
+    if (!reader.Read(magic) || !reader.Read(version) || magic != FILE_MAGIC || version != FILE_VERSION)
+        return false;
+
+    if (!reader.Read(boardFlag) || !reader.Read(savedScore) || !reader.Read(savedBestScore) || !reader.Read(savedComboCount) ||
+        !reader.Read(comboElapsed) || !reader.Read(count))
+        return false;
+
+    if (reader.GetRemaining() < count * SHAPE_SIZE)
+        return false;
+
+    hasBoard = (boardFlag != 0);
+    score = savedScore;
+    bestScore = savedBestScore;
+    comboCount = savedComboCount;
+
+    shapes.clear();
+    shapes.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ShapeState shape;
+
+        reader.Read(shape.level);
+        reader.Read(shape.scale);
+        reader.Read(shape.position.x);
+        reader.Read(shape.position.y);
+        reader.Read(shape.rotation);
+        reader.Read(shape.velocity.x);
+        reader.Read(shape.velocity.y);
+        reader.Read(shape.angularVelocity);
+
+        shapes.push_back(shape);
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef __GAME_SNAPSHOT_H__
+#define __GAME_SNAPSHOT_H__
+
+#include "cocos2d.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 보드 전체 상태의 바이너리 스냅샷 (앱 중단/재개, 크래시 복구용)
+// 직렬화는 메인 스레드에서 하고 파일 쓰기만 IO 스레드에서 처리해 프레임을 막지 않음
+class GameSnapshot
+{
+public:
+    struct ShapeState
+    {
+        int32_t level;
+        float scale;
+        cocos2d::Vec2 position;
+        float rotation;
+        cocos2d::Vec2 velocity;
+        float angularVelocity;
+    };
+
+    GameSnapshot();
+
+    bool Load(const std::string& path);
+    void SaveAsync(const std::string& path) const;
+
+    static std::string GetDefaultPath();
+
+    int score;
+    int bestScore;
+    int comboCount;
+    float comboElapsed;     // 마지막 합치기 이후 지난 시뮬레이션 시간
+    bool hasBoard;          // 게임 오버 후 저장된 스냅샷은 베스트 스코어만 유효
+    std::vector<ShapeState> shapes;
+
+private:
+    void Serialize(std::vector<unsigned char>& buffer) const;
+    bool Deserialize(const unsigned char* bytes, size_t size);
+
+    static const uint32_t FILE_MAGIC;
+    static const uint16_t FILE_VERSION;
+};
+
+#endif // __GAME_SNAPSHOT_H__
\ No newline at end of file
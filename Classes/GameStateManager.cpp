@@ -9,7 +9,6 @@ GameStateManager::GameStateManager()
     , gameOverLabel(nullptr)
     , overlay(nullptr)
     , parentNode(nullptr)
-    , shapes(nullptr)
     , onRestartCallback(nullptr)
 {
 }
@@ -118,14 +117,6 @@ void GameStateManager::CleanupGameOverUI()
 
 void GameStateManager::CleanupShapes()
 {
-    if (shapes)
-    {
-        for (auto shape : *shapes)
-        {
-            if (shape)
-                ShapePool::GetInstance()->ReturnShape(shape);
-        }
-
-        shapes->clear();
-    }
+    // 활성 도형은 모두 풀이 관리하므로 한 번에 반환
+    ShapePool::GetInstance()->ReturnAllShapes();
 }
\ No newline at end of file
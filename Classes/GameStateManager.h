@@ -19,7 +19,6 @@ public:
     
     void SetParentNode(cocos2d::Node* parent) { parentNode = parent; }
     void SetRestartCallback(std::function<void()> callback) { onRestartCallback = callback; }
-    void SetShapesContainer(std::vector<ShapeSprite*>* shapesPtr) { shapes = shapesPtr; }
     
     bool IsGameOver() const { return isGameOver; }
     
@@ -35,7 +34,6 @@ private:
     cocos2d::LayerColor* overlay;
     cocos2d::Node* parentNode;
     
-    std::vector<ShapeSprite*>* shapes;
     std::function<void()> onRestartCallback;
 };
 
@@ -0,0 +1,43 @@
+#include "GravityController.h"
+
+USING_NS_CC;
+
+const float GravityController::SMOOTHING_TIME = 0.15f;
+const float GravityController::DEAD_ZONE = 25.0f;
+const float GravityController::MIN_UPDATE_INTERVAL = 0.2f;
+
+GravityController::GravityController()
+    : timeSinceUpdate(0.0f)
+{
+}
+
+void GravityController::Reset(const Vec2& gravity)
+{
+    target = gravity;
+    filtered = gravity;
+    applied = gravity;
+
+    timeSinceUpdate = 0.0f;
+}
+
+bool GravityController::Step(float dt, Vec2& outGravity)
+{
+    // 틱 간격 기준 저역 통과 필터 (센서 이벤트 빈도와 무관하게 같은 결과)
+    float blend = dt / (SMOOTHING_TIME + dt);
+    filtered += (target - filtered) * blend;
+
+    timeSinceUpdate += dt;
+
+    if (timeSinceUpdate < MIN_UPDATE_INTERVAL)
+        return false;
+
+    // 기기가 거의 움직이지 않았으면 중력을 건드리지 않아 잠든 도형이 계속 잠들어 있게 함
+    if (filtered.distanceSquared(applied) < DEAD_ZONE * DEAD_ZONE)
+        return false;
+
+    applied = filtered;
+    timeSinceUpdate = 0.0f;
+    outGravity = applied;
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef __GRAVITY_CONTROLLER_H__
+#define __GRAVITY_CONTROLLER_H__
+
+#include "cocos2d.h"
+
+// 기울기 센서 값을 걸러서 물리 월드 중력으로 바꿔주는 컨트롤러
+// 중력을 바꾸면 잠든 바디가 모두 깨어나므로, 저역 통과 필터 + 데드존 + 최대 갱신 빈도로 의미 있는 변화만 반영
+class GravityController
+{
+public:
+    GravityController();
+
+    void Reset(const cocos2d::Vec2& gravity);
+
+    // 최신 센서 샘플(중력 단위로 변환된 값)을 목표로 설정
+    void SetTarget(const cocos2d::Vec2& gravity) { target = gravity; }
+
+    // 고정 틱마다 호출, 중력을 실제로 바꿔야 하면 true와 새 중력을 반환
+    bool Step(float dt, cocos2d::Vec2& outGravity);
+
+    const cocos2d::Vec2& GetAppliedGravity() const { return applied; }
+
+private:
+    cocos2d::Vec2 target;
+    cocos2d::Vec2 filtered;
+    cocos2d::Vec2 applied;
+    float timeSinceUpdate;
+
+    static const float SMOOTHING_TIME;      // 저역 통과 필터 시간 상수 (초)
+    static const float DEAD_ZONE;           // 이보다 작은 중력 변화는 무시
+    static const float MIN_UPDATE_INTERVAL; // 중력 갱신 최소 간격 (초)
+};
+
+#endif // __GRAVITY_CONTROLLER_H__
\ No newline at end of file
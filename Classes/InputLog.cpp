@@ -0,0 +1,116 @@
+#include "InputLog.h"
+#include "BinaryStream.h"
+
+USING_NS_CC;
+
+const uint32_t InputLog::FILE_MAGIC = 0x4C49534D; // "MSIL"
+const uint16_t InputLog::FILE_VERSION = 1;
+
+namespace
+{
+    // 헤더: magic(4) + version(2) + fixedRate(2) + seed(4) + count(4)
+    // 항목: tick(4) + type(1) + x(4) + y(4)
+    const size_t HEADER_SIZE = 16;
+    const size_t ENTRY_SIZE = 13;
+}
+
+InputLog::InputLog()
+    : seed(0)
+    , fixedUpdateRate(60)
+    , cursor(0)
+{
+}
+
+void InputLog::Reset(uint32_t seed, int fixedUpdateRate)
+{
+    this->seed = seed;
+    this->fixedUpdateRate = fixedUpdateRate;
+
+    cursor = 0;
+    entries.clear();
+}
+
+void InputLog::Record(uint32_t tick, InputType type, const Vec2& value)
+{
+    entries.push_back({ tick, type, value });
+}
+
+bool InputLog::Save(const std::string& path) const
+{
+    std::vector<unsigned char> buffer;
+    buffer.reserve(HEADER_SIZE + entries.size() * ENTRY_SIZE);
+
+    BinaryWriter writer(buffer);
+    writer.Write<uint32_t>(FILE_MAGIC);
+    writer.Write<uint16_t>(FILE_VERSION);
+    writer.Write<uint16_t>((uint16_t)fixedUpdateRate);
+    writer.Write<uint32_t>(seed);
+    writer.Write<uint32_t>((uint32_t)entries.size());
+
+    for (const auto& entry : entries)
+    {
+        writer.Write<uint32_t>(entry.tick);
+        writer.Write<uint8_t>((uint8_t)entry.type);
+        writer.Write<float>(entry.value.x);
+        writer.Write<float>(entry.value.y);
+    }
+
+    Data data;
+    data.copy(buffer.data(), buffer.size());
+
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+bool InputLog::Load(const std::string& path)
+{
+    Data data = FileUtils::getInstance()->getDataFromFile(path);
+
+    if (data.isNull())
+        return false;
+
+    BinaryReader reader(data.getBytes(), (size_t)data.getSize());
+
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    uint16_t rate = 0;
+    uint32_t loadedSeed = 0;
+    uint32_t count = 0;
+
+    if (!reader.Read(magic) || !reader.Read(version) || magic != FILE_MAGIC || version != FILE_VERSION)
+    {
+        CCLOG("InputLog: %s is not a valid input log", path.c_str());
+        return false;
+    }
+
+    if (!reader.Read(rate) || !reader.Read(loadedSeed) || !reader.Read(count) || reader.GetRemaining() < count * ENTRY_SIZE)
+        return false;
+
+    Reset(loadedSeed, rate);
+    entries.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Entry entry;
+        uint8_t type = 0;
+
+        reader.Read(entry.tick);
+        reader.Read(type);
+        reader.Read(entry.value.x);
+        reader.Read(entry.value.y);
+
+        entry.type = (InputType)type;
+        entries.push_back(entry);
+    }
+
+    return true;
+}
+
+bool InputLog::PopInput(uint32_t tick, Entry& outEntry)
+{
+    if (cursor >= entries.size() || entries[cursor].tick != tick)
+        return false;
+
+    outEntry = entries[cursor++];
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef __INPUT_LOG_H__
+#define __INPUT_LOG_H__
+
+#include "cocos2d.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 결정적 시뮬레이션의 입력 기록 (시드 + 틱별 터치/기울기 입력)
+// 같은 빌드에서 같은 기록을 재생하면 물리/합치기 결과가 비트 단위로 동일하게 재현됨
+class InputLog
+{
+public:
+    enum class InputType : uint8_t
+    {
+        TOUCH = 0,
+        TILT = 1
+    };
+
+    struct Entry
+    {
+        uint32_t tick;
+        InputType type;
+        cocos2d::Vec2 value; // 터치 위치 또는 중력 벡터
+    };
+
+    InputLog();
+
+    void Reset(uint32_t seed, int fixedUpdateRate);
+    void Record(uint32_t tick, InputType type, const cocos2d::Vec2& value);
+
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+
+    // 재생: 주어진 틱의 입력을 기록된 순서대로 하나씩 꺼냄
+    bool PopInput(uint32_t tick, Entry& outEntry);
+    void Rewind() { cursor = 0; }
+
+    uint32_t GetSeed() const { return seed; }
+    int GetFixedUpdateRate() const { return fixedUpdateRate; }
+    const std::vector<Entry>& GetEntries() const { return entries; }
+
+private:
+    uint32_t seed;
+    int fixedUpdateRate;
+    size_t cursor;
+    std::vector<Entry> entries;
+
+    static const uint32_t FILE_MAGIC;
+    static const uint16_t FILE_VERSION;
+};
+
+#endif // __INPUT_LOG_H__
\ No newline at end of file
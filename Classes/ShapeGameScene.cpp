@@ -1,16 +1,32 @@
 #include "ShapeGameScene.h"
 #include "ShapePool.h"
 #include "ShapeSprite.h"
+#include "ShapeTextureAtlas.h"
+#include "ShapeGeometry.h"
+#include "ShapeLayer.h"
 #include "ComboSystem.h"
 #include "GameStateManager.h"
 #include "audio/include/AudioEngine.h"
+#include "chipmunk/chipmunk.h"
 #include <cassert>
+#include <chrono>
 
 USING_NS_CC;
 
 const float ShapeGameScene::BOX_WIDTH = 600.0f;
 const float ShapeGameScene::BOX_HEIGHT = 400.0f;
 const float ShapeGameScene::BOX_WALL_THICKNESS = 10.0f;
+const int ShapeGameScene::MAX_MERGE_ROUNDS = 8;
+const float ShapeGameScene::SPAWN_CLEARANCE = 10.0f;
+const int ShapeGameScene::FIXED_UPDATE_RATE = 60;
+const int ShapeGameScene::MAX_STEPS_PER_FRAME = 5;
+const float ShapeGameScene::SLEEP_TIME_THRESHOLD = 0.3f;
+const float ShapeGameScene::IDLE_SPEED_THRESHOLD = 15.0f;
+const float ShapeGameScene::AUTOSAVE_INTERVAL = 10.0f;
+const std::string ShapeGameScene::EVENT_SAVE_SNAPSHOT = "ShapeGameScene.SaveSnapshot";
+
+Size ShapeGameScene::maxBoxSize = Size(400.0f, 450.0f);
+bool ShapeGameScene::snapshotEnabled = true;
 
 ShapeGameScene::~ShapeGameScene()
 {
@@ -27,25 +43,81 @@ ShapeGameScene::~ShapeGameScene()
     }
 }
 
-Scene* ShapeGameScene::CreateScene()
+Scene* ShapeGameScene::CreateScene(const std::string& replayPath)
 {
     auto scene = Scene::createWithPhysics();
-    auto gameLayer = ShapeGameScene::create();
+    auto gameLayer = ShapeGameScene::Create(replayPath);
     
     // Set physics world reference before adding to scene
     gameLayer->world = scene->getPhysicsWorld();
     gameLayer->world->setGravity(Vec2(0, -300));
+    gameLayer->gravityController.Reset(gameLayer->world->getGravity());
+    
+    // 쌓여서 멈춘 도형은 빨리 재워서 솔버에서 빠지게 함 (기본값은 잠들지 않음)
+    gameLayer->world->setSleepTimeThreshold(SLEEP_TIME_THRESHOLD);
+    gameLayer->world->setIdleSpeedThreshold(IDLE_SPEED_THRESHOLD);
+    
+    // 물리는 update()에서 고정 틱으로 직접 진행 (멀티스레드 솔버는 결과가 매번 달라지므로 1스레드)
+    gameLayer->world->setAutoStep(false);
+    gameLayer->world->setSolverThreads(1);
+    
+    // 물리 스텝이 끝난 직후 모아둔 합치기 후보를 한 번에 처리
+    gameLayer->world->setPostUpdateCallback([gameLayer]() { gameLayer->ResolvePendingMerges(); });
     
     scene->addChild(gameLayer);
     
     return scene;
 }
 
+ShapeGameScene* ShapeGameScene::Create(const std::string& replayPath)
+{
+    ShapeGameScene* layer = new (std::nothrow) ShapeGameScene();
+
+    if (layer && layer->InitWithReplay(replayPath))
+    {
+        layer->autorelease();
+        return layer;
+    }
+
+    CC_SAFE_DELETE(layer);
+
+    return nullptr;
+}
+
+bool ShapeGameScene::InitWithReplay(const std::string& replayPath)
+{
+    isReplaying = false;
+
+    // 재생할 기록이 있으면 그 시드를, 없으면 새 시드로 기록 시작
+    if (!replayPath.empty() && inputLog.Load(replayPath))
+    {
+        assert(inputLog.GetFixedUpdateRate() == FIXED_UPDATE_RATE && "Error (Replay Error) : 기록된 고정 틱 속도가 다릅니다.");
+
+        isReplaying = true;
+    }
+
+    else
+    {
+        inputLog.Reset(std::random_device()(), FIXED_UPDATE_RATE);
+    }
+
+    rng.seed(inputLog.GetSeed());
+
+    return init();
+}
+
 bool ShapeGameScene::init()
 {
     if (!Layer::init())
         return false;
     
+    tick = 0;
+    lastSnapshotTick = 0;
+    accumulator = 0.0f;
+    restoredFromSnapshot = false;
+    usesSnapshot = snapshotEnabled && !isReplaying; // 재생은 항상 빈 보드에서 시작
+    stats = SimulationStats();
+    
     // 점수 초기화
     score = 0;
     bestScore = 0;
@@ -53,6 +125,7 @@ bool ShapeGameScene::init()
     
     // 콤보 시스템 초기화
     comboSystem = new ComboSystem();
+    comboSystem->SetTimeSource([this]() { return GetSimulationTime(); });
     
     // 게임 상태 관리자 초기화
     gameStateManager = new GameStateManager();
@@ -60,13 +133,33 @@ bool ShapeGameScene::init()
     // 베스트 스코어 로드
     LoadBestScore();
     
-    // ShapePool 초기화
+    // 마지막 스냅샷 로드
+    GameSnapshot snapshot;
+    bool hasSnapshot = usesSnapshot && snapshot.Load(GameSnapshot::GetDefaultPath());
+    
+    if (hasSnapshot)
+        bestScore = MAX(bestScore, snapshot.bestScore);
+    
+    // 도형 텍스처 아틀라스를 한 번만 구워둠 (풀 초기화 전에)
+    ShapeTextureAtlas::GetInstance()->Initialize();
+    
+    // ShapePool 초기화 및 자주 쓰는 레벨 미리 생성
     ShapePool::GetInstance()->Initialize(5);
+    ShapePool::GetInstance()->Reserve(3, 20); // 터치로 생성되는 삼각형
+    ShapePool::GetInstance()->Reserve(4, 5);  // 시작 도형 (3~5레벨)
+    ShapePool::GetInstance()->Reserve(5, 5);
     
     SetupPhysicsWorld();
     CreateGameBox();
-    CreateInitialShapes();
+    
+    if (hasSnapshot && snapshot.hasBoard)
+        RestoreBoard(snapshot);
+
+    else
+        CreateInitialShapes();
+    
     CreateScoreUI();
+    UpdateScoreDisplay();
     
     // 콤보 시스템 초기화
     auto visibleSize = Director::getInstance()->getVisibleSize();
@@ -75,23 +168,36 @@ bool ShapeGameScene::init()
     comboSystem->Initialize(comboPosition);
     comboSystem->AddToParent(this, 100);
     
+    if (restoredFromSnapshot)
+        comboSystem->Restore(snapshot.comboCount, snapshot.comboElapsed);
+    
     // 게임 상태 관리자 초기화
     gameStateManager->Initialize();
     gameStateManager->SetParentNode(this);
-    gameStateManager->SetShapesContainer(&shapes);
     gameStateManager->SetRestartCallback([this]() { OnGameRestart(); });
     
     auto contactListener = EventListenerPhysicsContact::create();
     contactListener->onContactBegin = CC_CALLBACK_1(ShapeGameScene::OnContactBegin, this);
     this->getEventDispatcher()->addEventListenerWithSceneGraphPriority(contactListener, this);
     
-    auto accelerationListener = EventListenerAcceleration::create(CC_CALLBACK_2(ShapeGameScene::OnAcceleration, this));
-    this->getEventDispatcher()->addEventListenerWithSceneGraphPriority(accelerationListener, this);
-    Device::setAccelerometerEnabled(true);
+    // 재생 중에는 실제 입력을 받지 않고 기록된 입력만 사용
+    if (!isReplaying)
+    {
+        auto accelerationListener = EventListenerAcceleration::create(CC_CALLBACK_2(ShapeGameScene::OnAcceleration, this));
+        this->getEventDispatcher()->addEventListenerWithSceneGraphPriority(accelerationListener, this);
+        Device::setAccelerometerEnabled(true);
+        
+        auto touchListener = EventListenerTouchOneByOne::create();
+        touchListener->onTouchBegan = CC_CALLBACK_2(ShapeGameScene::OnTouchBegan, this);
+        this->getEventDispatcher()->addEventListenerWithSceneGraphPriority(touchListener, this);
+    }
     
-    auto touchListener = EventListenerTouchOneByOne::create();
-    touchListener->onTouchBegan = CC_CALLBACK_2(ShapeGameScene::OnTouchBegan, this);
-    this->getEventDispatcher()->addEventListenerWithSceneGraphPriority(touchListener, this);
+    // 앱이 중단될 때 현재 보드 저장
+    if (usesSnapshot)
+    {
+        auto snapshotListener = EventListenerCustom::create(EVENT_SAVE_SNAPSHOT, [this](EventCustom*) { SaveSnapshot(); });
+        this->getEventDispatcher()->addEventListenerWithSceneGraphPriority(snapshotListener, this);
+    }
     
     scheduleUpdate();
     
@@ -105,6 +211,123 @@ bool ShapeGameScene::init()
     return true;
 }
 
+void ShapeGameScene::update(float dt)
+{
+    Layer::update(dt);
+    
+    // 프레임 시간과 무관하게 1/FIXED_UPDATE_RATE초 단위로만 물리를 진행
+    float fixedDelta = 1.0f / FIXED_UPDATE_RATE;
+    int steps = 0;
+    
+    accumulator += dt;
+    
+    while (accumulator >= fixedDelta && steps < MAX_STEPS_PER_FRAME)
+    {
+        StepSimulation();
+        
+        accumulator -= fixedDelta;
+        steps++;
+    }
+    
+    // 너무 밀렸으면 남은 시간은 버림 (틱 단위로 입력을 기록하므로 재생 결과에는 영향 없음)
+    if (accumulator >= fixedDelta)
+        accumulator = 0.0f;
+    
+    // 렌더링은 직전 틱과 현재 틱 사이를 보간
+    ShapeSprite::SetInterpolationAlpha(accumulator / fixedDelta);
+}
+
+void ShapeGameScene::StepSimulation()
+{
+    assert(world != nullptr && "Error (Reference Error) : 물리 월드가 참조되지 않았습니다.");
+    
+    ApplyQueuedInputs();
+    
+    // 보간용으로 스텝 직전 상태를 저장
+    for (auto shape : ShapePool::GetInstance()->GetActiveShapes())
+        shape->SavePreviousState();
+    
+    auto stepStart = std::chrono::steady_clock::now();
+    
+    // 합치기는 postUpdate 콜백(ResolvePendingMerges)에서 같은 틱 안에 처리됨
+    world->step(1.0f / FIXED_UPDATE_RATE);
+    
+    stats.physicsSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+    stats.steps++;
+    
+    tick++;
+    
+    // 크래시에 대비해 주기적으로 보드 저장 (직렬화만 메인 스레드, 쓰기는 IO 스레드)
+    if (usesSnapshot && tick - lastSnapshotTick >= (uint32_t)(AUTOSAVE_INTERVAL * FIXED_UPDATE_RATE))
+        SaveSnapshot();
+}
+
+void ShapeGameScene::ApplyQueuedInputs()
+{
+    InputLog::Entry input;
+    
+    if (isReplaying)
+    {
+        while (inputLog.PopInput(tick, input))
+            ApplyInput(input);
+        
+        return;
+    }
+    
+    // 이번 틱에 들어온 입력을 기록 후 적용
+    for (const auto& location : pendingTouches)
+    {
+        inputLog.Record(tick, InputLog::InputType::TOUCH, location);
+        ApplyTouch(location);
+    }
+    
+    pendingTouches.clear();
+    
+    // 기울기는 걸러진 중력이 의미 있게 바뀐 틱에만 적용하고 기록 (중력 변경은 잠든 도형을 모두 깨움)
+    Vec2 gravity;
+    
+    if (gravityController.Step(1.0f / FIXED_UPDATE_RATE, gravity))
+    {
+        inputLog.Record(tick, InputLog::InputType::TILT, gravity);
+        world->setGravity(gravity);
+    }
+}
+
+void ShapeGameScene::ApplyInput(const InputLog::Entry& input)
+{
+    switch (input.type)
+    {
+    case InputLog::InputType::TOUCH:
+        ApplyTouch(input.value);
+        break;
+
+    case InputLog::InputType::TILT:
+        world->setGravity(input.value);
+        break;
+    }
+}
+
+void ShapeGameScene::ApplyTouch(const Vec2& location)
+{
+    // 게임 상태 관리자에서 터치 처리
+    if (gameStateManager->HandleTouchForRestart(location))
+        return;
+    
+    AddShapeAtPosition(location);
+}
+
+void ShapeGameScene::SaveInputLog()
+{
+    // 재생 중에는 원본 기록을 덮어쓰지 않음
+    if (isReplaying || restoredFromSnapshot)
+        return;
+    
+    std::string path = FileUtils::getInstance()->getWritablePath() + "LastSession.inputlog";
+    
+    if (!inputLog.Save(path))
+        CCLOG("Failed to save input log to %s", path.c_str());
+}
+
 void ShapeGameScene::SetupPhysicsWorld()
 {
     auto visibleSize = Director::getInstance()->getVisibleSize();
@@ -113,8 +336,8 @@ void ShapeGameScene::SetupPhysicsWorld()
     boxCenter = Vec2(origin.x + visibleSize.width / 2, origin.y + visibleSize.height / 2);
     
     // 가로 모드에 맞춰 박스 크기 조정
-    float boxWidth = MIN(visibleSize.width * 0.5f, 400.0f);  // 화면 너비의 50%, 최대 400px
-    float boxHeight = MIN(visibleSize.height * 0.7f, 450.0f); // 화면 높이의 70%, 최대 450px
+    float boxWidth = MIN(visibleSize.width * 0.5f, maxBoxSize.width);   // 화면 너비의 50%, 기본 최대 400px
+    float boxHeight = MIN(visibleSize.height * 0.7f, maxBoxSize.height); // 화면 높이의 70%, 기본 최대 450px
     
     // 최소 크기 보장
     boxWidth = MAX(boxWidth, 200.0f);
@@ -127,6 +350,10 @@ void ShapeGameScene::CreateGameBox()
 {
     boxDrawNode = DrawNode::create();
     this->addChild(boxDrawNode);
+
+    // 도형은 별도 컨테이너에 모아서 인스턴싱으로 한 번에 그림 (많아지면 자식들을 여러 스레드에서 나눠 방문)
+    shapeLayer = ShapeLayer::Create();
+    this->addChild(shapeLayer);
     
     // 박스 테두리를 개별 라인으로 그리기
     Vec2 bottomLeft = Vec2(boxCenter.x - boxSize.width/2, boxCenter.y - boxSize.height/2);
@@ -143,7 +370,8 @@ void ShapeGameScene::CreateGameBox()
     auto leftWall = Node::create();
     auto leftWallBody = PhysicsBody::createBox(Size(BOX_WALL_THICKNESS, boxSize.height));
     leftWallBody->setDynamic(false);
-    leftWallBody->setContactTestBitmask(0xFFFFFFFF);
+    leftWallBody->setCategoryBitmask(ShapeSprite::WALL_CATEGORY);
+    leftWallBody->setContactTestBitmask(0); // 벽 접촉은 이벤트 없이 물리 엔진에서만 처리
     leftWall->setPhysicsBody(leftWallBody);
     leftWall->setPosition(boxCenter.x - boxSize.width/2, boxCenter.y);
     this->addChild(leftWall);
@@ -151,7 +379,8 @@ void ShapeGameScene::CreateGameBox()
     auto rightWall = Node::create();
     auto rightWallBody = PhysicsBody::createBox(Size(BOX_WALL_THICKNESS, boxSize.height));
     rightWallBody->setDynamic(false);
-    rightWallBody->setContactTestBitmask(0xFFFFFFFF);
+    rightWallBody->setCategoryBitmask(ShapeSprite::WALL_CATEGORY);
+    rightWallBody->setContactTestBitmask(0); // 벽 접촉은 이벤트 없이 물리 엔진에서만 처리
     rightWall->setPhysicsBody(rightWallBody);
     rightWall->setPosition(boxCenter.x + boxSize.width/2, boxCenter.y);
     this->addChild(rightWall);
@@ -159,7 +388,8 @@ void ShapeGameScene::CreateGameBox()
     auto bottomWall = Node::create();
     auto bottomWallBody = PhysicsBody::createBox(Size(boxSize.width, BOX_WALL_THICKNESS));
     bottomWallBody->setDynamic(false);
-    bottomWallBody->setContactTestBitmask(0xFFFFFFFF);
+    bottomWallBody->setCategoryBitmask(ShapeSprite::WALL_CATEGORY);
+    bottomWallBody->setContactTestBitmask(0); // 벽 접촉은 이벤트 없이 물리 엔진에서만 처리
     bottomWall->setPhysicsBody(bottomWallBody);
     bottomWall->setPosition(boxCenter.x, boxCenter.y - boxSize.height/2);
     this->addChild(bottomWall);
@@ -167,7 +397,8 @@ void ShapeGameScene::CreateGameBox()
     auto topWall = Node::create();
     auto topWallBody = PhysicsBody::createBox(Size(boxSize.width, BOX_WALL_THICKNESS));
     topWallBody->setDynamic(false);
-    topWallBody->setContactTestBitmask(0xFFFFFFFF);
+    topWallBody->setCategoryBitmask(ShapeSprite::WALL_CATEGORY);
+    topWallBody->setContactTestBitmask(0); // 벽 접촉은 이벤트 없이 물리 엔진에서만 처리
     topWall->setPhysicsBody(topWallBody);
     topWall->setPosition(boxCenter.x, boxCenter.y + boxSize.height/2);
     this->addChild(topWall);
@@ -202,7 +433,7 @@ void ShapeGameScene::AddScore(int points)
 
 void ShapeGameScene::UpdateScoreDisplay()
 {
-    assert(scoreLabel != nullptr, "Error (Reference Error) : 점수 라벨이 참조되지 않았습니다.");
+    assert(scoreLabel != nullptr && "Error (Reference Error) : 점수 라벨이 참조되지 않았습니다.");
 
 
     std::string scoreText = "Score: " + std::to_string(score);
@@ -211,14 +442,66 @@ void ShapeGameScene::UpdateScoreDisplay()
 
 void ShapeGameScene::LoadBestScore()
 {
-    // UserDefault에서 베스트 스코어 로드
+    // 이전 버전은 UserDefault에 저장했으므로 스냅샷이 없을 때를 위해 계속 읽음 (저장은 스냅샷으로만)
     bestScore = UserDefault::getInstance()->getIntegerForKey("BestScore", 0);
 }
 
-void ShapeGameScene::SaveBestScore()
+void ShapeGameScene::RestoreBoard(const GameSnapshot& snapshot)
 {
-    UserDefault::getInstance()->setIntegerForKey("BestScore", bestScore);
-    UserDefault::getInstance()->flush(); // 즉시 저장
+    for (const auto& state : snapshot.shapes)
+    {
+        if (state.level < 3)
+            continue;
+
+        auto shape = ShapePool::GetInstance()->GetShape(state.level, state.position);
+
+        if (shape == nullptr)
+            continue;
+
+        // 30레벨 이후 크기는 합치기 이력에 따라 달라지므로 저장된 값을 그대로 사용
+        if (shape->GetShapeScale() != state.scale)
+            shape->ApplyLevel(state.level, state.scale);
+
+        shape->setRotation(state.rotation);
+        shape->getPhysicsBody()->setVelocity(state.velocity);
+        shape->getPhysicsBody()->setAngularVelocity(state.angularVelocity);
+        shape->SavePreviousState();
+
+        shapeLayer->addChild(shape);
+    }
+
+    score = snapshot.score;
+    restoredFromSnapshot = true;
+}
+
+void ShapeGameScene::SaveSnapshot()
+{
+    lastSnapshotTick = tick;
+
+    GameSnapshot snapshot;
+    snapshot.score = score;
+    snapshot.bestScore = MAX(score, bestScore);
+    snapshot.comboCount = comboSystem->GetComboCount();
+    snapshot.comboElapsed = comboSystem->GetElapsedSinceLastMerge();
+
+    // 게임 오버 상태의 보드는 이어서 할 수 없으므로 베스트 스코어만 남김
+    snapshot.hasBoard = !gameStateManager->IsGameOver();
+
+    if (snapshot.hasBoard)
+    {
+        const auto& activeShapes = ShapePool::GetInstance()->GetActiveShapes();
+        snapshot.shapes.reserve(activeShapes.size());
+
+        for (auto shape : activeShapes)
+        {
+            auto body = shape->getPhysicsBody();
+
+            snapshot.shapes.push_back({ shape->GetLevel(), shape->GetShapeScale(), shape->getPosition(), shape->getRotation(),
+                body->getVelocity(), body->getAngularVelocity() });
+        }
+    }
+
+    snapshot.SaveAsync(GameSnapshot::GetDefaultPath());
 }
 
 void ShapeGameScene::UpdateBestScoreDisplay()
@@ -231,28 +514,25 @@ void ShapeGameScene::UpdateBestScoreDisplay()
 
 bool ShapeGameScene::IsSpaceAvailable(const Vec2& position)
 {
-    // 새로운 삼각형의 반지름 (ShapeSprite::createShapeTexture에서 사용하는 공식)
-    float shapeRadius = 20.0f; // 삼각형(3-3=0)의 기본 반지름
+    assert(world != nullptr && "Error (Reference Error) : 물리 월드가 참조되지 않았습니다.");
+    
+    // 새로 생길 삼각형의 반지름 + 여유 공간 안에 실제 물리 도형의 표면이 있는지 검사
+    // (물리 엔진의 공간 인덱스를 사용하므로 박스가 차도 주변 도형만 확인함)
+    float clearance = ShapeGeometry::GetRadius(3, 1.0f) + SPAWN_CLEARANCE;
+    bool available = true;
     
-    // 위치 주변에 다른 도형이 있는지 확인
-    for (auto shape : shapes)
+    world->queryNearPoint([&available](PhysicsWorld&, PhysicsShape& shape, void*) -> bool
     {
-        if (shape && shape->getParent())
-        {
-            Vec2 shapePos = shape->getPosition();
-            float distance = position.distance(shapePos);
-            
-            // 다른 도형과의 최소 거리 계산 (두 도형의 반지름 + 여유 공간)
-            float otherShapeRadius = 20.0f + (shape->GetSides() - 3) * 3.0f;
-            float minDistance = (shapeRadius + otherShapeRadius) * shape->GetShapeScale() + 10.0f; // 10px 여유
-            
-            // 공간 부족
-            if (distance < minDistance)
-                return false; 
-        }
-    }
+        // 벽은 무시 (박스 경계는 AddShapeAtPosition에서 따로 검사)
+        if (shape.getCategoryBitmask() == ShapeSprite::WALL_CATEGORY)
+            return true;
+        
+        // 공간 부족
+        available = false;
+        return false;
+    }, position, clearance, nullptr);
     
-    return true; // 공간 있음
+    return available; // 공간 있음
 }
 
 void ShapeGameScene::OnGameRestart()
@@ -279,10 +559,11 @@ void ShapeGameScene::CreateInitialShapes()
 
 void ShapeGameScene::AddRandomShape()
 {
-    int level = 3 + (rand() % 3); // 3~5레벨 랜덤
+    // 재생 시 같은 결과가 나오도록 씬이 소유한 시드 RNG만 사용
+    int level = 3 + (int)(rng() % 3); // 3~5레벨 랜덤
     
     float margin = 60.0f;
-    float x = boxCenter.x + (rand() % (int)(boxSize.width - margin)) - (boxSize.width - margin)/2;
+    float x = boxCenter.x + (int)(rng() % (int)(boxSize.width - margin)) - (boxSize.width - margin)/2;
     float y = boxCenter.y + boxSize.height/2 - 50;
     Vec2 position(x, y);
     
@@ -290,43 +571,22 @@ void ShapeGameScene::AddRandomShape()
 
     if (shape != nullptr)
     {
-        this->addChild(shape);
-        shapes.push_back(shape);
+        shapeLayer->addChild(shape);
     }
 }
 
 bool ShapeGameScene::OnContactBegin(cocos2d::PhysicsContact& contact)
 {
-    auto nodeA = contact.getShapeA()->getBody()->getNode();
-    auto nodeB = contact.getShapeB()->getBody()->getNode();
-    
-    auto shapeA = dynamic_cast<ShapeSprite*>(nodeA);
-    auto shapeB = dynamic_cast<ShapeSprite*>(nodeB);
+    // 레벨 카테고리가 같은 도형끼리만 이 콜백에 도달하므로 (벽은 접촉 테스트 비트 없음) 바로 캐스팅
+    auto shapeA = static_cast<ShapeSprite*>(contact.getShapeA()->getBody()->getNode());
+    auto shapeB = static_cast<ShapeSprite*>(contact.getShapeB()->getBody()->getNode());
     
-    if (shapeA && shapeB && shapeA->GetLevel() == shapeB->GetLevel())
+    // 카테고리 비트는 31레벨마다 반복되므로 레벨은 다시 비교
+    if (shapeA->GetLevel() == shapeB->GetLevel())
     {
-        // Check if shapes are still valid and not already being processed
-        auto it1 = std::find(shapes.begin(), shapes.end(), shapeA);
-        auto it2 = std::find(shapes.begin(), shapes.end(), shapeB);
-        
-        if (it1 != shapes.end() && it2 != shapes.end())
-        {
-            // Retain the shapes to prevent deletion during physics processing
-            shapeA->retain();
-            shapeB->retain();
-            
-            // Schedule merge to happen on next frame to avoid physics issues
-            this->runAction(CallFunc::create([this, shapeA, shapeB](){
-                // Check if shapes are still valid before merging
-                if (shapeA->getParent() && shapeB->getParent())
-                {
-                    MergeShapes(shapeA, shapeB);
-                }
-                // Release the retained references
-                shapeA->release();
-                shapeB->release();
-            }));
-        }
+        // 물리 스텝 중에는 후보만 모아두고, 스텝이 끝난 뒤 ResolvePendingMerges에서 한 번에 처리
+        if (shapeA->IsActive() && shapeB->IsActive())
+            pendingMerges.emplace_back(shapeA, shapeB);
 
         return false;
     }
@@ -334,6 +594,115 @@ bool ShapeGameScene::OnContactBegin(cocos2d::PhysicsContact& contact)
     return true;
 }
 
+void ShapeGameScene::ResolvePendingMerges()
+{
+    if (pendingMerges.empty())
+        return;
+
+    std::vector<int> mergedLevels;
+    std::vector<std::pair<ShapeSprite*, ShapeSprite*>> cascadeMerges;
+    std::vector<ShapeSprite*> neighbors;
+
+    // 라운드마다 각 도형은 최대 한 번만 합쳐지고, 합쳐진 결과는 다음 라운드에서 연쇄 합치기 가능
+    for (int round = 0; round < MAX_MERGE_ROUNDS && !pendingMerges.empty(); round++)
+    {
+        mergedShapes.clear();
+
+        // 수집된 순서대로 탐욕적으로 짝을 지어 결정적인 결과를 보장
+        for (const auto& candidate : pendingMerges)
+        {
+            ShapeSprite* shape1 = candidate.first;
+            ShapeSprite* shape2 = candidate.second;
+
+            if (mergedShapes.count(shape1) != 0 || mergedShapes.count(shape2) != 0)
+                continue;
+
+            // 이미 풀로 돌아갔거나 레벨이 달라진 쌍은 무시
+            if (!shape1->IsActive() || !shape2->IsActive() || shape1->GetLevel() != shape2->GetLevel())
+                continue;
+
+            int newLevel = shape1->GetLevel() + 1;
+
+            // 두 도형에 닿아 있던 다음 레벨 도형은 연쇄 합치기 후보
+            neighbors.clear();
+            CollectTouchingShapes(shape1, newLevel, neighbors);
+            CollectTouchingShapes(shape2, newLevel, neighbors);
+
+            MergeShapes(shape1, shape2);
+
+            mergedShapes.insert(shape1);
+            mergedShapes.insert(shape2);
+            mergedLevels.push_back(newLevel);
+
+            for (auto neighbor : neighbors)
+                cascadeMerges.emplace_back(shape1, neighbor);
+        }
+
+        pendingMerges.swap(cascadeMerges);
+        cascadeMerges.clear();
+    }
+
+    pendingMerges.clear();
+
+    if (mergedLevels.empty())
+        return;
+
+    stats.merges += (uint32_t)mergedLevels.size();
+
+    // 이번 프레임의 합치기 수를 콤보 시스템에 한 번에 보고
+    comboSystem->Update((int)mergedLevels.size());
+
+    // 레벨에 따른 점수 획득 (무한 확장 가능)
+    int points = 0;
+
+    for (int level : mergedLevels)
+        points += level + comboSystem->CalculateBonus(level);
+
+    AddScore(points);
+
+    // 합치기 사운드 재생 (한 프레임에 여러 번 합쳐져도 한 번만)
+    auto audioId = cocos2d::AudioEngine::play2d("Sound/MergeSound.mp3", false, 1.0f);
+
+    // 파일을 찾을 수 없으면 다른 경로로 시도
+    if (audioId == cocos2d::AudioEngine::INVALID_AUDIO_ID)
+        audioId = cocos2d::AudioEngine::play2d("Resources/Sound/MergeSound.mp3", false, 1.0f);
+}
+
+void ShapeGameScene::CollectTouchingShapes(ShapeSprite* shape, int level, std::vector<ShapeSprite*>& outShapes)
+{
+    // 마지막 물리 스텝의 접촉(arbiter) 목록에서 같은 레벨 도형만 추림
+    struct QueryData
+    {
+        cpBody* body;
+        int level;
+        std::vector<ShapeSprite*>* outShapes;
+    };
+
+    QueryData data = { shape->getPhysicsBody()->getCPBody(), level, &outShapes };
+
+    cpBodyEachArbiter(data.body, [](cpBody* body, cpArbiter* arbiter, void* userData)
+    {
+        auto query = static_cast<QueryData*>(userData);
+
+        CP_ARBITER_GET_SHAPES(arbiter, cpShapeA, cpShapeB);
+        cpShape* other = (cpShapeGetBody(cpShapeA) == body) ? cpShapeB : cpShapeA;
+
+        auto physicsShape = static_cast<PhysicsShape*>(cpShapeGetUserData(other));
+
+        if (physicsShape == nullptr || physicsShape->getBody() == nullptr)
+            return;
+
+        // 벽이나 다른 레벨 도형은 카테고리로 먼저 걸러냄
+        if (physicsShape->getCategoryBitmask() != ShapeSprite::GetCategoryForLevel(query->level))
+            return;
+
+        auto otherShape = static_cast<ShapeSprite*>(physicsShape->getBody()->getNode());
+
+        if (otherShape->IsActive() && otherShape->GetLevel() == query->level)
+            query->outShapes->push_back(otherShape);
+    }, &data);
+}
+
 void ShapeGameScene::MergeShapes(ShapeSprite* shape1, ShapeSprite* shape2)
 {
     assert(shape1 != nullptr && "Error (Reference Error) : 첫 번째 도형이 참조되지 않았습니다.");
@@ -345,11 +714,8 @@ void ShapeGameScene::MergeShapes(ShapeSprite* shape1, ShapeSprite* shape2)
     assert(shape1->getPhysicsBody() != nullptr && "Error (Physics Error) : 첫 번째 도형의 물리 바디가 없습니다.");
     assert(shape2->getPhysicsBody() != nullptr && "Error (Physics Error) : 두 번째 도형의 물리 바디가 없습니다.");
 
-    // Double check that shapes are still in our container
-    auto it1 = std::find(shapes.begin(), shapes.end(), shape1);
-    auto it2 = std::find(shapes.begin(), shapes.end(), shape2);
-
-    if (it1 == shapes.end() || it2 == shapes.end())
+    // Double check that shapes are still active in the pool
+    if (!shape1->IsActive() || !shape2->IsActive())
         return;
 
     int newLevel = shape1->GetLevel() + 1; // 레벨 기반 계산
@@ -373,49 +739,17 @@ void ShapeGameScene::MergeShapes(ShapeSprite* shape1, ShapeSprite* shape2)
     Vec2 velocity2 = shape2->getPhysicsBody()->getVelocity();
     Vec2 averageVelocity = (velocity1 + velocity2) * 0.5f;
 
-    // Remove from vector using erase-remove idiom
-    shapes.erase(std::remove(shapes.begin(), shapes.end(), shape1), shapes.end());
-    shapes.erase(std::remove(shapes.begin(), shapes.end(), shape2), shapes.end());
-
-    // 기존 도형들을 풀로 반환
-    ShapePool::GetInstance()->ReturnShape(shape1);
+    // shape2만 풀로 반환하고 shape1은 제자리에서 다음 레벨로 승격
+    // (물리 바디를 재사용하므로 바디 생성이나 물리 월드 재등록이 일어나지 않음)
     ShapePool::GetInstance()->ReturnShape(shape2);
 
-    // Create new shape at the merge position using pool
-    auto newShape = ShapePool::GetInstance()->GetShape(newLevel, mergePos);
-
-    assert(newShape != nullptr && "Error (Pool Error) : 풀에서 새 도형을 생성할 수 없습니다.");
-
-    // 30레벨 이후 스케일 적용
-    if (newLevel > 30)
-    {
-        newShape->SetShapeScale(newScale);
-        newShape->CreateShapeTexture();
-        newShape->SetupPhysicsBody();
-    }
-
-    this->addChild(newShape);
+    auto newShape = shape1;
+    newShape->ApplyLevel(newLevel, newScale);
+    newShape->setPosition(mergePos);
 
     // Apply the average velocity to the new shape for more natural physics
     newShape->getPhysicsBody()->setVelocity(averageVelocity * 0.8f); // Slight dampening
-
-    shapes.push_back(newShape);
-
-    // 콤보 업데이트
-    comboSystem->Update();
-
-    // 합치기 사운드 재생
-    auto audioId = cocos2d::AudioEngine::play2d("Sound/MergeSound.mp3", false, 1.0f);
-
-    // 파일을 찾을 수 없으면 다른 경로로 시도
-    if (audioId == cocos2d::AudioEngine::INVALID_AUDIO_ID)
-        audioId = cocos2d::AudioEngine::play2d("Resources/Sound/MergeSound.mp3", false, 1.0f);
-
-    // 레벨에 따른 점수 획득 (무한 확장 가능)
-    int baseScore = newLevel;
-    int bonusScore = comboSystem->CalculateBonus(baseScore);
-
-    AddScore(baseScore + bonusScore);
+    newShape->getPhysicsBody()->setAngularVelocity(0.0f);
 }
 
 void ShapeGameScene::OnAcceleration(cocos2d::Acceleration* acc, cocos2d::Event* event)
@@ -430,8 +764,8 @@ void ShapeGameScene::OnAcceleration(cocos2d::Acceleration* acc, cocos2d::Event*
     
     Vec2 gravity = Vec2(gravityX, gravityY);
     
-    assert(world != nullptr && "Error (Reference Error) : 물리 월드가 참조되지 않았습니다.");
-    world->setGravity(gravity);
+    // 필터의 목표값만 갱신하고 실제 중력 변경은 틱마다 GravityController가 판단
+    gravityController.SetTarget(gravity);
     
     // Optional: Add shake detection for extra effects (주석 처리)
     /*
@@ -481,13 +815,19 @@ void ShapeGameScene::AddShapeAtPosition(const Vec2& position)
         {
             bestScore = score;
 
-            SaveBestScore();
             UpdateBestScoreDisplay();
 
             isNewRecord = true;
         }
 
         gameStateManager->GameOver(score, bestScore, isNewRecord);
+        stats.gameOvers++;
+
+        // 베스트 스코어와 빈 보드를 백그라운드에서 저장 (메인 스레드에서 파일 쓰기 없음)
+        if (usesSnapshot)
+            SaveSnapshot();
+
+        SaveInputLog();
 
         return;
     }
@@ -499,8 +839,7 @@ void ShapeGameScene::AddShapeAtPosition(const Vec2& position)
     
     if (shape)
     {
-        this->addChild(shape);
-        shapes.push_back(shape);
+        shapeLayer->addChild(shape);
     }
     
     // 터치로 도형 생성 시에는 콤보를 리셋 (터치로는 콤보 불가)
@@ -512,13 +851,8 @@ void ShapeGameScene::AddShapeAtPosition(const Vec2& position)
 
 bool ShapeGameScene::OnTouchBegan(Touch* touch, Event* event)
 {
-    Vec2 touchLocation = touch->getLocation();
-    
-    // 게임 상태 관리자에서 터치 처리
-    if (gameStateManager->HandleTouchForRestart(touchLocation))
-        return true;
-    
-    AddShapeAtPosition(touchLocation);
+    // 다음 틱 경계에서 적용하고 입력 기록에 남김
+    QueueTouch(touch->getLocation());
 
     return true;
 }
\ No newline at end of file
@@ -3,26 +3,62 @@
 
 #include "cocos2d.h"
 #include "physics/CCPhysicsWorld.h"
+#include "InputLog.h"
+#include "GravityController.h"
+#include "GameSnapshot.h"
 #include <vector>
 #include <map>
+#include <unordered_set>
 #include <algorithm>
+#include <random>
 
 class ShapeSprite;
+class ShapeLayer;
 class ShapePool;
 class ComboSystem;
 class GameStateManager;
 
+// 성능 측정용 누적 통계 (헤드리스 벤치마크에서 프레임 전후 값을 비교해 사용)
+struct SimulationStats
+{
+    uint32_t steps;
+    uint32_t merges;
+    uint32_t gameOvers;
+    double physicsSeconds; // world->step + 합치기 처리에 걸린 시간
+};
+
 class ShapeGameScene : public cocos2d::Layer
 {
 public:
-    static cocos2d::Scene* CreateScene();
+    // replayPath가 주어지면 저장된 입력 기록을 같은 시드로 재생
+    static cocos2d::Scene* CreateScene(const std::string& replayPath = "");
+    static ShapeGameScene* Create(const std::string& replayPath = "");
     virtual bool init() override;
+    bool InitWithReplay(const std::string& replayPath);
     virtual ~ShapeGameScene();
     
+    virtual void update(float dt) override;
+    
     void OnAcceleration(cocos2d::Acceleration* acc, cocos2d::Event* event);
     bool OnTouchBegan(cocos2d::Touch* touch, cocos2d::Event* event);
     
-    CREATE_FUNC(ShapeGameScene);
+    float GetSimulationTime() const { return (float)((double)tick / FIXED_UPDATE_RATE); }
+    bool IsReplaying() const { return isReplaying; }
+    
+    // 다음 틱 경계에서 터치로 처리 (실제 터치와 스크립트 입력 모두 이 경로로 기록됨)
+    void QueueTouch(const cocos2d::Vec2& location) { pendingTouches.push_back(location); }
+    
+    cocos2d::Rect GetBoxRect() const { return cocos2d::Rect(boxCenter - cocos2d::Vec2(boxSize.width/2, boxSize.height/2), boxSize); }
+    const SimulationStats& GetStats() const { return stats; }
+    
+    // 앱이 백그라운드로 갈 때 AppDelegate가 보내는 이벤트, 받으면 보드 스냅샷을 저장
+    static const std::string EVENT_SAVE_SNAPSHOT;
+    
+    // 박스 최대 크기 (씬 생성 전에 설정, 스트레스 테스트에서 도형 수를 늘릴 때 사용)
+    static void SetMaxBoxSize(const cocos2d::Size& size) { maxBoxSize = size; }
+    
+    // 스냅샷 저장/복원 사용 여부 (벤치마크처럼 항상 빈 보드에서 시작해야 할 때 끔)
+    static void SetSnapshotEnabled(bool enabled) { snapshotEnabled = enabled; }
     
     cocos2d::PhysicsWorld* world;
     
@@ -34,22 +70,61 @@ private:
     void AddShapeAtPosition(const cocos2d::Vec2& position);
     
     bool OnContactBegin(cocos2d::PhysicsContact& contact);
+    void ResolvePendingMerges();
+    void CollectTouchingShapes(ShapeSprite* shape, int level, std::vector<ShapeSprite*>& outShapes);
     void MergeShapes(ShapeSprite* shape1, ShapeSprite* shape2);
     void AddScore(int points);
     void UpdateScoreDisplay();
     void CreateScoreUI();
     bool IsSpaceAvailable(const cocos2d::Vec2& position);
-    void SaveBestScore();
     void LoadBestScore();
+    void RestoreBoard(const GameSnapshot& snapshot);
+    void SaveSnapshot();
     void UpdateBestScoreDisplay();
     void OnGameRestart();
     
+    // 고정 틱 시뮬레이션: 입력은 큐에 모았다가 틱 경계에서만 적용하고 기록
+    void StepSimulation();
+    void ApplyQueuedInputs();
+    void ApplyInput(const InputLog::Entry& input);
+    void ApplyTouch(const cocos2d::Vec2& location);
+    void SaveInputLog();
+    
     cocos2d::DrawNode* boxDrawNode;
-    std::vector<ShapeSprite*> shapes;
+    ShapeLayer* shapeLayer;
+    
+    // 이번 물리 스텝에서 수집된 합치기 후보 쌍과 처리 중 이미 합쳐진 도형
+    std::vector<std::pair<ShapeSprite*, ShapeSprite*>> pendingMerges;
+    std::unordered_set<ShapeSprite*> mergedShapes;
     
     static const float BOX_WIDTH;
     static const float BOX_HEIGHT;
     static const float BOX_WALL_THICKNESS;
+    static const int MAX_MERGE_ROUNDS;
+    static const float SPAWN_CLEARANCE;
+    static const int FIXED_UPDATE_RATE;
+    static const int MAX_STEPS_PER_FRAME;
+    static const float SLEEP_TIME_THRESHOLD;
+    static const float IDLE_SPEED_THRESHOLD;
+    static const float AUTOSAVE_INTERVAL;
+    
+    // 결정적 시뮬레이션 상태
+    std::mt19937 rng;
+    InputLog inputLog;
+    bool isReplaying;
+    uint32_t tick;
+    uint32_t lastSnapshotTick;
+    float accumulator;
+    bool restoredFromSnapshot; // 복원된 보드에서 시작한 세션은 입력 기록만으로 재생할 수 없음
+    bool usesSnapshot;
+    
+    std::vector<cocos2d::Vec2> pendingTouches;
+    GravityController gravityController;
+    
+    SimulationStats stats;
+    
+    static cocos2d::Size maxBoxSize;
+    static bool snapshotEnabled;
     
     cocos2d::Vec2 boxCenter;
     cocos2d::Size boxSize;
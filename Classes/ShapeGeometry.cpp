@@ -0,0 +1,56 @@
+#include "ShapeGeometry.h"
+
+USING_NS_CC;
+
+std::unordered_map<int, ShapeGeometry::Polygon> ShapeGeometry::polygons;
+
+const ShapeGeometry::Polygon& ShapeGeometry::GetPolygon(int sides, float scale)
+{
+    int key = MakeKey(sides, scale);
+    auto it = polygons.find(key);
+
+    if (it != polygons.end())
+        return it->second;
+
+    // 처음 요청된 조합만 계산 (이후에는 캐시된 값 재사용)
+    Polygon& polygon = polygons[key];
+    polygon.sides = sides;
+    polygon.scale = scale;
+
+    BuildPolygon(polygon);
+
+    return polygon;
+}
+
+void ShapeGeometry::Clear()
+{
+    polygons.clear();
+}
+
+int ShapeGeometry::MakeKey(int sides, float scale)
+{
+    // 30레벨 이후 크기는 합치기마다 달라지므로 0.01 단위로 양자화
+    return sides * 100000 + (int)std::round(scale * 100.0f);
+}
+
+void ShapeGeometry::BuildPolygon(Polygon& polygon)
+{
+    polygon.radius = GetRadius(polygon.sides, polygon.scale);
+    polygon.vertices.reserve(polygon.sides);
+
+    float angleStep = 2.0f * M_PI / polygon.sides;
+
+    for (int i = 0; i < polygon.sides; i++)
+    {
+        float angle = i * angleStep - M_PI / 2;
+        float x = polygon.radius * cos(angle);
+        float y = polygon.radius * sin(angle);
+
+        polygon.vertices.push_back(Vec2(x, y));
+    }
+
+    polygon.area = PhysicsShapePolygon::calculateArea(polygon.vertices.data(), polygon.sides);
+
+    float mass = PHYSICSSHAPE_MATERIAL_DEFAULT.density * polygon.area;
+    polygon.moment = PhysicsShapePolygon::calculateMoment(mass, polygon.vertices.data(), polygon.sides);
+}
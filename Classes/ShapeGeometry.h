@@ -0,0 +1,36 @@
+#ifndef __SHAPE_GEOMETRY_H__
+#define __SHAPE_GEOMETRY_H__
+
+#include "cocos2d.h"
+#include <vector>
+#include <unordered_map>
+
+// (각형 수, 크기)별 다각형 꼭짓점/면적/관성 모멘트를 한 번만 계산해 공유하는 테이블
+// 텍스처 아틀라스, 물리 바디, 공간 검사가 모두 같은 반지름 공식을 사용하도록 함
+class ShapeGeometry
+{
+public:
+    struct Polygon
+    {
+        int sides;
+        float scale;
+        float radius;
+        float area;
+        float moment; // 기본 재질 밀도 기준 (기존 바디와 동일한 회전 감각 유지)
+        std::vector<cocos2d::Vec2> vertices;
+    };
+
+    static const Polygon& GetPolygon(int sides, float scale);
+    static void Clear();
+
+    static float GetBaseRadius(int sides) { return 20.0f + (sides - 3) * 3.0f; }
+    static float GetRadius(int sides, float scale) { return GetBaseRadius(sides) * scale; }
+
+private:
+    static int MakeKey(int sides, float scale);
+    static void BuildPolygon(Polygon& polygon);
+
+    static std::unordered_map<int, Polygon> polygons;
+};
+
+#endif // __SHAPE_GEOMETRY_H__
@@ -0,0 +1,115 @@
+#include "ShapeLayer.h"
+#include "ShapeSprite.h"
+#include "ShapeTextureAtlas.h"
+#include <cassert>
+
+USING_NS_CC;
+
+ShapeLayer::ShapeLayer()
+{
+}
+
+ShapeLayer* ShapeLayer::Create()
+{
+    ShapeLayer* layer = new (std::nothrow) ShapeLayer();
+
+    if (layer && layer->init())
+    {
+        layer->autorelease();
+        return layer;
+    }
+
+    CC_SAFE_DELETE(layer);
+
+    return nullptr;
+}
+
+bool ShapeLayer::init()
+{
+    if (!Node::init())
+        return false;
+
+    // 도형이 많아지면 자식들을 여러 스레드에서 나눠 방문 (도형은 자기 슬롯에 인스턴스만 기록함)
+    setParallelVisitEnabled(true);
+
+    return true;
+}
+
+void ShapeLayer::addChild(Node* child, int localZOrder, int tag)
+{
+    assert(dynamic_cast<ShapeSprite*>(child) != nullptr && "Error (Render Error) : ShapeLayer에는 ShapeSprite만 추가할 수 있습니다.");
+
+    Node::addChild(child, localZOrder, tag);
+}
+
+void ShapeLayer::addChild(Node* child, int localZOrder, const std::string& name)
+{
+    assert(dynamic_cast<ShapeSprite*>(child) != nullptr && "Error (Render Error) : ShapeLayer에는 ShapeSprite만 추가할 수 있습니다.");
+
+    Node::addChild(child, localZOrder, name);
+}
+
+void ShapeLayer::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (!_visible)
+        return;
+
+    PrepareInstances();
+
+    // 자식들의 draw가 각자의 슬롯을 채움
+    Node::visit(renderer, parentTransform, parentFlags);
+
+    CompactInstances();
+
+    Texture2D* texture = ShapeTextureAtlas::GetInstance()->GetTexture();
+
+    if (instancedCommand.getInstanceCount() == 0 || texture == nullptr)
+        return;
+
+    BlendFunc blendFunc = texture->hasPremultipliedAlpha() ? BlendFunc::ALPHA_PREMULTIPLIED : BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    const Mat4& projection = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+
+    instancedCommand.init(_globalZOrder, texture, blendFunc, projection, parentFlags);
+    renderer->addCommand(&instancedCommand);
+}
+
+void ShapeLayer::SetInstance(int slot, const V3F_C4B_T2F_Quad& quad, const Mat4& transform)
+{
+    instancedCommand.getInstances()[slot].set(quad, transform);
+    filledSlots[slot] = 1;
+}
+
+void ShapeLayer::PrepareInstances()
+{
+    // Node::visit과 같은 순서로 정렬한 뒤 자식 순서대로 슬롯을 나눠줌 (방문 순서 = 그리는 순서)
+    sortAllChildren();
+
+    int count = (int)_children.size();
+
+    instancedCommand.setInstanceCount(count);
+    filledSlots.assign(count, 0);
+
+    for (int i = 0; i < count; i++)
+        static_cast<ShapeSprite*>(_children.at(i))->SetInstanceSlot(this, i);
+}
+
+void ShapeLayer::CompactInstances()
+{
+    // 보이지 않거나 화면 밖이라 그리지 않은 도형의 슬롯을 순서를 유지한 채 제거
+    auto instances = instancedCommand.getInstances();
+    int count = (int)filledSlots.size();
+    int filled = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (filledSlots[i] == 0)
+            continue;
+
+        if (filled != i)
+            instances[filled] = instances[i];
+
+        filled++;
+    }
+
+    instancedCommand.setInstanceCount(filled);
+}
@@ -0,0 +1,38 @@
+#ifndef __SHAPE_LAYER_H__
+#define __SHAPE_LAYER_H__
+
+#include "cocos2d.h"
+#include <vector>
+
+class ShapeSprite;
+
+// 도형(ShapeSprite)만 담는 컨테이너: 자식마다 삼각형 커맨드를 만드는 대신
+// 각 도형이 인스턴스 데이터(변환/UV/색상)만 기록하고 레이어가 InstancedCommand 하나로 그림
+class ShapeLayer : public cocos2d::Node
+{
+public:
+    static ShapeLayer* Create();
+
+    virtual bool init() override;
+
+    // ShapeSprite가 아닌 자식은 인스턴스로 그릴 수 없으므로 허용하지 않음
+    virtual void addChild(cocos2d::Node* child, int localZOrder, int tag) override;
+    virtual void addChild(cocos2d::Node* child, int localZOrder, const std::string& name) override;
+    using cocos2d::Node::addChild;
+
+    virtual void visit(cocos2d::Renderer* renderer, const cocos2d::Mat4& parentTransform, uint32_t parentFlags) override;
+
+    // ShapeSprite::draw에서 호출: 슬롯마다 한 도형만 쓰므로 병렬 방문 중에도 안전
+    void SetInstance(int slot, const cocos2d::V3F_C4B_T2F_Quad& quad, const cocos2d::Mat4& transform);
+
+private:
+    ShapeLayer();
+
+    void PrepareInstances();
+    void CompactInstances();
+
+    cocos2d::InstancedCommand instancedCommand;
+    std::vector<unsigned char> filledSlots; // vector<bool>은 여러 스레드가 동시에 쓸 수 없으므로 바이트 단위
+};
+
+#endif // __SHAPE_LAYER_H__
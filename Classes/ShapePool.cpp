@@ -1,13 +1,18 @@
 #include "ShapePool.h"
 #include "ShapeSprite.h"
+#include <algorithm>
+#include <cassert>
 
 USING_NS_CC;
 
 ShapePool* ShapePool::instance = nullptr;
 
 ShapePool::ShapePool()
-    : totalShapes(0)
+    : pooledCount(0)
+    , totalShapes(0)
     , initialPoolSize(5)
+    , hitCount(0)
+    , missCount(0)
 {
 }
 
@@ -36,18 +41,29 @@ void ShapePool::DestroyInstance()
 
 void ShapePool::Initialize(int initialPoolSize)
 {
-    initialPoolSize = initialPoolSize;
+    this->initialPoolSize = initialPoolSize;
     
-    // 초기 풀 생성 (5개)
-    for (int i = 0; i < initialPoolSize; i++)
+    // 초기 풀 생성 (기본 3각형)
+    Reserve(3, initialPoolSize);
+    
+    CCLOG("ShapePool initialized with %d shapes", pooledCount);
+}
+
+void ShapePool::Reserve(int level, int count)
+{
+    auto& freeList = availableShapes[level];
+    
+    // 이미 충분히 있으면 추가로 만들지 않음
+    for (int i = (int)freeList.size(); i < count; i++)
     {
-        ShapeSprite* shape = CreateNewShape();
+        ShapeSprite* shape = CreateNewShape(level);
+
+        if (shape == nullptr)
+            break;
 
-        if (shape != nullptr)
-            availableShapes.push(shape);
+        freeList.push_back(shape);
+        pooledCount++;
     }
-    
-    CCLOG("ShapePool initialized with %d shapes", (int)availableShapes.size());
 }
 
 void ShapePool::Cleanup()
@@ -58,27 +74,28 @@ void ShapePool::Cleanup()
         if (shape && shape->getParent())
             shape->removeFromParent();
 
-        CC_SAFE_DELETE(shape);
+        CC_SAFE_RELEASE(shape);
     }
 
     activeShapes.clear();
     
     // 풀에 있는 도형들 정리
-    while (!availableShapes.empty())
+    for (auto& entry : availableShapes)
     {
-        ShapeSprite* shape = availableShapes.front();
-        availableShapes.pop();
-
-        CC_SAFE_DELETE(shape);
+        for (auto shape : entry.second)
+            CC_SAFE_RELEASE(shape);
     }
+
+    availableShapes.clear();
     
+    pooledCount = 0;
     totalShapes = 0;
     CCLOG("ShapePool cleaned up");
 }
 
-ShapeSprite* ShapePool::CreateNewShape()
+ShapeSprite* ShapePool::CreateNewShape(int level)
 {
-    ShapeSprite* shape = ShapeSprite::Create(3); // 기본 3각형으로 생성
+    ShapeSprite* shape = ShapeSprite::Create(level, GetScaleForLevel(level));
 
     if (shape != nullptr)
     {
@@ -86,63 +103,75 @@ ShapeSprite* ShapePool::CreateNewShape()
         shape->setVisible(false); // 풀에 있을 때는 보이지 않게
 
         totalShapes++;
+    }
+
+    return shape;
+}
 
-        CCLOG("Created new shape, total shapes: %d", totalShapes);
+ShapeSprite* ShapePool::TakePooledShape(int level)
+{
+    // 같은 레벨 대기 목록을 우선 사용
+    auto it = availableShapes.find(level);
+
+    if (it == availableShapes.end() || it->second.empty())
+    {
+        if (pooledCount == 0)
+            return nullptr;
+
+        // 없으면 아무 레벨에서나 가져와 다시 구성
+        it = std::find_if(availableShapes.begin(), availableShapes.end(),
+            [](const std::pair<const int, std::vector<ShapeSprite*>>& entry) { return !entry.second.empty(); });
     }
 
+    ShapeSprite* shape = it->second.back();
+    it->second.pop_back();
+    pooledCount--;
+
     return shape;
 }
 
+float ShapePool::GetScaleForLevel(int level)
+{
+    // 31레벨부터는 크기로 구분
+    if (level > 30)
+        return 1.0f + ((level - 30) * 0.1f); // 점진적 크기 증가
+
+    return 1.0f;
+}
+
 void ShapePool::ResetShape(ShapeSprite* shape, int level, const cocos2d::Vec2& position)
 {
     if (shape == nullptr) 
         return;
     
-    // 도형의 레벨과 외관 재설정
-    shape->SetLevel(level);
+    float scale = GetScaleForLevel(level);
     
-    // 실제 각형 수도 업데이트 (30각형까지만)
-    int sides = (level <= 30) ? level : 30;
-    shape->SetSides(sides);
-    
-    // 크기 설정
-    float scale = 1.0f;
-
-        // 31레벨부터는 크기로 구분
-    if (level > 30)
-        scale = 1.0f + ((level - 30) * 0.1f); // 점진적 크기 증가
-
-    shape->SetShapeScale(scale);
-    
-    // 텍스처와 물리 바디 재생성
-    shape->CreateShapeTexture();
-    shape->SetupPhysicsBody();
+    // 레벨/크기가 다를 때만 외관 재설정 (기존 물리 바디는 꼭짓점만 교체해 재사용)
+    if (shape->GetLevel() != level || shape->GetShapeScale() != scale)
+        shape->ApplyLevel(level, scale);
     
     // 위치 및 기본 속성 설정
     shape->setPosition(position);
     shape->setVisible(true);
     shape->getPhysicsBody()->setVelocity(Vec2::ZERO);
     shape->getPhysicsBody()->setAngularVelocity(0.0f);
+
+    // 재사용된 도형이 이전 위치에서 보간되어 날아오지 않도록 직전 상태도 맞춤
+    shape->SavePreviousState();
 }
 
 ShapeSprite* ShapePool::GetShape(int level, const cocos2d::Vec2& position)
 {
-    ShapeSprite* shape = nullptr;
-    
-    if (!availableShapes.empty())
-    {
-        // 풀에서 가져오기
-        shape = availableShapes.front();
-        availableShapes.pop();
+    // 풀에서 가져오고, 비어있으면 새로 생성
+    ShapeSprite* shape = TakePooledShape(level);
 
-        CCLOG("Retrieved shape from pool, remaining in pool: %d", (int)availableShapes.size());
-    }
+    if (shape != nullptr)
+        hitCount++;
 
     else
     {
-        // 풀이 비어있으면 새로 생성
-        shape = CreateNewShape();
-        CCLOG("Pool empty, created new shape. Total shapes: %d", totalShapes);
+        shape = CreateNewShape(level);
+        missCount++;
     }
     
     if (shape)
@@ -150,7 +179,8 @@ ShapeSprite* ShapePool::GetShape(int level, const cocos2d::Vec2& position)
         // 도형 재설정
         ResetShape(shape, level, position);
         
-        // 활성 리스트에 추가
+        // 활성 배열 끝에 추가하고 인덱스를 도형에 기록
+        shape->SetPoolIndex((int)activeShapes.size());
         activeShapes.push_back(shape);
     }
     
@@ -159,29 +189,37 @@ ShapeSprite* ShapePool::GetShape(int level, const cocos2d::Vec2& position)
 
 void ShapePool::ReturnShape(ShapeSprite* shape)
 {
-    if (shape == nullptr) 
+    if (shape == nullptr || !shape->IsActive()) 
         return;
     
-    // 활성 리스트에서 제거
-    auto it = std::find(activeShapes.begin(), activeShapes.end(), shape);
+    int index = shape->GetPoolIndex();
 
-    if (it != activeShapes.end())
-    {
-        activeShapes.erase(it);
-        
-        // 씬에서 제거
-        if (shape->getParent())
-            shape->removeFromParent();
-        
-        // 도형 초기화
-        shape->setVisible(false);
-        shape->getPhysicsBody()->setVelocity(Vec2::ZERO);
-        shape->getPhysicsBody()->setAngularVelocity(0.0f);
-        
-        // 풀에 반환
-        availableShapes.push(shape);
-        
-        CCLOG("Shape returned to pool, pool size: %d, active shapes: %d", 
-              (int)availableShapes.size(), (int)activeShapes.size());
-    }
+    assert(index < (int)activeShapes.size() && activeShapes[index] == shape && "Error (Pool Error) : 도형의 풀 인덱스가 올바르지 않습니다.");
+    
+    // 마지막 도형을 빈 자리로 옮겨서 O(1) 제거
+    ShapeSprite* last = activeShapes.back();
+    activeShapes[index] = last;
+    last->SetPoolIndex(index);
+    activeShapes.pop_back();
+    
+    shape->SetPoolIndex(ShapeSprite::INVALID_POOL_INDEX);
+    
+    // 씬에서 제거
+    if (shape->getParent())
+        shape->removeFromParent();
+    
+    // 도형 초기화
+    shape->setVisible(false);
+    shape->getPhysicsBody()->setVelocity(Vec2::ZERO);
+    shape->getPhysicsBody()->setAngularVelocity(0.0f);
+    
+    // 현재 레벨의 대기 목록에 반환 (텍스처 프레임/물리 바디 유지)
+    availableShapes[shape->GetLevel()].push_back(shape);
+    pooledCount++;
+}
+
+void ShapePool::ReturnAllShapes()
+{
+    while (!activeShapes.empty())
+        ReturnShape(activeShapes.back());
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "cocos2d.h"
 #include "ShapeGameScene.h"
 #include <vector>
-#include <queue>
+#include <unordered_map>
 
 class ShapeSprite;
 
@@ -17,26 +17,47 @@ public:
     void Initialize(int initialPoolSize = 5);
     void Cleanup();
     
+    // 해당 레벨 도형을 미리 만들어 레벨별 대기 목록에 넣어둠 (씬 초기화 시 사용)
+    void Reserve(int level, int count);
+    
     ShapeSprite* GetShape(int level, const cocos2d::Vec2& position);
     void ReturnShape(ShapeSprite* shape);
+    void ReturnAllShapes();
+    
+    const std::vector<ShapeSprite*>& GetActiveShapes() const { return activeShapes; }
     
     int GetActiveCount() const { return activeShapes.size(); }
-    int GetPooledCount() const { return availableShapes.size(); }
+    int GetPooledCount() const { return pooledCount; }
     int GetTotalCount() const { return totalShapes; }
+    
+    // GetShape 통계: 풀에서 재사용(hit)했는지 새로 생성(miss)했는지
+    int GetHitCount() const { return hitCount; }
+    int GetMissCount() const { return missCount; }
+    void ResetStats() { hitCount = 0; missCount = 0; }
 
 private:
     ShapePool();
     ~ShapePool();
     
-    ShapeSprite* CreateNewShape();
+    ShapeSprite* CreateNewShape(int level);
+    ShapeSprite* TakePooledShape(int level);
     void ResetShape(ShapeSprite* shape, int level, const cocos2d::Vec2& position);
     
+    static float GetScaleForLevel(int level);
+    
     static ShapePool* instance;
     
-    std::queue<ShapeSprite*> availableShapes;
+    // 레벨별 대기 목록: 같은 레벨로 재사용하면 텍스처 프레임과 물리 바디를 그대로 씀
+    std::unordered_map<int, std::vector<ShapeSprite*>> availableShapes;
+    
+    // 활성 도형의 조밀한 배열, 각 도형은 자신의 인덱스를 알고 있어 O(1)로 제거 가능
     std::vector<ShapeSprite*> activeShapes;
+    
+    int pooledCount;
     int totalShapes;
     int initialPoolSize;
+    int hitCount;
+    int missCount;
     
     ShapePool(const ShapePool&) = delete;
     ShapePool& operator=(const ShapePool&) = delete;
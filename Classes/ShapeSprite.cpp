@@ -1,7 +1,24 @@
 #include "ShapeSprite.h"
+#include "ShapeTextureAtlas.h"
+#include "ShapeGeometry.h"
+#include "ShapeLayer.h"
 
 USING_NS_CC;
 
+float ShapeSprite::interpolationAlpha = 1.0f;
+
+ShapeSprite::ShapeSprite()
+    : sides(3)
+    , shapeScale(1.0f)
+    , level(3)
+    , poolIndex(INVALID_POOL_INDEX)
+    , instanceLayer(nullptr)
+    , instanceSlot(0)
+    , previousRotation(0.0f)
+    , isInterpolated(false)
+{
+}
+
 ShapeSprite* ShapeSprite::Create(int level)
 {
     return Create(level, 1.0f);
@@ -37,6 +54,9 @@ bool ShapeSprite::InitWithLevel(int level, float scale)
     sides = (level <= 30) ? level : 30; // 실제 각형 수도 증가시키되, 성능을 위해 최대 30각형까지만
     shapeScale = scale;
 
+    if (!Sprite::init())
+        return false;
+
     CreateShapeTexture();
     SetupPhysicsBody();
     
@@ -45,78 +65,117 @@ bool ShapeSprite::InitWithLevel(int level, float scale)
 
 void ShapeSprite::CreateShapeTexture()
 {
-    float radius = (20.0f + (sides - 3) * 3.0f) * shapeScale;
     Color3B color = GetColorBySides(level); // 레벨 기반 색상
     
-    auto texture = GeneratePolygonTexture(sides, radius, color);
+    // 미리 구워둔 아틀라스에서 프레임만 교체 (텍스처 생성 없음)
+    auto frame = ShapeTextureAtlas::GetInstance()->GetFrame(sides, color);
+
+    if (frame == nullptr)
+        return;
+
+    this->setSpriteFrame(frame);
 
-    if (texture)
-        this->initWithTexture(texture);
+    // 30레벨 이후의 크기 차이는 아틀라스 프레임을 늘려서 표현
+    this->setContentSize(frame->getOriginalSize() * shapeScale);
 }
 
-Texture2D* ShapeSprite::GeneratePolygonTexture(int sides, float radius, const Color3B& color)
+void ShapeSprite::SetupPhysicsBody()
 {
-    int textureSize = (int)(radius * 2.5f);
+    // 꼭짓점/모멘트는 (각형 수, 크기)별로 한 번만 계산된 값을 공유
+    const auto& polygon = ShapeGeometry::GetPolygon(sides, shapeScale);
     
-    RenderTexture* renderTexture = RenderTexture::create(textureSize, textureSize);
+    auto physicsBody = this->getPhysicsBody();
+    auto firstShape = physicsBody ? physicsBody->getFirstShape() : nullptr;
 
-    if (!renderTexture) 
-        return nullptr;
-    
-    renderTexture->begin();
-    
-    auto drawNode = DrawNode::create();
-    
-    std::vector<Vec2> vertices;
-    float angleStep = 2.0f * M_PI / sides;
-    
-    for (int i = 0; i < sides; i++)
+    if (firstShape != nullptr && firstShape->getType() == PhysicsShape::Type::POLYGON)
     {
-        float angle = i * angleStep - M_PI / 2;
-        float x = radius * cos(angle) + textureSize / 2;
-        float y = radius * sin(angle) + textureSize / 2;
+        // 기존 바디와 셰이프를 그대로 두고 꼭짓점만 교체 (바디 재생성/월드 재등록 없음)
+        static_cast<PhysicsShapePolygon*>(firstShape)->setPoints(polygon.vertices.data(), polygon.sides);
+        physicsBody->updateOwnerCenterOffset(); // 프레임 교체로 바뀐 콘텐츠 크기 반영
+    }
 
-        vertices.push_back(Vec2(x, y));
+    else
+    {
+        physicsBody = PhysicsBody::createPolygon(polygon.vertices.data(), polygon.sides);
+
+        physicsBody->setDynamic(true);
+        physicsBody->setCollisionBitmask(0xFFFFFFFF);
+        physicsBody->getFirstShape()->setRestitution(0.3f);
+        physicsBody->getFirstShape()->setFriction(0.5f);
+        
+        this->setPhysicsBody(physicsBody);
     }
-    
-    drawNode->drawSolidPoly(vertices.data(), sides, Color4F(color.r/255.0f, color.g/255.0f, color.b/255.0f, 1.0f));
-    drawNode->drawPoly(vertices.data(), sides, true, Color4F::WHITE);
-    
-    auto renderer = Director::getInstance()->getRenderer();
-    auto& parentTransform = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 
-    drawNode->visit(renderer, parentTransform, true);
-    renderTexture->end();
-    
-    return renderTexture->getSprite()->getTexture();
+    // 같은 레벨 도형끼리만 접촉 콜백이 오도록 레벨마다 카테고리를 갱신
+    int category = GetCategoryForLevel(level);
+    physicsBody->setCategoryBitmask(category);
+    physicsBody->setContactTestBitmask(category);
+
+    physicsBody->setMass(1.0f);
+    physicsBody->setMoment(polygon.moment);
 }
 
-void ShapeSprite::SetupPhysicsBody()
+void ShapeSprite::ApplyLevel(int level, float scale)
 {
-    float radius = (20.0f + (sides - 3) * 3.0f) * shapeScale;
-    
-    std::vector<Vec2> vertices;
-    float angleStep = 2.0f * M_PI / sides;
-    
-    for (int i = 0; i < sides; i++)
+    this->level = level;
+    sides = (level <= 30) ? level : 30;
+    shapeScale = scale;
+
+    CreateShapeTexture();
+    SetupPhysicsBody();
+}
+
+void ShapeSprite::SavePreviousState()
+{
+    previousPosition = getPosition();
+    previousRotation = getRotation();
+}
+
+void ShapeSprite::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    Vec2 position = getPosition();
+    float rotation = getRotation();
+
+    Vec2 renderPosition = previousPosition.lerp(position, interpolationAlpha);
+    float renderRotation = previousRotation + (rotation - previousRotation) * interpolationAlpha;
+
+    if (interpolationAlpha >= 1.0f || (renderPosition.equals(position) && renderRotation == rotation))
     {
-        float angle = i * angleStep - M_PI / 2;
-        float x = radius * cos(angle);
-        float y = radius * sin(angle);
+        // 직전 프레임에 보정된 행렬이 캐시되어 있으면 다시 계산
+        Sprite::visit(renderer, parentTransform, isInterpolated ? (parentFlags | FLAGS_TRANSFORM_DIRTY) : parentFlags);
+        isInterpolated = false;
+        return;
+    }
+
+    // 노드 상태(=물리 상태)는 그대로 두고 부모 행렬에 "현재 -> 보간" 보정만 곱해서 그림
+    // 보정 = T(보간 위치) * R(회전 차이) * T(-현재 위치), cocos 회전은 시계 방향이므로 부호 반전
+    Mat4 correction;
+    Mat4::createTranslation(renderPosition.x, renderPosition.y, 0.0f, &correction);
+    correction.rotateZ(CC_DEGREES_TO_RADIANS(rotation - renderRotation));
+    correction.translate(-position.x, -position.y, 0.0f);
+
+    Sprite::visit(renderer, parentTransform * correction, parentFlags | FLAGS_TRANSFORM_DIRTY);
+    isInterpolated = true;
+}
 
-        vertices.push_back(Vec2(x, y));
+void ShapeSprite::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    // 다른 부모로 옮겨졌으면 예전 레이어의 슬롯 정보는 무효
+    if (instanceLayer == nullptr || getParent() != instanceLayer)
+    {
+        Sprite::draw(renderer, transform, flags);
+        return;
     }
-    
-    auto physicsBody = PhysicsBody::createPolygon(vertices.data(), sides);
 
-    physicsBody->setDynamic(true);
-    physicsBody->setContactTestBitmask(0xFFFFFFFF);
-    physicsBody->setCollisionBitmask(0xFFFFFFFF);
-    physicsBody->getFirstShape()->setRestitution(0.3f);
-    physicsBody->getFirstShape()->setFriction(0.5f);
-    physicsBody->setMass(1.0f);
-    
-    this->setPhysicsBody(physicsBody);
+    if (_texture == nullptr)
+        return;
+
+#if CC_USE_CULLING
+    if (!renderer->checkVisibility(transform, _contentSize))
+        return;
+#endif
+
+    instanceLayer->SetInstance(instanceSlot, getQuad(), transform);
 }
 
 Color3B ShapeSprite::GetColorBySides(int sides)
@@ -3,15 +3,29 @@
 
 #include "cocos2d.h"
 
+class ShapeLayer;
+
 class ShapeSprite : public cocos2d::Sprite
 {
 public:
+    ShapeSprite();
+    
     static ShapeSprite* Create(int level);
     static ShapeSprite* Create(int level, float scale);
     
     bool InitWithLevel(int level);
     bool InitWithLevel(int level, float scale);
     void SetupPhysicsBody();
+    void ApplyLevel(int level, float scale); // 레벨/크기를 바꾸고 텍스처와 물리 바디를 갱신
+    
+    // 고정 틱 사이의 렌더링 보간: 스텝 직전 상태를 저장하고 visit에서 직전~현재 상태를 섞어 그림
+    virtual void visit(cocos2d::Renderer* renderer, const cocos2d::Mat4& parentTransform, uint32_t parentFlags) override;
+    void SavePreviousState();
+    
+    // ShapeLayer 아래에서는 삼각형 커맨드 대신 레이어가 나눠준 슬롯에 인스턴스 데이터만 기록
+    virtual void draw(cocos2d::Renderer* renderer, const cocos2d::Mat4& transform, uint32_t flags) override;
+    void SetInstanceSlot(ShapeLayer* layer, int slot) { instanceLayer = layer; instanceSlot = slot; }
+    static void SetInterpolationAlpha(float alpha) { interpolationAlpha = alpha; }
     
     int GetSides() const { return sides; }
     void SetSides(int sides) { this->sides = sides; }
@@ -20,15 +34,36 @@ public:
     int GetLevel() const { return level; }
     void SetLevel(int level) { this->level = level; }
     
+    // ShapePool 활성 배열에서의 위치 (풀에 있으면 INVALID_POOL_INDEX)
+    int GetPoolIndex() const { return poolIndex; }
+    void SetPoolIndex(int index) { poolIndex = index; }
+    bool IsActive() const { return poolIndex != INVALID_POOL_INDEX; }
+    
+    static const int INVALID_POOL_INDEX = -1;
+    
     void CreateShapeTexture();
     static cocos2d::Color3B GetColorBySides(int sides);
     
+    // 레벨별 충돌 카테고리: 같은 비트끼리만 접촉 이벤트가 발생 (벽은 별도 비트, 이벤트 없음)
+    static int GetCategoryForLevel(int level) { return 1 << (level % LEVEL_CATEGORY_COUNT); }
+    
+    static const int LEVEL_CATEGORY_COUNT = 31;
+    static const int WALL_CATEGORY = (int)0x80000000;
+    
 private:
     int sides;
     float shapeScale;
     int level; // 실제 도형 레벨 (3=삼각형, 11=11각형 등)
+    int poolIndex;
+    
+    ShapeLayer* instanceLayer;
+    int instanceSlot;
+    
+    cocos2d::Vec2 previousPosition;
+    float previousRotation;
+    bool isInterpolated;
     
-    cocos2d::Texture2D* GeneratePolygonTexture(int sides, float radius, const cocos2d::Color3B& color);
+    static float interpolationAlpha;
 };
 
 #endif
\ No newline at end of file
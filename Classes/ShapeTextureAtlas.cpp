@@ -0,0 +1,175 @@
+#include "ShapeTextureAtlas.h"
+#include "ShapeSprite.h"
+#include "ShapeGeometry.h"
+
+USING_NS_CC;
+
+ShapeTextureAtlas* ShapeTextureAtlas::instance = nullptr;
+
+const int ShapeTextureAtlas::MIN_SIDES = 3;
+const int ShapeTextureAtlas::MAX_SIDES = 30;
+const float ShapeTextureAtlas::ATLAS_WIDTH = 1024.0f;
+const float ShapeTextureAtlas::CELL_PADDING = 2.0f;
+
+ShapeTextureAtlas::ShapeTextureAtlas()
+    : renderTexture(nullptr)
+    , drawNode(nullptr)
+{
+}
+
+ShapeTextureAtlas::~ShapeTextureAtlas()
+{
+    Cleanup();
+}
+
+ShapeTextureAtlas* ShapeTextureAtlas::GetInstance()
+{
+    if (instance == nullptr)
+        instance = new ShapeTextureAtlas();
+
+    return instance;
+}
+
+void ShapeTextureAtlas::DestroyInstance()
+{
+    if (instance != nullptr)
+    {
+        delete instance;
+
+        instance = nullptr;
+    }
+}
+
+void ShapeTextureAtlas::Initialize()
+{
+    // 이미 구워져 있으면 다시 만들지 않음
+    if (IsInitialized())
+        return;
+
+    std::vector<Cell> cells;
+    CollectCells(cells);
+
+    Size atlasSize = LayoutCells(cells);
+
+    renderTexture = RenderTexture::create((int)atlasSize.width, (int)atlasSize.height);
+
+    if (renderTexture == nullptr)
+        return;
+
+    renderTexture->retain();
+
+    // 실제 렌더링은 이번 프레임의 렌더 패스에서 일어나므로 그때까지 DrawNode를 유지
+    drawNode = DrawNode::create();
+    drawNode->retain();
+
+    for (const auto& cell : cells)
+        DrawCell(drawNode, cell, atlasSize.height);
+
+    renderTexture->beginWithClear(0.0f, 0.0f, 0.0f, 0.0f);
+
+    auto renderer = Director::getInstance()->getRenderer();
+    auto& parentTransform = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+
+    drawNode->visit(renderer, parentTransform, true);
+    renderTexture->end();
+
+    Texture2D* texture = renderTexture->getSprite()->getTexture();
+
+    for (const auto& cell : cells)
+        frames.insert(MakeKey(cell.sides, cell.color), SpriteFrame::createWithTexture(texture, cell.rect));
+
+    CCLOG("ShapeTextureAtlas baked %d frames into %dx%d texture", (int)frames.size(), (int)atlasSize.width, (int)atlasSize.height);
+}
+
+void ShapeTextureAtlas::Cleanup()
+{
+    frames.clear();
+
+    CC_SAFE_RELEASE_NULL(drawNode);
+    CC_SAFE_RELEASE_NULL(renderTexture);
+}
+
+SpriteFrame* ShapeTextureAtlas::GetFrame(int sides, const Color3B& color)
+{
+    if (!IsInitialized())
+        Initialize();
+
+    return frames.at(MakeKey(sides, color));
+}
+
+Texture2D* ShapeTextureAtlas::GetTexture() const
+{
+    if (renderTexture == nullptr)
+        return nullptr;
+
+    return renderTexture->getSprite()->getTexture();
+}
+
+void ShapeTextureAtlas::CollectCells(std::vector<Cell>& cells) const
+{
+    // 3~30레벨: 레벨 = 각형 수, 색상은 레벨 기반
+    for (int sides = MIN_SIDES; sides <= MAX_SIDES; sides++)
+        cells.push_back({ sides, ShapeSprite::GetColorBySides(sides), Rect::ZERO });
+
+    // 30레벨 이후: 30각형 + 금색/은색/백금색 순환
+    for (int level = MAX_SIDES + 1; level <= MAX_SIDES + 3; level++)
+        cells.push_back({ MAX_SIDES, ShapeSprite::GetColorBySides(level), Rect::ZERO });
+}
+
+Size ShapeTextureAtlas::LayoutCells(std::vector<Cell>& cells) const
+{
+    // 단순 선반(shelf) 배치: 왼쪽에서 오른쪽으로 채우고 넘치면 다음 줄로
+    float x = 0.0f;
+    float y = 0.0f;
+    float shelfHeight = 0.0f;
+
+    for (auto& cell : cells)
+    {
+        float cellSize = (float)(int)(ShapeGeometry::GetBaseRadius(cell.sides) * 2.5f);
+
+        if (x + cellSize + CELL_PADDING > ATLAS_WIDTH)
+        {
+            x = 0.0f;
+            y += shelfHeight;
+            shelfHeight = 0.0f;
+        }
+
+        cell.rect = Rect(x + CELL_PADDING, y + CELL_PADDING, cellSize, cellSize);
+
+        x += cellSize + CELL_PADDING;
+        shelfHeight = MAX(shelfHeight, cellSize + CELL_PADDING);
+    }
+
+    return Size(ATLAS_WIDTH, y + shelfHeight + CELL_PADDING);
+}
+
+void ShapeTextureAtlas::DrawCell(DrawNode* drawNode, const Cell& cell, float atlasHeight) const
+{
+    const auto& polygon = ShapeGeometry::GetPolygon(cell.sides, 1.0f);
+    float cellSize = cell.rect.size.width;
+
+    // SpriteFrame의 rect는 텍스처 상단 기준이므로 렌더 타깃 좌표로 변환
+    // GL 렌더 텍스처는 상하가 뒤집혀 저장되므로 도형도 뒤집어 그려야 물리 바디와 방향이 일치함
+#if defined(CC_USE_GL) || defined(CC_USE_GLES)
+    float centerY = cell.rect.origin.y + cellSize / 2;
+    float flipY = -1.0f;
+#else
+    float centerY = atlasHeight - (cell.rect.origin.y + cellSize / 2);
+    float flipY = 1.0f;
+#endif
+    float centerX = cell.rect.origin.x + cellSize / 2;
+
+    std::vector<Vec2> vertices;
+    vertices.reserve(cell.sides);
+
+    for (const auto& vertex : polygon.vertices)
+        vertices.push_back(Vec2(vertex.x + centerX, flipY * vertex.y + centerY));
+    
+    drawNode->drawSolidPoly(vertices.data(), cell.sides, Color4F(cell.color.r/255.0f, cell.color.g/255.0f, cell.color.b/255.0f, 1.0f));
+    drawNode->drawPoly(vertices.data(), cell.sides, true, Color4F::WHITE);
+}
+
+unsigned int ShapeTextureAtlas::MakeKey(int sides, const Color3B& color)
+{
+    return ((unsigned int)sides << 24) | ((unsigned int)color.r << 16) | ((unsigned int)color.g << 8) | (unsigned int)color.b;
+}
@@ -0,0 +1,55 @@
+#ifndef __SHAPE_TEXTURE_ATLAS_H__
+#define __SHAPE_TEXTURE_ATLAS_H__
+
+#include "cocos2d.h"
+#include <vector>
+
+// 3~30각형(및 30레벨 이후 특수 색상)을 하나의 텍스처에 미리 구워두는 아틀라스
+// 도형 생성/합치기 시에는 SpriteFrame만 교체하므로 모든 도형이 한 텍스처를 공유하고 한 번에 배칭됨
+class ShapeTextureAtlas
+{
+public:
+    static ShapeTextureAtlas* GetInstance();
+    static void DestroyInstance();
+
+    void Initialize();
+    void Cleanup();
+    bool IsInitialized() const { return renderTexture != nullptr; }
+
+    cocos2d::SpriteFrame* GetFrame(int sides, const cocos2d::Color3B& color);
+    cocos2d::Texture2D* GetTexture() const;
+
+    static const int MIN_SIDES;
+    static const int MAX_SIDES;
+
+private:
+    ShapeTextureAtlas();
+    ~ShapeTextureAtlas();
+
+    struct Cell
+    {
+        int sides;
+        cocos2d::Color3B color;
+        cocos2d::Rect rect;
+    };
+
+    void CollectCells(std::vector<Cell>& cells) const;
+    cocos2d::Size LayoutCells(std::vector<Cell>& cells) const;
+    void DrawCell(cocos2d::DrawNode* drawNode, const Cell& cell, float atlasHeight) const;
+
+    static unsigned int MakeKey(int sides, const cocos2d::Color3B& color);
+
+    static ShapeTextureAtlas* instance;
+
+    cocos2d::RenderTexture* renderTexture;
+    cocos2d::DrawNode* drawNode;
+    cocos2d::Map<unsigned int, cocos2d::SpriteFrame*> frames;
+
+    static const float ATLAS_WIDTH;
+    static const float CELL_PADDING;
+
+    ShapeTextureAtlas(const ShapeTextureAtlas&) = delete;
+    ShapeTextureAtlas& operator=(const ShapeTextureAtlas&) = delete;
+};
+
+#endif // __SHAPE_TEXTURE_ATLAS_H__
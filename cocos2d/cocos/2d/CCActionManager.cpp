@@ -35,7 +35,24 @@ THE SOFTWARE.
 #include "base/ccCArray.h"
 #include "base/uthash.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
 NS_CC_BEGIN
+
+// the properties a tween can animate, one pool each
+enum
+{
+    TWEEN_POSITION,
+    TWEEN_SCALE,
+    TWEEN_ROTATION,
+    TWEEN_OPACITY,
+    TWEEN_COLOR,
+    TWEEN_PROPERTY_COUNT
+};
+
 //
 // singleton stuff
 //
@@ -47,13 +64,152 @@ typedef struct _hashElement
     Action              *currentAction;
     bool                currentActionSalvaged;
     bool                paused;
+    int                 tweenIndex[TWEEN_PROPERTY_COUNT];  // slot in the pool of each property, -1 if none
+    int                 tweenCount;
     UT_hash_handle      hh;
 } tHashElement;
 
+// A tween is stored by value: the value is from + delta * easing(elapsed / duration)
+template <typename T>
+struct TweenRecord
+{
+    tHashElement            *element;   // nullptr once removed, the slot is reclaimed by compact()
+    float                   elapsed;
+    float                   duration;
+    tweenfunc::TweenType    easing;
+    float                   easingParam;
+    bool                    firstTick;
+    T                       from;
+    T                       delta;
+};
+
+struct TweenPoolBase
+{
+    virtual ~TweenPoolBase() {}
+    virtual void remove(int index) = 0;
+    virtual void compact(int property) = 0;
+};
+
+template <typename T>
+struct TweenPool : public TweenPoolBase
+{
+    std::vector<TweenRecord<T>> tweens;
+
+    void add(tHashElement *element, int property, float duration, const T& from, const T& delta,
+             tweenfunc::TweenType easing, float easingParam)
+    {
+        int& index = element->tweenIndex[property];
+
+        // a running tween of the same property is restarted in place
+        if (index < 0)
+        {
+            index = (int)tweens.size();
+            tweens.push_back(TweenRecord<T>());
+            element->tweenCount++;
+        }
+
+        TweenRecord<T>& tween = tweens[index];
+        tween.element = element;
+        tween.elapsed = 0;
+        tween.duration = std::max(duration, FLT_EPSILON); // same as ActionInterval::initWithDuration
+        tween.easing = easing;
+        tween.easingParam = easingParam;
+        tween.firstTick = true;
+        tween.from = from;
+        tween.delta = delta;
+    }
+
+    virtual void remove(int index) override
+    {
+        tweens[index].element = nullptr;
+    }
+
+    virtual void compact(int property) override
+    {
+        for (size_t i = 0; i < tweens.size(); )
+        {
+            if (tweens[i].element != nullptr)
+            {
+                ++i;
+                continue;
+            }
+
+            tweens[i] = tweens.back();
+            tweens.pop_back();
+
+            if (i < tweens.size() && tweens[i].element != nullptr)
+            {
+                tweens[i].element->tweenIndex[property] = (int)i;
+            }
+        }
+    }
+
+    // The setters may add or remove tweens, so the records are accessed by index and checked again after them
+    template <typename Apply, typename Finish>
+    void step(float dt, const Apply& apply, const Finish& finish)
+    {
+        size_t count = tweens.size(); // tweens added during the loop start on the next frame
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            TweenRecord<T>& tween = tweens[i];
+            tHashElement *element = tween.element;
+
+            if (element == nullptr || element->paused)
+            {
+                continue;
+            }
+
+            // same as ActionInterval::step
+            if (tween.firstTick)
+            {
+                tween.firstTick = false;
+                tween.elapsed = 0;
+            }
+            else
+            {
+                tween.elapsed += dt;
+            }
+
+            float time = std::max(0.0f, std::min(1.0f, tween.elapsed / tween.duration));
+            apply(element->target, tween.from + tween.delta * tweenfunc::tweenTo(time, tween.easing, &tween.easingParam));
+
+            if (tweens[i].element == element && tweens[i].elapsed >= tweens[i].duration)
+            {
+                finish(element);
+            }
+        }
+    }
+};
+
+struct _tweenPools
+{
+    TweenPool<Vec2>     positions;
+    TweenPool<Vec2>     scales;
+    TweenPool<float>    rotations;
+    TweenPool<float>    opacities;
+    TweenPool<Vec3>     colors;
+    TweenPoolBase       *pools[TWEEN_PROPERTY_COUNT];
+    ssize_t             count;
+    bool                dirty;     // some slots were removed and wait for compact()
+
+    _tweenPools()
+    : count(0)
+    , dirty(false)
+    {
+        pools[TWEEN_POSITION] = &positions;
+        pools[TWEEN_SCALE] = &scales;
+        pools[TWEEN_ROTATION] = &rotations;
+        pools[TWEEN_OPACITY] = &opacities;
+        pools[TWEEN_COLOR] = &colors;
+    }
+};
+
 ActionManager::ActionManager()
 : _targets(nullptr),
   _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _currentTargetSalvaged(false),
+  _tweens(new (std::nothrow) _tweenPools())
 {
 
 }
@@ -63,12 +219,14 @@ ActionManager::~ActionManager()
     CCLOGINFO("deallocing ActionManager: %p", this);
 
     removeAllActions();
+    delete _tweens;
 }
 
 // private
 
 void ActionManager::deleteHashElement(tHashElement *element)
 {
+    removeTweensFromElement(element);
     ccArrayFree(element->actions);
     HASH_DEL(_targets, element);
     element->target->release();
@@ -89,6 +247,25 @@ void ActionManager::actionAllocWithHashElement(tHashElement *element)
 
 }
 
+tHashElement* ActionManager::hashElementForTarget(Node *target, bool paused)
+{
+    tHashElement *element = nullptr;
+    // we should convert it to Ref*, because we save it as Ref*
+    Ref *tmp = target;
+    HASH_FIND_PTR(_targets, &tmp, element);
+    if (! element)
+    {
+        element = (tHashElement*)calloc(sizeof(*element), 1);
+        element->paused = paused;
+        std::fill(element->tweenIndex, element->tweenIndex + TWEEN_PROPERTY_COUNT, -1);
+        target->retain();
+        element->target = target;
+        HASH_ADD_PTR(_targets, target, element);
+    }
+
+    return element;
+}
+
 void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
 {
     Action *action = static_cast<Action*>(element->actions->arr[index]);
@@ -107,7 +284,7 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
         element->actionIndex--;
     }
 
-    if (element->actions->num == 0)
+    if (element->actions->num == 0 && element->tweenCount == 0)
     {
         if (_currentTarget == element)
         {
@@ -175,18 +352,7 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
     if(action == nullptr || target == nullptr)
         return;
 
-    tHashElement *element = nullptr;
-    // we should convert it to Ref*, because we save it as Ref*
-    Ref *tmp = target;
-    HASH_FIND_PTR(_targets, &tmp, element);
-    if (! element)
-    {
-        element = (tHashElement*)calloc(sizeof(*element), 1);
-        element->paused = paused;
-        target->retain();
-        element->target = target;
-        HASH_ADD_PTR(_targets, target, element);
-    }
+    tHashElement *element = hashElementForTarget(target, paused);
 
      actionAllocWithHashElement(element);
  
@@ -227,6 +393,7 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
         }
 
         ccArrayRemoveAllObjects(element->actions);
+        removeTweensFromElement(element);
         if (_currentTarget == element)
         {
             _currentTargetSalvaged = true;
@@ -436,9 +603,196 @@ ssize_t ActionManager::getNumberOfRunningActions() const
     return count;
 }
 
+// tweens
+
+void ActionManager::tweenMoveTo(Node *target, float duration, const Vec2& position, tweenfunc::TweenType easing, float easingParam)
+{
+    CCASSERT(target != nullptr, "target can't be nullptr!");
+    CCASSERT(easing != tweenfunc::CUSTOM_EASING, "custom easing is not supported by tweens!");
+
+    tHashElement *element = hashElementForTarget(target, !target->isRunning());
+    actionAllocWithHashElement(element);
+
+    int previous = element->tweenCount;
+    _tweens->positions.add(element, TWEEN_POSITION, duration, target->getPosition(), position - target->getPosition(), easing, easingParam);
+    _tweens->count += element->tweenCount - previous;
+}
+
+void ActionManager::tweenScaleTo(Node *target, float duration, float scaleX, float scaleY, tweenfunc::TweenType easing, float easingParam)
+{
+    CCASSERT(target != nullptr, "target can't be nullptr!");
+    CCASSERT(easing != tweenfunc::CUSTOM_EASING, "custom easing is not supported by tweens!");
+
+    tHashElement *element = hashElementForTarget(target, !target->isRunning());
+    actionAllocWithHashElement(element);
+
+    Vec2 from(target->getScaleX(), target->getScaleY());
+    int previous = element->tweenCount;
+    _tweens->scales.add(element, TWEEN_SCALE, duration, from, Vec2(scaleX, scaleY) - from, easing, easingParam);
+    _tweens->count += element->tweenCount - previous;
+}
+
+void ActionManager::tweenRotateTo(Node *target, float duration, float rotation, tweenfunc::TweenType easing, float easingParam)
+{
+    CCASSERT(target != nullptr, "target can't be nullptr!");
+    CCASSERT(easing != tweenfunc::CUSTOM_EASING, "custom easing is not supported by tweens!");
+
+    tHashElement *element = hashElementForTarget(target, !target->isRunning());
+    actionAllocWithHashElement(element);
+
+    // same as RotateTo::calculateAngles
+    float from = target->getRotation();
+    from = (from > 0) ? fmodf(from, 360.0f) : fmodf(from, -360.0f);
+
+    float delta = rotation - from;
+    if (delta > 180)
+    {
+        delta -= 360;
+    }
+    if (delta < -180)
+    {
+        delta += 360;
+    }
+
+    int previous = element->tweenCount;
+    _tweens->rotations.add(element, TWEEN_ROTATION, duration, from, delta, easing, easingParam);
+    _tweens->count += element->tweenCount - previous;
+}
+
+void ActionManager::tweenFadeTo(Node *target, float duration, uint8_t opacity, tweenfunc::TweenType easing, float easingParam)
+{
+    CCASSERT(target != nullptr, "target can't be nullptr!");
+    CCASSERT(easing != tweenfunc::CUSTOM_EASING, "custom easing is not supported by tweens!");
+
+    tHashElement *element = hashElementForTarget(target, !target->isRunning());
+    actionAllocWithHashElement(element);
+
+    float from = target->getOpacity();
+    int previous = element->tweenCount;
+    _tweens->opacities.add(element, TWEEN_OPACITY, duration, from, opacity - from, easing, easingParam);
+    _tweens->count += element->tweenCount - previous;
+}
+
+void ActionManager::tweenTintTo(Node *target, float duration, const Color3B& color, tweenfunc::TweenType easing, float easingParam)
+{
+    CCASSERT(target != nullptr, "target can't be nullptr!");
+    CCASSERT(easing != tweenfunc::CUSTOM_EASING, "custom easing is not supported by tweens!");
+
+    tHashElement *element = hashElementForTarget(target, !target->isRunning());
+    actionAllocWithHashElement(element);
+
+    const Color3B& current = target->getColor();
+    Vec3 from(current.r, current.g, current.b);
+    int previous = element->tweenCount;
+    _tweens->colors.add(element, TWEEN_COLOR, duration, from, Vec3(color.r, color.g, color.b) - from, easing, easingParam);
+    _tweens->count += element->tweenCount - previous;
+}
+
+void ActionManager::removeAllTweensFromTarget(Node *target)
+{
+    if (target == nullptr)
+    {
+        return;
+    }
+
+    tHashElement *element = nullptr;
+    HASH_FIND_PTR(_targets, &target, element);
+    if (element && element->tweenCount > 0)
+    {
+        removeTweensFromElement(element);
+
+        if (element->actions->num == 0)
+        {
+            if (_currentTarget == element)
+            {
+                _currentTargetSalvaged = true;
+            }
+            else
+            {
+                deleteHashElement(element);
+            }
+        }
+    }
+}
+
+ssize_t ActionManager::getNumberOfRunningTweens() const
+{
+    return _tweens->count;
+}
+
+void ActionManager::removeTween(tHashElement *element, int property)
+{
+    int& index = element->tweenIndex[property];
+    if (index < 0)
+    {
+        return;
+    }
+
+    _tweens->pools[property]->remove(index);
+    _tweens->dirty = true;
+    _tweens->count--;
+    index = -1;
+    element->tweenCount--;
+}
+
+void ActionManager::removeTweensFromElement(tHashElement *element)
+{
+    for (int property = 0; property < TWEEN_PROPERTY_COUNT && element->tweenCount > 0; ++property)
+    {
+        removeTween(element, property);
+    }
+}
+
+void ActionManager::updateTweens(float dt)
+{
+    auto finish = [this](int property) {
+        return [this, property](tHashElement *element) {
+            removeTween(element, property);
+
+            if (element->actions->num == 0 && element->tweenCount == 0)
+            {
+                deleteHashElement(element);
+            }
+        };
+    };
+
+    _tweens->positions.step(dt, [](Node *target, const Vec2& position) {
+        target->setPosition(position);
+    }, finish(TWEEN_POSITION));
+
+    _tweens->scales.step(dt, [](Node *target, const Vec2& scale) {
+        target->setScaleX(scale.x);
+        target->setScaleY(scale.y);
+    }, finish(TWEEN_SCALE));
+
+    _tweens->rotations.step(dt, [](Node *target, float rotation) {
+        target->setRotation(rotation);
+    }, finish(TWEEN_ROTATION));
+
+    _tweens->opacities.step(dt, [](Node *target, float opacity) {
+        target->setOpacity((uint8_t)opacity);
+    }, finish(TWEEN_OPACITY));
+
+    _tweens->colors.step(dt, [](Node *target, const Vec3& color) {
+        target->setColor(Color3B((uint8_t)color.x, (uint8_t)color.y, (uint8_t)color.z));
+    }, finish(TWEEN_COLOR));
+
+    if (_tweens->dirty)
+    {
+        for (int property = 0; property < TWEEN_PROPERTY_COUNT; ++property)
+        {
+            _tweens->pools[property]->compact(property);
+        }
+        _tweens->dirty = false;
+    }
+}
+
 // main loop
 void ActionManager::update(float dt)
 {
+    // The tweens first, in tight loops over their pools. Only the actions need the walk over the targets.
+    updateTweens(dt);
+
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
@@ -486,7 +840,7 @@ void ActionManager::update(float dt)
         elt = (tHashElement*)(elt->hh.next);
 
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+        if (_currentTargetSalvaged && _currentTarget->actions->num == 0 && _currentTarget->tweenCount == 0)
         {
             deleteHashElement(_currentTarget);
         }
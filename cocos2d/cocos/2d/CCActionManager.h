@@ -31,14 +31,17 @@ THE SOFTWARE.
 #define __ACTION_CCACTION_MANAGER_H__
 
 #include "2d/CCAction.h"
+#include "2d/CCTweenFunction.h"
 #include "base/CCVector.h"
 #include "base/CCRef.h"
+#include "base/ccTypes.h"
 
 NS_CC_BEGIN
 
 class Action;
 
 struct _hashElement;
+struct _tweenPools;
 
 /**
  * @addtogroup actions
@@ -189,6 +192,57 @@ public:
      * @param targetsToResume   A set of targets need to be resumed.
      */
     virtual void resumeTargets(const Vector<Node*>& targetsToResume);
+
+    // tweens
+
+    /** Moves the target to a position, like running a MoveTo wrapped in an ease action, without creating any Action.
+     * Tweens are kept by value in one contiguous array per property and stepped in a tight loop,
+     * and the slots of the finished ones are reused, so they are much cheaper than actions when many run at once.
+     * A tween replaces the running tween of the same property of the target.
+     * Tweens are paused, resumed and removed together with the actions of their target.
+     *
+     * @param target        A certain target.
+     * @param duration      Duration in seconds.
+     * @param position      The destination position.
+     * @param easing        The easing curve, tweenfunc::CUSTOM_EASING is not supported.
+     * @param easingParam   The period of the elastic curves, ignored by the other curves.
+     */
+    virtual void tweenMoveTo(Node *target, float duration, const Vec2& position,
+                             tweenfunc::TweenType easing = tweenfunc::Linear, float easingParam = 0.3f);
+
+    /** Scales the target, like running a ScaleTo wrapped in an ease action, without creating any Action.
+     * @see tweenMoveTo
+     */
+    virtual void tweenScaleTo(Node *target, float duration, float scaleX, float scaleY,
+                              tweenfunc::TweenType easing = tweenfunc::Linear, float easingParam = 0.3f);
+
+    /** Rotates the target the shortest way, like running a RotateTo wrapped in an ease action, without creating any Action.
+     * @see tweenMoveTo
+     */
+    virtual void tweenRotateTo(Node *target, float duration, float rotation,
+                               tweenfunc::TweenType easing = tweenfunc::Linear, float easingParam = 0.3f);
+
+    /** Fades the target, like running a FadeTo wrapped in an ease action, without creating any Action.
+     * @see tweenMoveTo
+     */
+    virtual void tweenFadeTo(Node *target, float duration, uint8_t opacity,
+                             tweenfunc::TweenType easing = tweenfunc::Linear, float easingParam = 0.3f);
+
+    /** Tints the target, like running a TintTo wrapped in an ease action, without creating any Action.
+     * @see tweenMoveTo
+     */
+    virtual void tweenTintTo(Node *target, float duration, const Color3B& color,
+                             tweenfunc::TweenType easing = tweenfunc::Linear, float easingParam = 0.3f);
+
+    /** Removes all the tweens of the target, leaving its actions running.
+     *
+     * @param target    A certain target.
+     */
+    virtual void removeAllTweensFromTarget(Node *target);
+
+    /** Returns the number of tweens that are running in all the targets.
+     */
+    virtual ssize_t getNumberOfRunningTweens() const;
     
     /** Main loop of ActionManager.
      * @param dt    In seconds.
@@ -201,11 +255,19 @@ protected:
     void removeActionAtIndex(ssize_t index, struct _hashElement *element);
     void deleteHashElement(struct _hashElement *element);
     void actionAllocWithHashElement(struct _hashElement *element);
+    struct _hashElement* hashElementForTarget(Node *target, bool paused);
+
+    // tween specific
+
+    void removeTween(struct _hashElement *element, int property);
+    void removeTweensFromElement(struct _hashElement *element);
+    void updateTweens(float dt);
 
 protected:
     struct _hashElement    *_targets;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
+    struct _tweenPools     *_tweens;
 };
 
 // end of actions group
@@ -36,12 +36,14 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCJobSystem.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
 #include "2d/CCActionManager.h"
 #include "2d/CCScene.h"
 #include "2d/CCComponent.h"
 #include "renderer/CCMaterial.h"
+#include "renderer/CCRenderer.h"
 #include "math/TransformUtils.h"
 
 
@@ -58,6 +60,14 @@ NS_CC_BEGIN
 std::uint32_t Node::s_globalOrderOfArrival = 0;
 int Node::__attachedNodeCount = 0;
 
+// children visited by one job, and the least number of children worth a parallel visit
+static const ssize_t PARALLEL_VISIT_CHUNK_SIZE = 64;
+static const ssize_t PARALLEL_VISIT_MIN_CHILDREN = PARALLEL_VISIT_CHUNK_SIZE * 2;
+// set on the threads visiting a chunk, nested parallel visits and the matrix stack are skipped there
+static thread_local bool s_visitingInParallel = false;
+// commands of each chunk, only touched by the main thread outside of parallelFor()
+static std::vector<std::vector<RenderCommand*>> s_parallelVisitCommands;
+
 // MARK: Constructor, Destructor, Init
 
 Node::Node()
@@ -95,6 +105,7 @@ Node::Node()
 , _userObject(nullptr)
 , _running(false)
 , _visible(true)
+, _parallelVisitEnabled(false)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
 , _isTransitionFinished(false)
@@ -1221,14 +1232,31 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
-    _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-    _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    // It is shared by all threads, so subtrees visited in parallel don't update it
+    bool useMatrixStack = !s_visitingInParallel;
+    if (useMatrixStack)
+    {
+        _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    }
     
     bool visibleByCamera = isVisitableByVisitingCamera();
 
     int i = 0;
 
-    if(!_children.empty())
+    if (_parallelVisitEnabled && !s_visitingInParallel && (ssize_t)_children.size() >= PARALLEL_VISIT_MIN_CHILDREN)
+    {
+        sortAllChildren();
+        auto size = _children.size();
+        while (i < size && _children.at(i)->_localZOrder < 0)
+            ++i;
+
+        visitChildrenInParallel(renderer, flags, 0, i);
+        if (visibleByCamera)
+            this->draw(renderer, _modelViewTransform, flags);
+        visitChildrenInParallel(renderer, flags, i, size);
+    }
+    else if(!_children.empty())
     {
         sortAllChildren();
         // draw children zOrder < 0
@@ -1253,7 +1281,8 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
         this->draw(renderer, _modelViewTransform, flags);
     }
 
-    _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    if (useMatrixStack)
+        _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     
     // FIX ME: Why need to set _orderOfArrival to 0??
     // Please refer to https://github.com/cocos2d/cocos2d-x/pull/6920
@@ -1261,6 +1290,40 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
     // _orderOfArrival = 0;
 }
 
+void Node::visitChildrenInParallel(Renderer* renderer, uint32_t flags, ssize_t first, ssize_t last)
+{
+    ssize_t count = last - first;
+    if (count <= 0)
+        return;
+
+    ssize_t chunkCount = (count + PARALLEL_VISIT_CHUNK_SIZE - 1) / PARALLEL_VISIT_CHUNK_SIZE;
+    if ((ssize_t)s_parallelVisitCommands.size() < chunkCount)
+        s_parallelVisitCommands.resize(chunkCount);
+
+    JobSystem::getInstance()->parallelFor(chunkCount, [&](size_t chunk) {
+        auto& commands = s_parallelVisitCommands[chunk];
+        commands.clear();
+
+        Renderer::setCommandRecorder(&commands);
+        s_visitingInParallel = true;
+
+        ssize_t begin = first + (ssize_t)chunk * PARALLEL_VISIT_CHUNK_SIZE;
+        ssize_t end = std::min(last, begin + PARALLEL_VISIT_CHUNK_SIZE);
+        for (ssize_t i = begin; i < end; ++i)
+            _children.at(i)->visit(renderer, _modelViewTransform, flags);
+
+        s_visitingInParallel = false;
+        Renderer::setCommandRecorder(nullptr);
+    });
+
+    // add the commands in child order, the same order a single threaded visit would have
+    for (ssize_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        for (auto command : s_parallelVisitCommands[chunk])
+            renderer->addCommand(command);
+    }
+}
+
 Mat4 Node::transform(const Mat4& parentTransform)
 {
     return parentTransform * this->getNodeToParentTransform();
@@ -1122,6 +1122,23 @@ public:
     virtual void visit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags);
     virtual void visit() final;
 
+    /**
+     * Sets whether the children of this node are visited in parallel on the JobSystem when there are many of them.
+     * The commands they add are merged in the same order as a single threaded visit.
+     * Only enable it when every child subtree just adds commands with `Renderer::addCommand(RenderCommand*)`:
+     * no render groups, no deprecated matrix stack, no nodes or autoreleased objects created while visiting.
+     * Disabled by default.
+     *
+     * @param enabled Whether the children are visited in parallel.
+     */
+    void setParallelVisitEnabled(bool enabled) { _parallelVisitEnabled = enabled; }
+    /**
+     * Returns whether the children of this node are visited in parallel.
+     *
+     * @return Whether the children are visited in parallel.
+     */
+    bool isParallelVisitEnabled() const { return _parallelVisitEnabled; }
+
 
     /** Returns the Scene that contains the Node.
      It returns `nullptr` if the node doesn't belong to any Scene.
@@ -1792,6 +1809,7 @@ protected:
 
     Mat4 transform(const Mat4 &parentTransform);
     uint32_t processParentFlags(const Mat4& parentTransform, uint32_t parentFlags);
+    void visitChildrenInParallel(Renderer* renderer, uint32_t flags, ssize_t first, ssize_t last);
 
     virtual void updateCascadeOpacity();
     virtual void disableCascadeOpacity();
@@ -1897,6 +1915,8 @@ protected:
 
     bool _visible;                  ///< is this node visible
 
+    bool _parallelVisitEnabled;     ///< whether the children are visited on the job system
+
     bool _ignoreAnchorPointForPosition; ///< true if the Anchor Vec2 will be (0,0) when you position the Node, false otherwise.
                                           ///< Used by Layer and Scene.
 
@@ -26,31 +26,63 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
 
+#include <algorithm>
+#include <chrono>
+#include <typeinfo>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#endif
+
 NS_CC_BEGIN
 
+// How many objects ahead clear() fetches, so the reference counts are in the cache when they are released
+static const size_t RELEASE_PREFETCH_DISTANCE = 8;
+// How many objects clear() releases between two looks at the clock when a release time budget is set
+static const size_t RELEASE_BUDGET_CHECK_INTERVAL = 32;
+
+static inline void prefetchObject(const Ref* object)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(object);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_prefetch((const char*)object, _MM_HINT_T0);
+#else
+    (void)object;
+#endif
+}
+
 AutoreleasePool::AutoreleasePool()
 : _name("")
+, _releaseTimeBudget(0)
+, _typeStatsEnabled(false)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
     _managedObjectArray.reserve(150);
+    _releasingObjectArray.reserve(150);
     PoolManager::getInstance()->push(this);
 }
 
 AutoreleasePool::AutoreleasePool(const std::string &name)
 : _name(name)
+, _releaseTimeBudget(0)
+, _typeStatsEnabled(false)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
     _managedObjectArray.reserve(150);
+    _releasingObjectArray.reserve(150);
     PoolManager::getInstance()->push(this);
 }
 
 AutoreleasePool::~AutoreleasePool()
 {
     CCLOGINFO("deallocing AutoreleasePool: %p", this);
+    // nothing may be left behind, whatever the budget
+    _releaseTimeBudget = 0;
     clear();
     
     PoolManager::getInstance()->pop();
@@ -59,6 +91,11 @@ AutoreleasePool::~AutoreleasePool()
 void AutoreleasePool::addObject(Ref* object)
 {
     _managedObjectArray.push_back(object);
+
+    if (_typeStatsEnabled)
+    {
+        ++_typeCounts[std::type_index(typeid(*object))];
+    }
 }
 
 void AutoreleasePool::clear()
@@ -66,17 +103,115 @@ void AutoreleasePool::clear()
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = true;
 #endif
-    std::vector<Ref*> releasings;
-    releasings.swap(_managedObjectArray);
-    for (const auto &obj : releasings)
+    if (!_releasingObjectArray.empty())
+    {
+        // called again by one of the releases below, the objects added since then are released on their own
+        std::vector<Ref*> releasings;
+        releasings.swap(_managedObjectArray);
+        for (const auto &obj : releasings)
+        {
+            obj->release();
+        }
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // The objects added by the releases below go to the other array and wait for the next clear(), as before.
+    // Both arrays keep their storage from frame to frame.
+    _releasingObjectArray.swap(_managedObjectArray);
+
+    size_t frameCount = _releasingObjectArray.size();
+    _stats.frameCount = frameCount;
+    _stats.maxFrameCount = std::max(_stats.maxFrameCount, frameCount);
+    _stats.totalCount += frameCount;
+
+    if (_typeStatsEnabled)
     {
+        _lastTypeCounts.swap(_typeCounts);
+        _typeCounts.clear();
+    }
+
+    // the objects deferred by the previous calls are released first
+    if (!_deferredObjectArray.empty())
+    {
+        _releasingObjectArray.insert(_releasingObjectArray.begin(), _deferredObjectArray.begin(), _deferredObjectArray.end());
+        _deferredObjectArray.clear();
+    }
+
+    auto budget = std::chrono::duration<float>(_releaseTimeBudget);
+    bool overBudget = false;
+    size_t count = _releasingObjectArray.size();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i + RELEASE_PREFETCH_DISTANCE < count)
+        {
+            prefetchObject(_releasingObjectArray[i + RELEASE_PREFETCH_DISTANCE]);
+        }
+
+        Ref* obj = _releasingObjectArray[i];
+
+        // past the budget only the releases that would destruct the object are deferred, the others are cheap
+        if (overBudget && obj->getReferenceCount() == 1)
+        {
+            _deferredObjectArray.push_back(obj);
+            continue;
+        }
+
         obj->release();
+
+        if (_releaseTimeBudget > 0 && !overBudget && (i + 1) % RELEASE_BUDGET_CHECK_INTERVAL == 0)
+        {
+            overBudget = (std::chrono::steady_clock::now() - start >= budget);
+        }
     }
+    _releasingObjectArray.clear();
+
+    _stats.deferredCount = _deferredObjectArray.size();
+    _stats.clearTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = false;
 #endif
 }
 
+void AutoreleasePool::resetStats()
+{
+    _stats = Stats();
+    _stats.deferredCount = _deferredObjectArray.size();
+}
+
+void AutoreleasePool::setTypeStatsEnabled(bool enabled)
+{
+    _typeStatsEnabled = enabled;
+
+    if (!enabled)
+    {
+        _typeCounts.clear();
+        _lastTypeCounts.clear();
+    }
+}
+
+std::vector<std::pair<std::string, size_t>> AutoreleasePool::getTopTypes(size_t count) const
+{
+    std::vector<std::pair<std::string, size_t>> types;
+    types.reserve(_lastTypeCounts.size());
+
+    for (const auto& entry : _lastTypeCounts)
+    {
+        types.push_back(std::make_pair(std::string(entry.first.name()), entry.second));
+    }
+
+    count = std::min(count, types.size());
+    std::partial_sort(types.begin(), types.begin() + count, types.end(),
+                      [](const std::pair<std::string, size_t>& a, const std::pair<std::string, size_t>& b) {
+                          return a.second > b.second;
+                      });
+    types.resize(count);
+
+    return types;
+}
+
 bool AutoreleasePool::contains(Ref* object) const
 {
     for (const auto& obj : _managedObjectArray)
@@ -84,12 +219,17 @@ bool AutoreleasePool::contains(Ref* object) const
         if (obj == object)
             return true;
     }
+    for (const auto& obj : _deferredObjectArray)
+    {
+        if (obj == object)
+            return true;
+    }
     return false;
 }
 
 void AutoreleasePool::dump()
 {
-    CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(_managedObjectArray.size()));
+    CCLOG("autorelease pool: %s, number of managed object %d, deferred %d\n", _name.c_str(), static_cast<int>(_managedObjectArray.size()), static_cast<int>(_deferredObjectArray.size()));
     CCLOG("%20s%20s%20s", "Object pointer", "Object id", "reference count");
     for (const auto &obj : _managedObjectArray)
     {
@@ -124,6 +264,8 @@ void PoolManager::destroyInstance()
 }
 
 PoolManager::PoolManager()
+: _threadId(std::this_thread::get_id())
+, _hasCocosThreadObjects(false)
 {
     _releasePoolStack.reserve(10);
 }
@@ -131,6 +273,9 @@ PoolManager::PoolManager()
 PoolManager::~PoolManager()
 {
     CCLOGINFO("deallocing PoolManager: %p", this);
+
+    // the pools release the objects still queued by other threads when they are deleted
+    drainCocosThreadObjects();
     
     while (!_releasePoolStack.empty())
     {
@@ -156,6 +301,37 @@ bool PoolManager::isObjectInPools(Ref* obj) const
     return false;
 }
 
+void PoolManager::addCocosThreadObject(Ref* obj)
+{
+    std::lock_guard<std::mutex> lock(_cocosThreadMutex);
+    _cocosThreadObjects.push_back(obj);
+    _hasCocosThreadObjects.store(true, std::memory_order_release);
+}
+
+void PoolManager::drainCocosThreadObjects()
+{
+    CCASSERT(isCocosThread(), "PoolManager::drainCocosThreadObjects() must be called on the cocos2d thread");
+
+    // most frames have nothing to drain, they do not take the lock
+    if (!_hasCocosThreadObjects.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_cocosThreadMutex);
+        _drainingObjects.swap(_cocosThreadObjects);
+        _hasCocosThreadObjects.store(false, std::memory_order_relaxed);
+    }
+
+    AutoreleasePool* pool = getCurrentPool();
+    for (const auto& obj : _drainingObjects)
+    {
+        pool->addObject(obj);
+    }
+    _drainingObjects.clear();
+}
+
 void PoolManager::push(AutoreleasePool *pool)
 {
     _releasePoolStack.push_back(pool);
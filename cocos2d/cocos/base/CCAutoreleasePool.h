@@ -26,8 +26,14 @@ THE SOFTWARE.
 #ifndef __AUTORELEASEPOOL_H__
 #define __AUTORELEASEPOOL_H__
 
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
 #include "base/CCRef.h"
 
 /**
@@ -44,6 +50,16 @@ NS_CC_BEGIN
 class CC_DLL AutoreleasePool
 {
 public:
+    /** Statistics of the objects going through the pool, collected by clear(). */
+    struct Stats
+    {
+        size_t frameCount = 0;      ///< objects added between the last two clear() calls
+        size_t maxFrameCount = 0;   ///< the largest frameCount since the last resetStats()
+        size_t totalCount = 0;      ///< objects added since the last resetStats()
+        size_t deferredCount = 0;   ///< objects whose release is deferred by the release time budget
+        double clearTime = 0;       ///< seconds spent in the last clear()
+    };
+
     /**
      * @warning Don't create an autorelease pool in heap, create it in stack.
      * @js NA
@@ -84,11 +100,73 @@ public:
      * Clear the autorelease pool.
      *
      * It will invoke each element's `release()` function.
+     * The storage of the pool is kept and reused, so clearing it every frame does not allocate.
      *
      * @js NA
      * @lua NA
      */
     void clear();
+
+    /**
+     * Sets the time clear() may spend releasing objects.
+     *
+     * When it is exceeded, the objects that would be destructed by their release are kept
+     * and released by the next clear() calls, the others are still released right away.
+     * This spreads the destruction of large batches of temporary objects over several frames.
+     *
+     * @param seconds The time budget in seconds, 0 means no limit. Default is 0.
+     * @js NA
+     * @lua NA
+     */
+    void setReleaseTimeBudget(float seconds) { _releaseTimeBudget = seconds; }
+
+    /**
+     * Gets the time clear() may spend releasing objects, 0 means no limit.
+     * @js NA
+     * @lua NA
+     */
+    float getReleaseTimeBudget() const { return _releaseTimeBudget; }
+
+    /**
+     * Gets the per frame object counts and the time of the last clear().
+     * @js NA
+     * @lua NA
+     */
+    const Stats& getStats() const { return _stats; }
+
+    /**
+     * Resets the counts returned by getStats().
+     * @js NA
+     * @lua NA
+     */
+    void resetStats();
+
+    /**
+     * Counts the added objects by their dynamic type. Off by default because it looks up a map for every object.
+     *
+     * @param enabled True to count the types.
+     * @js NA
+     * @lua NA
+     */
+    void setTypeStatsEnabled(bool enabled);
+
+    /**
+     * Whether the added objects are counted by their dynamic type.
+     * @js NA
+     * @lua NA
+     */
+    bool isTypeStatsEnabled() const { return _typeStatsEnabled; }
+
+    /**
+     * Gets the types that added the most objects between the last two clear() calls, most first.
+     * The names are the ones of `typeid`, like in the CC_REF_LEAK_DETECTION report.
+     *
+     * @param count The number of types to return at most.
+     * @return Pairs of type name and object count.
+     * @js NA
+     * @lua NA
+     */
+    std::vector<std::pair<std::string, size_t>> getTopTypes(size_t count) const;
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     /**
@@ -134,7 +212,17 @@ private:
      * is in the pool.
      */
     std::vector<Ref*> _managedObjectArray;
+    // the objects being released by clear(), swapped with _managedObjectArray so both keep their capacity
+    std::vector<Ref*> _releasingObjectArray;
+    // the objects left to the next clear() by the release time budget
+    std::vector<Ref*> _deferredObjectArray;
     std::string _name;
+
+    float _releaseTimeBudget;
+    Stats _stats;
+    bool _typeStatsEnabled;
+    std::unordered_map<std::type_index, size_t> _typeCounts;
+    std::unordered_map<std::type_index, size_t> _lastTypeCounts;
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     /**
@@ -165,6 +253,21 @@ public:
 
     bool isObjectInPools(Ref* obj) const;
 
+    /**
+     * Queues an object to be added to the current pool on the cocos2d thread, see Ref::autoreleaseInCocosThread().
+     * This function is thread safe.
+     */
+    void addCocosThreadObject(Ref* obj);
+
+    /**
+     * Adds the objects queued by addCocosThreadObject() to the current pool.
+     * Called by the Director on the cocos2d thread before it clears the pool every frame.
+     */
+    void drainCocosThreadObjects();
+
+    /** Whether the caller runs on the thread the pools belong to, the one that created the PoolManager. */
+    bool isCocosThread() const { return std::this_thread::get_id() == _threadId; }
+
 
     friend class AutoreleasePool;
     
@@ -178,6 +281,13 @@ private:
     static PoolManager* s_singleInstance;
     
     std::vector<AutoreleasePool*> _releasePoolStack;
+    std::thread::id _threadId;
+
+    // objects handed over by the other threads, swapped with _drainingObjects so both keep their capacity
+    std::mutex _cocosThreadMutex;
+    std::vector<Ref*> _cocosThreadObjects;
+    std::vector<Ref*> _drainingObjects;
+    std::atomic<bool> _hasCocosThreadObjects;
 };
 /**
  * @endcond
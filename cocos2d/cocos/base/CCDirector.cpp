@@ -57,6 +57,7 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 #include "renderer/backend/ProgramCache.h"
@@ -288,8 +289,10 @@ void Director::drawScene()
         _renderer->clearDrawStats();
         
         //render the scene
+        _renderer->beginVisitTiming();
         if(_openGLView)
             _openGLView->renderScene(_runningScene, _renderer);
+        _renderer->endVisitTiming();
         
         _eventDispatcher->dispatchEvent(_eventAfterVisit);
     }
@@ -1020,6 +1023,7 @@ void Director::reset()
     SpriteFrameCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destroyInstance();
+    JobSystem::destroyInstance();
     backend::ProgramCache::destroyInstance();
     
     
@@ -1057,7 +1061,8 @@ void Director::restartDirector()
     // Reschedule for action manager
     getScheduler()->scheduleUpdate(getActionManager(), Scheduler::PRIORITY_SYSTEM, false);
     
-    // release the objects
+    // release the objects, with the ones handed over by other threads
+    PoolManager::getInstance()->drainCocosThreadObjects();
     PoolManager::getInstance()->getCurrentPool()->clear();
 
     // Restart animation
@@ -1391,7 +1396,8 @@ void Director::mainLoop()
     {
         drawScene();
      
-        // release the objects
+        // release the objects, with the ones handed over by other threads
+        PoolManager::getInstance()->drainCocosThreadObjects();
         PoolManager::getInstance()->getCurrentPool()->clear();
     }
 }
@@ -0,0 +1,231 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCFunctionQueue.h"
+
+#include <algorithm>
+#include <chrono>
+
+NS_CC_BEGIN
+
+FunctionQueue::FunctionQueue(std::size_t capacity)
+: _cells(nullptr)
+, _mask(0)
+, _enqueuePos(0)
+, _dequeuePos(0)
+, _discardPos(0)
+, _overflowSize(0)
+, _overflowed(0)
+{
+    std::size_t size = 2;
+    while (size < capacity)
+        size *= 2;
+
+    _cells = new Cell[size];
+    _mask = size - 1;
+    for (std::size_t i = 0; i < size; ++i)
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+FunctionQueue::~FunctionQueue()
+{
+    delete[] _cells;
+}
+
+bool FunctionQueue::tryPushToRing(Function& function)
+{
+    // bounded multi-producer queue: a producer claims a position by advancing _enqueuePos,
+    // then publishes the function through the sequence of the cell
+    std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;)
+    {
+        cell = &_cells[pos & _mask];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = (std::ptrdiff_t)(sequence - pos);
+        if (diff == 0)
+        {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // the cell still holds the function pushed one lap ago, the ring is full
+            return false;
+        }
+        else
+        {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->function = std::move(function);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void FunctionQueue::push(Function&& function)
+{
+    if (_overflowSize.load(std::memory_order_acquire) == 0 && tryPushToRing(function))
+        return;
+
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflow.push_back(std::move(function));
+    _overflowSize.fetch_add(1, std::memory_order_release);
+    _overflowed.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FunctionQueue::popFromRing(std::size_t end, Function& function)
+{
+    std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    while (pos != end)
+    {
+        Cell& cell = _cells[pos & _mask];
+
+        // claimed by a producer that hasn't finished writing it yet, it and the functions after it are performed next time
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+            return false;
+
+        bool discarded = (std::ptrdiff_t)(pos - _discardPos.load(std::memory_order_acquire)) < 0;
+        if (discarded)
+            cell.function.reset();
+        else
+            function = std::move(cell.function);
+
+        // free the cell for the producers of the next lap
+        cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+        _dequeuePos.store(++pos, std::memory_order_relaxed);
+
+        if (!discarded)
+            return true;
+    }
+    return false;
+}
+
+bool FunctionQueue::popFromOverflow(Function& function)
+{
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    if (_overflow.empty())
+        return false;
+
+    function = std::move(_overflow.front());
+    _overflow.pop_front();
+    _overflowSize.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+std::size_t FunctionQueue::perform(float timeBudget)
+{
+    // only the functions queued so far, a function that queues another one must not keep this loop going;
+    // the overflow list is read first so that the ring functions pushed before a counted overflow one are inside end
+    std::size_t overflowCount = _overflowSize.load(std::memory_order_acquire);
+    std::size_t end = _enqueuePos.load(std::memory_order_acquire);
+    std::size_t depth = ringSize(end) + overflowCount;
+    if (depth == 0)
+    {
+        _stats.performed = _stats.deferred = 0;
+        _stats.drainTime = 0;
+        return 0;
+    }
+    _stats.maxDepth = std::max(_stats.maxDepth, depth);
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(timeBudget));
+
+    std::size_t performed = 0;
+    Function function;
+    for (;;)
+    {
+        // the ring holds the older functions, the overflow list is only used while the ring is full;
+        // a cell a producer is still writing holds back the rest of the ring and the overflow list until the next perform()
+        if (!popFromRing(end, function))
+        {
+            if (_dequeuePos.load(std::memory_order_relaxed) != end || overflowCount == 0 || !popFromOverflow(function))
+                break;
+            --overflowCount;
+        }
+
+        function();
+        function.reset();
+        ++performed;
+
+        if (timeBudget > 0 && std::chrono::steady_clock::now() >= deadline)
+            break;
+    }
+
+    _stats.performed = performed;
+    _stats.deferred = depth - performed;
+    _stats.drainTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _stats.maxDrainTime = std::max(_stats.maxDrainTime, _stats.drainTime);
+    return performed;
+}
+
+void FunctionQueue::clear()
+{
+    // the consumer owns the ring cells, so it destroys the cleared functions when it reaches them
+    std::size_t pos = _enqueuePos.load(std::memory_order_acquire);
+    std::size_t discardPos = _discardPos.load(std::memory_order_relaxed);
+    while ((std::ptrdiff_t)(pos - discardPos) > 0)
+    {
+        if (_discardPos.compare_exchange_weak(discardPos, pos, std::memory_order_release))
+            break;
+    }
+
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflowSize.fetch_sub(_overflow.size(), std::memory_order_release);
+    _overflow.clear();
+}
+
+std::size_t FunctionQueue::ringSize(std::size_t end) const
+{
+    // the cleared positions are only skipped by the consumer, they don't count
+    std::size_t dequeued = _dequeuePos.load(std::memory_order_acquire);
+    std::size_t discardPos = _discardPos.load(std::memory_order_acquire);
+    if ((std::ptrdiff_t)(discardPos - dequeued) > 0)
+        dequeued = discardPos;
+    return (std::ptrdiff_t)(end - dequeued) > 0 ? end - dequeued : 0;
+}
+
+std::size_t FunctionQueue::size() const
+{
+    return ringSize(_enqueuePos.load(std::memory_order_acquire)) + _overflowSize.load(std::memory_order_acquire);
+}
+
+FunctionQueue::Stats FunctionQueue::getStats() const
+{
+    Stats stats = _stats;
+    stats.depth = size();
+    stats.overflowed = _overflowed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FunctionQueue::resetStats()
+{
+    _stats.maxDepth = 0;
+    _stats.maxDrainTime = 0;
+    _overflowed.store(0, std::memory_order_relaxed);
+}
+
+NS_CC_END
@@ -0,0 +1,282 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCFUNCTION_QUEUE_H_
+#define __CCFUNCTION_QUEUE_H_
+
+#include "platform/CCPlatformMacros.h"
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class SmallFunction
+ * @brief A move-only `void()` callable. Callables of up to INLINE_SIZE bytes, such as lambdas capturing a few
+ * pointers or a `std::function`, are stored inline without any heap allocation; bigger ones are moved to the heap.
+ * @js NA
+ */
+class CC_DLL SmallFunction
+{
+public:
+    /** The size of the inline storage, in bytes. */
+    static const std::size_t INLINE_SIZE = 48;
+
+    SmallFunction() : _ops(nullptr) {}
+
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, SmallFunction>::value>::type>
+    SmallFunction(F&& function)
+    : _ops(nullptr)
+    {
+        typedef typename std::decay<F>::type Callable;
+        typedef typename std::conditional<fitsInline<Callable>(), InlineOps<Callable>, HeapOps<Callable>>::type Ops;
+        Ops::construct(_storage, std::forward<F>(function));
+        _ops = &Ops::s_ops;
+    }
+
+    SmallFunction(SmallFunction&& other)
+    : _ops(other._ops)
+    {
+        if (_ops)
+        {
+            _ops->move(_storage, other._storage);
+            other._ops = nullptr;
+        }
+    }
+
+    SmallFunction& operator=(SmallFunction&& other)
+    {
+        if (this != &other)
+        {
+            reset();
+            _ops = other._ops;
+            if (_ops)
+            {
+                _ops->move(_storage, other._storage);
+                other._ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~SmallFunction() { reset(); }
+
+    /** Calls the function, which must not be empty. */
+    void operator()() { _ops->invoke(_storage); }
+
+    /** Whether a function is stored. */
+    explicit operator bool() const { return _ops != nullptr; }
+
+    /** Whether the function is stored inline. */
+    bool isInline() const { return _ops != nullptr && _ops->isInline; }
+
+    /** Destroys the stored function. */
+    void reset()
+    {
+        if (_ops)
+        {
+            _ops->destroy(_storage);
+            _ops = nullptr;
+        }
+    }
+
+private:
+    SmallFunction(const SmallFunction&) = delete;
+    SmallFunction& operator=(const SmallFunction&) = delete;
+
+    struct Ops
+    {
+        void (*invoke)(void* storage);
+        // move constructs into dst and destroys src
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void* storage);
+        bool isInline;
+    };
+
+    template <typename Callable>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(Callable) <= INLINE_SIZE
+            && alignof(Callable) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<Callable>::value;
+    }
+
+    template <typename Callable>
+    struct InlineOps
+    {
+        template <typename F>
+        static void construct(void* storage, F&& function) { new (storage) Callable(std::forward<F>(function)); }
+        static void invoke(void* storage) { (*static_cast<Callable*>(storage))(); }
+        static void move(void* dst, void* src)
+        {
+            new (dst) Callable(std::move(*static_cast<Callable*>(src)));
+            static_cast<Callable*>(src)->~Callable();
+        }
+        static void destroy(void* storage) { static_cast<Callable*>(storage)->~Callable(); }
+        static const Ops s_ops;
+    };
+
+    template <typename Callable>
+    struct HeapOps
+    {
+        template <typename F>
+        static void construct(void* storage, F&& function) { *static_cast<Callable**>(storage) = new Callable(std::forward<F>(function)); }
+        static void invoke(void* storage) { (**static_cast<Callable**>(storage))(); }
+        static void move(void* dst, void* src) { *static_cast<Callable**>(dst) = *static_cast<Callable**>(src); }
+        static void destroy(void* storage) { delete *static_cast<Callable**>(storage); }
+        static const Ops s_ops;
+    };
+
+    alignas(std::max_align_t) unsigned char _storage[INLINE_SIZE];
+    const Ops* _ops;
+};
+
+template <typename Callable>
+const SmallFunction::Ops SmallFunction::InlineOps<Callable>::s_ops = { &invoke, &move, &destroy, true };
+
+template <typename Callable>
+const SmallFunction::Ops SmallFunction::HeapOps<Callable>::s_ops = { &invoke, &move, &destroy, false };
+
+/**
+ * @class FunctionQueue
+ * @brief A queue of functions pushed by any number of threads and performed by a single thread.
+ * Pushing is lock-free while the bounded ring has room; when it is full the functions go to an overflow
+ * list guarded by a mutex, so nothing is ever dropped or blocks on the performing thread.
+ * The functions pushed by one thread are performed in the order they were pushed.
+ * @js NA
+ */
+class CC_DLL FunctionQueue
+{
+public:
+    typedef SmallFunction Function;
+
+    /** The default number of functions the ring can hold. */
+    static const std::size_t DEFAULT_CAPACITY = 1024;
+
+    /** Statistics about the queue, see `getStats()`. Times are in milliseconds. */
+    struct Stats
+    {
+        /** The number of functions waiting to be performed when `getStats()` is called. */
+        std::size_t depth = 0;
+        /** The largest depth seen at the start of `perform()` since the last `resetStats()`. */
+        std::size_t maxDepth = 0;
+        /** The number of functions performed by the last `perform()`. */
+        std::size_t performed = 0;
+        /** The number of functions queued before the last `perform()` started that it left for the next one. */
+        std::size_t deferred = 0;
+        /** The number of functions that didn't fit in the ring since the last `resetStats()`. */
+        std::size_t overflowed = 0;
+        /** The time spent in the last `perform()`. */
+        double drainTime = 0;
+        /** The longest time spent in `perform()` since the last `resetStats()`. */
+        double maxDrainTime = 0;
+    };
+
+    /**
+     * @param capacity The number of functions the ring can hold, rounded up to a power of two.
+     */
+    explicit FunctionQueue(std::size_t capacity = DEFAULT_CAPACITY);
+    ~FunctionQueue();
+
+    /**
+     * Adds a function to the queue. Thread safe.
+     */
+    void push(Function&& function);
+
+    /**
+     * Performs the queued functions, on the consumer thread only. The functions pushed while performing,
+     * including by the performed functions, are left for the next call.
+     *
+     * @param timeBudget The time in seconds after which the remaining functions are left for the next call,
+     *                   at least one function is performed. 0 means no limit.
+     * @return The number of performed functions.
+     */
+    std::size_t perform(float timeBudget = 0);
+
+    /**
+     * Removes the queued functions without performing them. Thread safe.
+     */
+    void clear();
+
+    /** Returns the number of queued functions. It may be outdated as soon as it is returned when other threads push. */
+    std::size_t size() const;
+    /** Returns whether no function is queued. */
+    bool empty() const { return size() == 0; }
+
+    /** Returns the number of functions the ring can hold. */
+    std::size_t getCapacity() const { return _mask + 1; }
+
+    /** Returns the statistics of the queue, on the consumer thread only. */
+    Stats getStats() const;
+    /** Resets the maximum values and the overflow count of the statistics. */
+    void resetStats();
+
+protected:
+    FunctionQueue(const FunctionQueue&) = delete;
+    FunctionQueue& operator=(const FunctionQueue&) = delete;
+
+    // a slot of the ring, its sequence tells whether it is free for position p (sequence == p)
+    // or holds the function pushed at position p (sequence == p + 1)
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        Function function;
+    };
+
+    bool tryPushToRing(Function& function);
+    bool popFromRing(std::size_t end, Function& function);
+    // number of functions in the ring before end that were neither performed nor cleared
+    std::size_t ringSize(std::size_t end) const;
+    bool popFromOverflow(Function& function);
+
+    Cell* _cells;
+    std::size_t _mask;
+    std::atomic<std::size_t> _enqueuePos;
+    std::atomic<std::size_t> _dequeuePos;
+    // ring positions before this one were cleared, the consumer destroys their functions without performing them
+    std::atomic<std::size_t> _discardPos;
+
+    std::mutex _overflowMutex;
+    std::deque<Function> _overflow;
+    // while the overflow list isn't empty every function goes there, so that the order of each thread is kept
+    std::atomic<std::size_t> _overflowSize;
+    std::atomic<std::size_t> _overflowed;
+
+    Stats _stats;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CCFUNCTION_QUEUE_H_
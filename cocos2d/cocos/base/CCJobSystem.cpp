@@ -0,0 +1,156 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+JobSystem* JobSystem::s_jobSystem = nullptr;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (s_jobSystem == nullptr)
+    {
+        s_jobSystem = new (std::nothrow) JobSystem();
+    }
+    return s_jobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    delete s_jobSystem;
+    s_jobSystem = nullptr;
+}
+
+JobSystem::JobSystem()
+: _job(nullptr)
+, _jobCount(0)
+, _finishedJobs(0)
+, _generation(0)
+, _activeWorkers(0)
+, _stop(false)
+, _nextJob(0)
+{
+    // the calling thread works too, so leave one core for it
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    unsigned int workerCount = std::min(hardwareThreads > 1 ? hardwareThreads - 1 : 0, MAX_WORKER_COUNT);
+
+    _workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+        _workers.emplace_back(&JobSystem::workerLoop, this);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _jobCondition.notify_all();
+
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+void JobSystem::parallelFor(std::size_t count, const Job& job)
+{
+    if (count == 0)
+        return;
+
+    if (_workers.empty() || count == 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            job(i);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        // a worker that woke up late for the previous batch may still be looking at the counter
+        _doneCondition.wait(lock, [this]{ return _activeWorkers == 0; });
+
+        _job = &job;
+        _jobCount = count;
+        _finishedJobs = 0;
+        _nextJob = 0;
+        ++_generation;
+    }
+    _jobCondition.notify_all();
+
+    std::size_t finished = runJobs(&job, count);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finishedJobs += finished;
+    _doneCondition.wait(lock, [this]{ return _finishedJobs == _jobCount && _activeWorkers == 0; });
+
+    // workers waking up after this point find an empty batch
+    _job = nullptr;
+    _jobCount = 0;
+}
+
+void JobSystem::workerLoop()
+{
+    unsigned int seenGeneration = 0;
+    for (;;)
+    {
+        const Job* job = nullptr;
+        std::size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobCondition.wait(lock, [&]{ return _stop || _generation != seenGeneration; });
+            if (_stop)
+                return;
+
+            seenGeneration = _generation;
+            job = _job;
+            count = _jobCount;
+            ++_activeWorkers;
+        }
+
+        std::size_t finished = runJobs(job, count);
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _finishedJobs += finished;
+            --_activeWorkers;
+        }
+        _doneCondition.notify_all();
+    }
+}
+
+std::size_t JobSystem::runJobs(const Job* job, std::size_t count)
+{
+    std::size_t finished = 0;
+    for (std::size_t index = _nextJob++; index < count; index = _nextJob++)
+    {
+        (*job)(index);
+        ++finished;
+    }
+    return finished;
+}
+
+NS_CC_END
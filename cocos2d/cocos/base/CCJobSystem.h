@@ -0,0 +1,109 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCJOB_SYSTEM_H_
+#define __CCJOB_SYSTEM_H_
+
+#include "platform/CCPlatformMacros.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class JobSystem
+ * @brief A small pool of worker threads that runs a batch of jobs and waits for all of them.
+ * Unlike AsyncTaskPool, the calling thread takes part in the batch and is blocked until it is finished,
+ * so the jobs may safely reference data on the caller's stack.
+ * @js NA
+ */
+class CC_DLL JobSystem
+{
+public:
+    typedef std::function<void(std::size_t)> Job;
+
+    /** The maximum number of worker threads. */
+    static const unsigned int MAX_WORKER_COUNT = 7;
+
+    /**
+     * Returns the shared instance of the job system.
+     */
+    static JobSystem* getInstance();
+
+    /**
+     * Destroys the job system, joining its worker threads.
+     */
+    static void destroyInstance();
+
+    /**
+     * Runs job(0) ... job(count - 1) on the worker threads and the calling thread, in no particular order.
+     * Returns when all of them are finished. Jobs must not call parallelFor() themselves.
+     *
+     * @param count The number of jobs.
+     * @param job The job, called with the index of the job.
+     * @lua NA
+     */
+    void parallelFor(std::size_t count, const Job& job);
+
+    /** Returns the number of worker threads, not counting the calling thread. */
+    unsigned int getWorkerCount() const { return (unsigned int)_workers.size(); }
+
+CC_CONSTRUCTOR_ACCESS:
+    JobSystem();
+    ~JobSystem();
+
+protected:
+    void workerLoop();
+    std::size_t runJobs(const Job* job, std::size_t count);
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _jobCondition;
+    std::condition_variable _doneCondition;
+
+    // the current batch, guarded by _mutex, jobs are claimed with _nextJob
+    const Job* _job;
+    std::size_t _jobCount;
+    std::size_t _finishedJobs;
+    unsigned int _generation;
+    unsigned int _activeWorkers;
+    bool _stop;
+    std::atomic<std::size_t> _nextJob;
+
+    static JobSystem* s_jobSystem;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CCJOB_SYSTEM_H_
@@ -88,22 +88,63 @@ Ref::~Ref()
 #endif
 }
 
+#if CC_ENABLE_ATOMIC_REF_COUNT
+Ref::Ref(const Ref& other)
+: _referenceCount(other._referenceCount.load(std::memory_order_relaxed))
+#if CC_ENABLE_SCRIPT_BINDING
+, _ID(other._ID)
+, _luaID(other._luaID)
+, _scriptObject(other._scriptObject)
+, _rooted(other._rooted)
+#endif
+{
+}
+
+Ref& Ref::operator=(const Ref& other)
+{
+    _referenceCount.store(other._referenceCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#if CC_ENABLE_SCRIPT_BINDING
+    _ID = other._ID;
+    _luaID = other._luaID;
+    _scriptObject = other._scriptObject;
+    _rooted = other._rooted;
+#endif
+    return *this;
+}
+#endif
+
 void Ref::retain()
 {
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    // a new reference is always taken from an existing one, nothing has to be ordered
+    unsigned int previous = _referenceCount.fetch_add(1, std::memory_order_relaxed);
+    CCASSERT(previous > 0, "reference count should be greater than 0");
+    (void)previous;
+#else
     CCASSERT(_referenceCount > 0, "reference count should be greater than 0");
     ++_referenceCount;
+#endif
 }
 
 void Ref::release()
 {
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    // the writes of the other owners must be visible to the one that deletes the object
+    unsigned int previous = _referenceCount.fetch_sub(1, std::memory_order_acq_rel);
+    CCASSERT(previous > 0, "reference count should be greater than 0");
+
+    if (previous == 1)
+#else
     CCASSERT(_referenceCount > 0, "reference count should be greater than 0");
     --_referenceCount;
 
     if (_referenceCount == 0)
+#endif
     {
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
         auto poolManager = PoolManager::getInstance();
-        if (!poolManager->getCurrentPool()->isClearing() && poolManager->isObjectInPools(this))
+        // the pools belong to the cocos2d thread, the objects released by other threads are not checked
+        if (poolManager->isCocosThread() && !poolManager->getCurrentPool()->isClearing() && poolManager->isObjectInPools(this))
         {
             // Trigger an assert if the reference count is 0 but the Ref is still in autorelease pool.
             // This happens when 'autorelease/release' were not used in pairs with 'new/retain'.
@@ -153,10 +194,19 @@ void Ref::release()
 
 Ref* Ref::autorelease()
 {
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    CCASSERT(PoolManager::getInstance()->isCocosThread(), "autorelease() must be called on the cocos2d thread, use autoreleaseInCocosThread()");
+#endif
     PoolManager::getInstance()->getCurrentPool()->addObject(this);
     return this;
 }
 
+Ref* Ref::autoreleaseInCocosThread()
+{
+    PoolManager::getInstance()->addCocosThreadObject(this);
+    return this;
+}
+
 unsigned int Ref::getReferenceCount() const
 {
     return _referenceCount;
@@ -30,6 +30,10 @@ THE SOFTWARE.
 #include "platform/CCPlatformMacros.h"
 #include "base/ccConfig.h"
 
+#if CC_ENABLE_ATOMIC_REF_COUNT
+#include <atomic>
+#endif
+
 #define CC_REF_LEAK_DETECTION 0
 
 /**
@@ -107,6 +111,22 @@ public:
      */
     Ref* autorelease();
 
+    /**
+     * Releases the ownership sometime soon automatically, like autorelease(), from any thread.
+     *
+     * The Ref is handed to the autorelease pool of the cocos2d thread at the end of the next frame,
+     * so this release, and the destruction if it is the last one, happen on the cocos2d thread.
+     * Together with CC_ENABLE_ATOMIC_REF_COUNT, it lets worker threads create and share objects
+     * that hold cocos2d thread resources.
+     *
+     * @returns The Ref itself.
+     *
+     * @see autorelease, PoolManager::drainCocosThreadObjects
+     * @js NA
+     * @lua NA
+     */
+    Ref* autoreleaseInCocosThread();
+
     /**
      * Returns the Ref's current reference count.
      *
@@ -124,6 +144,12 @@ protected:
      */
     Ref();
 
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    /** std::atomic can't be copied, these do what the implicit ones do without CC_ENABLE_ATOMIC_REF_COUNT. */
+    Ref(const Ref& other);
+    Ref& operator=(const Ref& other);
+#endif
+
 public:
     /**
      * Destructor
@@ -135,7 +161,11 @@ public:
 
 protected:
     /// count of references
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    std::atomic<unsigned int> _referenceCount;
+#else
     unsigned int _referenceCount;
+#endif
 
     friend class AutoreleasePool;
 
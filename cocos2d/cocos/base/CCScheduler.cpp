@@ -33,6 +33,8 @@ THE SOFTWARE.
 #include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
 
+#include <algorithm>
+
 NS_CC_BEGIN
 
 // data structures
@@ -65,9 +67,14 @@ typedef struct _hashSelectorEntry
     int                 timerIndex;
     Timer               *currentTimer;
     bool                paused;
+    uint64_t            order;         // creation order, due timers fire target by target in this order
     UT_hash_handle      hh;
 } tHashTimerEntry;
 
+// A timer whose fire time is within this many seconds is taken out of the queue and updated,
+// Timer::update() then decides with its own float arithmetic whether it actually fires
+static const double TIMER_DEADLINE_SLACK = 1e-4;
+
 // implementation Timer
 
 Timer::Timer()
@@ -80,6 +87,12 @@ Timer::Timer()
 , _delay(0.0f)
 , _interval(0.0f)
 , _aborted(false)
+, _entry(nullptr)
+, _lastUpdateTime(0)
+, _nextFireTime(0)
+, _order(0)
+, _queueIndex(-1)
+, _queueState(QueueState::NONE)
 {
 }
 
@@ -151,6 +164,13 @@ bool Timer::isExhausted() const
     return !_runForever && _timesExecuted > _repeat;
 }
 
+double Timer::getNextFireTime() const
+{
+    // the same threshold update() compares _elapsed with, an interval of 0 fires every frame
+    float threshold = _useDelay ? _delay : std::max(_interval, 0.0f);
+    return _lastUpdateTime + std::max(threshold - _elapsed, 0.0f);
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -260,17 +280,23 @@ Scheduler::Scheduler()
 , _currentTarget(nullptr)
 , _currentTargetSalvaged(false)
 , _updateHashLocked(false)
+, _timerTime(0)
+, _timerOrder(0)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _performFunctionsTimeBudget(0)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
 }
 
 Scheduler::~Scheduler()
 {
     unscheduleAll();
+
+    for (auto timer : _pendingTimers)
+    {
+        timer->release();
+    }
 }
 
 void Scheduler::removeHashElement(_hashSelectorEntry *element)
@@ -280,6 +306,231 @@ void Scheduler::removeHashElement(_hashSelectorEntry *element)
     free(element);
 }
 
+void Scheduler::addTimer(tHashTimerEntry *element, Timer *timer)
+{
+    timer->_entry = element;
+    timer->_order = ++_timerOrder;
+    ccArrayAppendObject(element->timers, timer);
+    addPendingTimer(timer);
+}
+
+void Scheduler::addPendingTimer(Timer *timer)
+{
+    // like the first Timer::update() call, the first update only starts the counting
+    timer->retain();
+    timer->_queueState = Timer::QueueState::PENDING;
+    _pendingTimers.push_back(timer);
+}
+
+void Scheduler::queueTimer(Timer *timer)
+{
+    timer->_nextFireTime = timer->getNextFireTime();
+    timer->_queueState = Timer::QueueState::QUEUED;
+    timer->_queueIndex = (int)_timerQueue.size();
+    _timerQueue.push_back(timer);
+    siftTimerUp(_timerQueue.size() - 1);
+}
+
+void Scheduler::dequeueTimer(Timer *timer)
+{
+    if (timer->_queueState == Timer::QueueState::QUEUED)
+    {
+        size_t index = timer->_queueIndex;
+        Timer *last = _timerQueue.back();
+        _timerQueue.pop_back();
+
+        if (last != timer)
+        {
+            _timerQueue[index] = last;
+            last->_queueIndex = (int)index;
+            siftTimerUp(index);
+            siftTimerDown(last->_queueIndex);
+        }
+        timer->_queueIndex = -1;
+    }
+
+    // pending and due timers stay in their lists, which hold a reference, and are skipped there
+    timer->_queueState = Timer::QueueState::NONE;
+}
+
+void Scheduler::pauseTimers(tHashTimerEntry *element)
+{
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = (Timer*)element->timers->arr[i];
+
+        if (timer->_queueState == Timer::QueueState::QUEUED || timer->_queueState == Timer::QueueState::DUE)
+        {
+            dequeueTimer(timer);
+            // keep the time counted so far, the time spent paused is not counted
+            timer->_elapsed += (float)(_timerTime - timer->_lastUpdateTime);
+            timer->_queueState = Timer::QueueState::PAUSED;
+        }
+    }
+}
+
+void Scheduler::resumeTimers(tHashTimerEntry *element)
+{
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = (Timer*)element->timers->arr[i];
+
+        if (timer->_queueState == Timer::QueueState::PAUSED)
+        {
+            if (timer->_elapsed == -1)
+            {
+                // paused before it started counting
+                addPendingTimer(timer);
+            }
+            else
+            {
+                timer->_lastUpdateTime = _timerTime;
+                queueTimer(timer);
+            }
+        }
+    }
+}
+
+void Scheduler::siftTimerUp(size_t index)
+{
+    Timer *timer = _timerQueue[index];
+
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+
+        if (_timerQueue[parent]->_nextFireTime <= timer->_nextFireTime)
+        {
+            break;
+        }
+        _timerQueue[index] = _timerQueue[parent];
+        _timerQueue[index]->_queueIndex = (int)index;
+        index = parent;
+    }
+
+    _timerQueue[index] = timer;
+    timer->_queueIndex = (int)index;
+}
+
+void Scheduler::siftTimerDown(size_t index)
+{
+    Timer *timer = _timerQueue[index];
+    size_t size = _timerQueue.size();
+
+    while (true)
+    {
+        size_t child = index * 2 + 1;
+
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && _timerQueue[child + 1]->_nextFireTime < _timerQueue[child]->_nextFireTime)
+        {
+            ++child;
+        }
+        if (timer->_nextFireTime <= _timerQueue[child]->_nextFireTime)
+        {
+            break;
+        }
+        _timerQueue[index] = _timerQueue[child];
+        _timerQueue[index]->_queueIndex = (int)index;
+        index = child;
+    }
+
+    _timerQueue[index] = timer;
+    timer->_queueIndex = (int)index;
+}
+
+void Scheduler::updateTimers(float dt)
+{
+    _timerTime += dt;
+
+    // Take out every timer that is due. Only these are visited, the cost does not grow with the timers waiting.
+    while (!_timerQueue.empty() && _timerQueue.front()->_nextFireTime <= _timerTime + TIMER_DEADLINE_SLACK)
+    {
+        Timer *timer = _timerQueue.front();
+        dequeueTimer(timer);
+        timer->retain();
+        timer->_queueState = Timer::QueueState::DUE;
+        _dueTimers.push_back(timer);
+    }
+
+    // Fire them in the order a walk over all the targets would: target by target, then in scheduling order
+    std::sort(_dueTimers.begin(), _dueTimers.end(), [](const Timer *a, const Timer *b) {
+        if (a->_entry->order != b->_entry->order)
+        {
+            return a->_entry->order < b->_entry->order;
+        }
+        return a->_order < b->_order;
+    });
+
+    for (auto timer : _dueTimers)
+    {
+        // skip the timers unscheduled or paused by a callback fired before them
+        if (timer->_queueState == Timer::QueueState::DUE)
+        {
+            tHashTimerEntry *elt = timer->_entry;
+            _currentTarget = elt;
+            _currentTargetSalvaged = false;
+
+            elt->currentTimer = timer;
+            timer->update((float)(_timerTime - timer->_lastUpdateTime));
+            timer->_lastUpdateTime = _timerTime;
+
+            if (timer->isAborted())
+            {
+                // The currentTimer told the remove itself. To prevent the timer from
+                // accidentally deallocating itself before finishing its step, we retained
+                // it. Now that step is done, it's safe to release it.
+                timer->release();
+            }
+            elt->currentTimer = nullptr;
+
+            if (timer->_queueState == Timer::QueueState::DUE)
+            {
+                queueTimer(timer);
+            }
+
+            // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
+            if (_currentTargetSalvaged && elt->timers->num == 0)
+            {
+                removeHashElement(elt);
+            }
+            _currentTarget = nullptr;
+        }
+        timer->release();
+    }
+    _dueTimers.clear();
+
+    // The timers scheduled since the last frame, including by the callbacks above, start counting from now
+    if (!_pendingTimers.empty())
+    {
+        std::vector<Timer*> pendingTimers;
+        pendingTimers.swap(_pendingTimers);
+
+        for (auto timer : pendingTimers)
+        {
+            if (timer->_queueState == Timer::QueueState::PENDING)
+            {
+                if (timer->_entry->paused)
+                {
+                    // resumeTimers() makes it pending again
+                    timer->_queueState = Timer::QueueState::PAUSED;
+                }
+                else
+                {
+                    timer->_elapsed = 0;
+                    timer->_timesExecuted = 0;
+                    timer->_lastUpdateTime = _timerTime;
+                    queueTimer(timer);
+                }
+            }
+            timer->release();
+        }
+    }
+}
+
 void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
 {
     this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
@@ -297,6 +548,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     {
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
+        element->order = ++_timerOrder;
 
         HASH_ADD_PTR(_hashForTimers, target, element);
 
@@ -322,6 +574,9 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                // start counting again from the next update, like a new timer
+                dequeueTimer(timer);
+                addPendingTimer(timer);
                 return;
             }
         }
@@ -330,7 +585,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
 
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
@@ -362,6 +617,7 @@ void Scheduler::unschedule(const std::string &key, void *target)
                     timer->setAborted();
                 }
 
+                dequeueTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
                 // update timerIndex in case we are in tick:, looping over the actions
@@ -642,6 +898,10 @@ void Scheduler::unscheduleAllForTarget(void *target)
             element->currentTimer->retain();
             element->currentTimer->setAborted();
         }
+        for (int i = 0; i < element->timers->num; ++i)
+        {
+            dequeueTimer((Timer*)element->timers->arr[i]);
+        }
         ccArrayRemoveAllObjects(element->timers);
 
         if (_currentTarget == element)
@@ -688,9 +948,10 @@ void Scheduler::resumeTarget(void *target)
     // custom selectors
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    if (element && element->paused)
     {
         element->paused = false;
+        resumeTimers(element);
     }
 
     // update selector
@@ -710,9 +971,10 @@ void Scheduler::pauseTarget(void *target)
     // custom selectors
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    if (element && !element->paused)
     {
         element->paused = true;
+        pauseTimers(element);
     }
 
     // update selector
@@ -761,7 +1023,11 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        if (!element->paused)
+        {
+            element->paused = true;
+            pauseTimers(element);
+        }
         idsWithSelectors.insert(element->target);
     }
 
@@ -809,13 +1075,11 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
 
 void Scheduler::performFunctionInCocosThread(std::function<void ()> function)
 {
-    std::lock_guard<std::mutex> lock(_performMutex);
-    _functionsToPerform.push_back(std::move(function));
+    _functionsToPerform.push(FunctionQueue::Function(std::move(function)));
 }
 
 void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
 {
-    std::unique_lock<std::mutex> lock(_performMutex);
     _functionsToPerform.clear();
 }
 
@@ -863,46 +1127,8 @@ void Scheduler::update(float dt)
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
-    {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
-
-        if (! _currentTarget->paused)
-        {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                CCASSERT
-                  ( !elt->currentTimer->isAborted(),
-                    "An aborted timer should not be updated" );
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimer->isAborted())
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
-
-                elt->currentTimer = nullptr;
-            }
-        }
-
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
-        }
-    }
+    // Iterate over the custom selectors that are due
+    updateTimers(dt);
  
     // delete all updates that are removed in update
     for (auto &e : _updateDeleteVector)
@@ -939,18 +1165,8 @@ void Scheduler::update(float dt)
     // Functions allocated from another thread
     //
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = std::move(_functionsToPerform);
-        _performMutex.unlock();
-        
-        for (const auto &function : temp) {
-            function();
-        }
-    }
+    // The queue is lock-free, and the functions added by the callbacks are left for the next frame.
+    _functionsToPerform.perform(_performFunctionsTimeBudget);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
@@ -964,6 +1180,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     {
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
+        element->order = ++_timerOrder;
         
         HASH_ADD_PTR(_hashForTimers, target, element);
         
@@ -989,6 +1206,9 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                // start counting again from the next update, like a new timer
+                dequeueTimer(timer);
+                addPendingTimer(timer);
                 return;
             }
         }
@@ -997,7 +1217,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
@@ -1062,6 +1282,7 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
                     timer->setAborted();
                 }
                 
+                dequeueTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
                 
                 // update timerIndex in case we are in tick:, looping over the actions
@@ -29,13 +29,16 @@ THE SOFTWARE.
 #ifndef __CCSCHEDULER_H__
 #define __CCSCHEDULER_H__
 
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <set>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
 #include "base/uthash.h"
+#include "base/CCFunctionQueue.h"
 
 NS_CC_BEGIN
 
@@ -63,6 +66,21 @@ public:
     void update(float dt);
     
 protected:
+    friend class Scheduler;
+
+    // Where the timer is in the scheduler's deadline queue
+    enum class QueueState : unsigned char
+    {
+        NONE,       // not scheduled
+        PENDING,    // starts counting on the next scheduler update
+        QUEUED,     // waiting in the queue for its next fire time
+        DUE,        // taken out of the queue to be updated this frame
+        PAUSED      // its target is paused, the time counted so far is kept in _elapsed
+    };
+
+    /** the scheduler time at which update() triggers the timer next, given the time counted since _lastUpdateTime */
+    double getNextFireTime() const;
+
     Scheduler* _scheduler; // weak ref
     float _elapsed;
     bool _runForever;
@@ -72,6 +90,14 @@ protected:
     float _delay;
     float _interval;
     bool _aborted;
+
+    // deadline queue bookkeeping, owned by the scheduler
+    struct _hashSelectorEntry *_entry;
+    double _lastUpdateTime;
+    double _nextFireTime;
+    uint64_t _order;
+    int _queueIndex;
+    QueueState _queueState;
 };
 
 
@@ -428,6 +454,37 @@ public:
      @js NA
      */
     void performFunctionInCocosThread(std::function<void()> function);
+
+    /** Calls a function on the cocos2d thread, like `performFunctionInCocosThread(std::function<void()>)`.
+     Lambdas capturing up to SmallFunction::INLINE_SIZE bytes are queued without any heap allocation.
+     This function is thread safe.
+     @param function The function to be run in cocos2d thread.
+     @js NA
+     @lua NA
+     */
+    template <typename F>
+    void performFunctionInCocosThread(F&& function)
+    {
+        _functionsToPerform.push(FunctionQueue::Function(std::forward<F>(function)));
+    }
+
+    /** Sets the time the functions queued with performFunctionInCocosThread may take each frame.
+     When it is exceeded, the remaining functions are called on the next frames, at least one function is called per frame.
+     @param seconds The time budget in seconds, 0 means no limit. Default is 0.
+     @js NA
+     */
+    void setPerformFunctionsTimeBudget(float seconds) { _performFunctionsTimeBudget = seconds; }
+    /** Gets the time the functions queued with performFunctionInCocosThread may take each frame, 0 means no limit.
+     @js NA
+     */
+    float getPerformFunctionsTimeBudget() const { return _performFunctionsTimeBudget; }
+
+    /** Gets the queue depth and drain time statistics of the functions queued with performFunctionInCocosThread.
+     Must be called on the cocos2d thread.
+     @js NA
+     @lua NA
+     */
+    FunctionQueue::Stats getPerformFunctionsStats() const { return _functionsToPerform.getStats(); }
     
     /**
      * Remove all pending functions queued to be performed with Scheduler::performFunctionInCocosThread
@@ -452,6 +509,18 @@ protected:
     void removeHashElement(struct _hashSelectorEntry *element);
     void removeUpdateFromHash(struct _listEntry *entry);
 
+    // timer deadline queue specific
+
+    void addTimer(struct _hashSelectorEntry *element, Timer *timer);
+    void addPendingTimer(Timer *timer);
+    void queueTimer(Timer *timer);
+    void dequeueTimer(Timer *timer);
+    void pauseTimers(struct _hashSelectorEntry *element);
+    void resumeTimers(struct _hashSelectorEntry *element);
+    void updateTimers(float dt);
+    void siftTimerUp(size_t index);
+    void siftTimerDown(size_t index);
+
     // update specific
 
     void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
@@ -475,14 +544,22 @@ protected:
     bool _currentTargetSalvaged;
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
+
+    // Timers are kept in a min-heap by their next fire time, so that a frame only visits the timers that fire.
+    // The scheduler time is the sum of the scaled frame times.
+    double _timerTime;
+    std::vector<Timer*> _timerQueue;
+    std::vector<Timer*> _pendingTimers;  // retained
+    std::vector<Timer*> _dueTimers;      // retained
+    uint64_t _timerOrder;
     
 #if CC_ENABLE_SCRIPT_BINDING
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
 #endif
     
     // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    FunctionQueue _functionsToPerform;
+    float _performFunctionsTimeBudget;
 };
 
 // end of base group
@@ -357,3 +357,14 @@ THE SOFTWARE.
 #ifndef CC_STRIP_FPS
 #define CC_STRIP_FPS 0
 #endif
+
+/** @def CC_ENABLE_ATOMIC_REF_COUNT
+ * If enabled, Ref::retain() and Ref::release() update the reference count atomically,
+ * so objects may be retained and released by worker threads.
+ * The last release destructs the object on the thread that does it, objects that must be
+ * destructed on the cocos2d thread should be handed over with Ref::autoreleaseInCocosThread().
+ * Disabled by default because it makes every retain and release slower.
+ */
+#ifndef CC_ENABLE_ATOMIC_REF_COUNT
+#define CC_ENABLE_ATOMIC_REF_COUNT 0
+#endif
@@ -40,6 +40,8 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFunctionQueue.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -149,12 +151,14 @@ THE SOFTWARE.
 // renderer
 #include "renderer/CCCallbackCommand.h"
 #include "renderer/CCCustomCommand.h"
+#include "renderer/CCInstancedCommand.h"
 #include "renderer/CCGroupCommand.h"
 #include "renderer/CCMaterial.h"
 #include "renderer/CCPass.h"
 #include "renderer/CCQuadCommand.h"
 #include "renderer/CCRenderCommand.h"
 #include "renderer/CCRenderCommandPool.h"
+#include "renderer/CCRenderFrameArena.h"
 #include "renderer/CCRenderState.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/CCTechnique.h"
@@ -20,7 +20,9 @@ This file was modified to fit the cocos2d-x project
 */
 
 #include "math/MathUtil.h"
+#include "math/Mat4.h"
 #include "base/ccMacros.h"
+#include "base/ccTypes.h"
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include <cpu-features.h>
@@ -276,4 +278,52 @@ void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 #endif
 }
 
+void MathUtil::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformVertices(transform.m, dst, src, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformVertices(transform.m, dst, src, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformVertices(transform.m, dst, src, count);
+    else MathUtilC::transformVertices(transform.m, dst, src, count);
+#elif defined (USE_SSE) && defined (__SSE2__)
+    transformVertices(transform.col, dst, src, count);
+#else
+    MathUtilC::transformVertices(transform.m, dst, src, count);
+#endif
+}
+
+void MathUtil::transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformIndices(dst, src, count, offset);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformIndices(dst, src, count, offset);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformIndices(dst, src, count, offset);
+    else MathUtilC::transformIndices(dst, src, count, offset);
+#elif defined (USE_SSE) && defined (__SSE2__)
+    transformIndicesSSE(dst, src, count, offset);
+#else
+    MathUtilC::transformIndices(dst, src, count, offset);
+#endif
+}
+
+void MathUtil::transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformIndices(dst, src, count, offset);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformIndices(dst, src, count, offset);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformIndices(dst, src, count, offset);
+    else MathUtilC::transformIndices(dst, src, count, offset);
+#elif defined (USE_SSE) && defined (__SSE2__)
+    transformIndicesSSE(dst, src, count, offset);
+#else
+    MathUtilC::transformIndices(dst, src, count, offset);
+#endif
+}
+
 NS_CC_MATH_END
@@ -36,6 +36,9 @@
 
 NS_CC_MATH_BEGIN
 
+class Mat4;
+struct V3F_C4B_T2F;
+
 /**
  * Defines a math utility class.
  *
@@ -88,6 +91,38 @@ public:
      * @return interpolated float value
      */
     static float lerp(float from, float to, float alpha);
+
+    /**
+     * Transforms the positions of the source vertices by the given matrix (w is taken as 1)
+     * and copies their colors and texture coordinates. Each destination vertex is written once
+     * and never read, so dst may point into mapped GPU memory.
+     *
+     * @param dst the destination vertices, must not overlap src.
+     * @param src the source vertices.
+     * @param count the number of vertices.
+     * @param transform the transform applied to the positions.
+     */
+    static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform);
+
+    /**
+     * Adds the given offset to each source index and stores the result.
+     *
+     * @param dst the destination indices, must not overlap src.
+     * @param src the source indices.
+     * @param count the number of indices.
+     * @param offset the offset added to each index.
+     */
+    static void transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset);
+
+    /**
+     * Adds the given offset to each source index and stores the result as a 32 bits index.
+     *
+     * @param dst the destination indices, must not overlap src.
+     * @param src the source indices.
+     * @param count the number of indices.
+     * @param offset the offset added to each index.
+     */
+    static void transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset);
 private:
     //Indicates that if neon is enabled
     static bool isNeon32Enabled();
@@ -109,6 +144,13 @@ private:
     static void transposeMatrix(const __m128 m[4], __m128 dst[4]);
         
     static void transformVec4(const __m128 m[4], const __m128& v, __m128& dst);
+#endif
+#ifdef __SSE2__
+    static void transformVertices(const __m128 m[4], V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count);
+
+    static void transformIndicesSSE(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset);
+
+    static void transformIndicesSSE(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset);
 #endif
     static void addMatrix(const float* m, float scalar, float* dst);
 
@@ -42,6 +42,12 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+
+    inline static void transformVertices(const float* m, V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count);
+
+    inline static void transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset);
+
+    inline static void transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset);
 };
 
 inline void MathUtilC::addMatrix(const float* m, float scalar, float* dst)
@@ -215,4 +221,30 @@ inline void MathUtilC::crossVec3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline void MathUtilC::transformVertices(const float* m, V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count)
+{
+    // same association as the SSE path, so both produce the same results
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vec3& v = src[i].vertices;
+        dst[i].vertices.x = (v.x * m[0] + v.y * m[4]) + (v.z * m[8] + m[12]);
+        dst[i].vertices.y = (v.x * m[1] + v.y * m[5]) + (v.z * m[9] + m[13]);
+        dst[i].vertices.z = (v.x * m[2] + v.y * m[6]) + (v.z * m[10] + m[14]);
+        dst[i].colors = src[i].colors;
+        dst[i].texCoords = src[i].texCoords;
+    }
+}
+
+inline void MathUtilC::transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = src[i] + offset;
+}
+
+inline void MathUtilC::transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = src[i] + offset;
+}
+
 NS_CC_MATH_END
@@ -17,6 +17,8 @@
 
  This file was modified to fit the cocos2d-x project
  */
+#include <arm_neon.h>
+
 NS_CC_MATH_BEGIN
 
 class MathUtilNeon
@@ -41,6 +43,12 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+
+    inline static void transformVertices(const float* m, V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count);
+
+    inline static void transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset);
+
+    inline static void transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset);
 };
 
 inline void MathUtilNeon::addMatrix(const float* m, float scalar, float* dst)
@@ -268,4 +276,51 @@ inline void MathUtilNeon::crossVec3(const float* v1, const float* v2, float* dst
                  );
 }
 
+inline void MathUtilNeon::transformVertices(const float* m, V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count)
+{
+    // position and color are loaded as one quad, the color lane is only selected back, never computed
+    const uint32x4_t positionMask = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0 };
+    float32x4_t m0 = vld1q_f32(m);
+    float32x4_t m1 = vld1q_f32(m + 4);
+    float32x4_t m2 = vld1q_f32(m + 8);
+    float32x4_t m3 = vld1q_f32(m + 12);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        float32x4_t v = vld1q_f32(&src[i].vertices.x);
+        float32x4_t r = vmlaq_n_f32(m3, m0, vgetq_lane_f32(v, 0));
+        r = vmlaq_n_f32(r, m1, vgetq_lane_f32(v, 1));
+        r = vmlaq_n_f32(r, m2, vgetq_lane_f32(v, 2));
+
+        vst1q_f32(&dst[i].vertices.x, vbslq_f32(positionMask, r, v));
+        vst1_f32(&dst[i].texCoords.u, vld1_f32(&src[i].texCoords.u));
+    }
+}
+
+inline void MathUtilNeon::transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+    uint16x8_t o = vdupq_n_u16(offset);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        vst1q_u16(dst + i, vaddq_u16(vld1q_u16(src + i), o));
+
+    for (; i < count; ++i)
+        dst[i] = src[i] + offset;
+}
+
+inline void MathUtilNeon::transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+    uint32x4_t o = vdupq_n_u32(offset);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t v = vld1q_u16(src + i);
+        vst1q_u32(dst + i, vaddw_u16(o, vget_low_u16(v)));
+        vst1q_u32(dst + i + 4, vaddw_u16(o, vget_high_u16(v)));
+    }
+
+    for (; i < count; ++i)
+        dst[i] = src[i] + offset;
+}
+
 NS_CC_MATH_END
@@ -1,3 +1,7 @@
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 NS_CC_MATH_BEGIN
 
 #ifdef __SSE__
@@ -153,5 +157,54 @@ void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128& dst)
 
 #endif
 
+#ifdef __SSE2__
+
+void MathUtil::transformVertices(const __m128 m[4], V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count)
+{
+    // position and color are loaded as one quad, the color lane is only selected back, never computed
+    const __m128 positionMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        __m128 v = _mm_loadu_ps(&src[i].vertices.x);
+        __m128 r = _mm_add_ps(
+                              _mm_add_ps(_mm_mul_ps(m[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(m[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)))),
+                              _mm_add_ps(_mm_mul_ps(m[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))), m[3])
+                              );
+
+        _mm_storeu_ps(&dst[i].vertices.x, _mm_or_ps(_mm_and_ps(positionMask, r), _mm_andnot_ps(positionMask, v)));
+        _mm_storel_epi64((__m128i*)&dst[i].texCoords, _mm_loadl_epi64((const __m128i*)&src[i].texCoords));
+    }
+}
+
+void MathUtil::transformIndicesSSE(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+    __m128i o = _mm_set1_epi16((short)offset);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi16(_mm_loadu_si128((const __m128i*)(src + i)), o));
+
+    for (; i < count; ++i)
+        dst[i] = src[i] + offset;
+}
+
+void MathUtil::transformIndicesSSE(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i o = _mm_set1_epi32((int)offset);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(_mm_unpacklo_epi16(v, zero), o));
+        _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_add_epi32(_mm_unpackhi_epi16(v, zero), o));
+    }
+
+    for (; i < count; ++i)
+        dst[i] = src[i] + offset;
+}
+
+#endif
+
 
 NS_CC_MATH_END
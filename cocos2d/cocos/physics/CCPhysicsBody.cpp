@@ -37,6 +37,9 @@
 #include "physics/CCPhysicsWorld.h"
 #include "physics/CCPhysicsHelper.h"
 
+// node and body positions closer than this are treated as already in sync
+static const float POSITION_SYNC_EPSILON = 0.001f;
+
 static void internalBodySetMass(cpBody *body, cpFloat mass)
 {
     cpBodyActivate(body);
@@ -896,12 +899,20 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat
     }
 
     // set position
+    // only when the node really moved: cpBodySetPosition() wakes the body up, so writing back the position
+    // that afterSimulation() just synced (plus float round-off) would keep every body from ever sleeping
     auto worldPosition = _ownerCenterOffset;
     nodeToWorldTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
-    setPosition(worldPosition.x, worldPosition.y);
 
-    _recordPosX = worldPosition.x;
-    _recordPosY = worldPosition.y;
+    auto bodyPosition = getPosition();
+    if (std::abs(worldPosition.x - bodyPosition.x) > POSITION_SYNC_EPSILON || std::abs(worldPosition.y - bodyPosition.y) > POSITION_SYNC_EPSILON)
+    {
+        setPosition(worldPosition.x, worldPosition.y);
+        bodyPosition.set(worldPosition.x, worldPosition.y);
+    }
+
+    _recordPosX = bodyPosition.x;
+    _recordPosY = bodyPosition.y;
 
     if (_owner->getAnchorPoint() != Vec2::ANCHOR_MIDDLE)
     {
@@ -939,9 +950,7 @@ void PhysicsBody::onExit()
 void PhysicsBody::onAdd()
 {
     _owner->_physicsBody = this;
-    auto contentSize = _owner->getContentSize();
-    _ownerCenterOffset.x = 0.5f * contentSize.width;
-    _ownerCenterOffset.y = 0.5f * contentSize.height;
+    updateOwnerCenterOffset();
 
     setRotationOffset(_owner->getRotation());
 
@@ -950,6 +959,15 @@ void PhysicsBody::onAdd()
     addToPhysicsWorld();
 }
 
+void PhysicsBody::updateOwnerCenterOffset()
+{
+    CCASSERT(_owner != nullptr, "_owner can't be nullptr");
+
+    auto contentSize = _owner->getContentSize();
+    _ownerCenterOffset.x = 0.5f * contentSize.width;
+    _ownerCenterOffset.y = 0.5f * contentSize.height;
+}
+
 void PhysicsBody::onRemove()
 {
     CCASSERT(_owner != nullptr, "_owner can't be nullptr");
@@ -489,6 +489,9 @@ public:
     /** Get the rigid body of chipmunk. */
     cpBody* getCPBody() const { return _cpBody; }
 
+    /** Recalculate the offset of the owner's center after its content size changed, e.g. when a pooled node is reused. */
+    void updateOwnerCenterOffset();
+
     virtual void onEnter() override;
     virtual void onExit() override;
     virtual void onAdd() override;
@@ -562,6 +565,7 @@ protected:
 
     friend class PhysicsWorld;
     friend class PhysicsShape;
+    friend class PhysicsShapePolygon;
     friend class PhysicsJoint;
 };
 
@@ -664,6 +664,48 @@ Vec2 PhysicsShapePolygon::getCenter()
     return center;
 }
 
+void PhysicsShapePolygon::setPoints(const Vec2* points, int count)
+{
+    auto shape = _cpShapes.front();
+    cpVect* vecs = new (std::nothrow) cpVect[count];
+    PhysicsHelper::points2cpvs(points, vecs, count);
+    
+    for (int i = 0; i < count; ++i)
+    {
+        vecs[i].x *= _scaleX;
+        vecs[i].y *= _scaleY;
+    }
+    
+    if (_body)
+    {
+        _body->_area -= _area;
+        if (!_body->_massSetByUser)
+            _body->addMass(-_mass);
+        if (!_body->_momentSetByUser)
+            _body->addMoment(-_moment);
+    }
+    
+    cpPolyShapeSetVerts(shape, count, vecs, cpTransformIdentity);
+    CC_SAFE_DELETE_ARRAY(vecs);
+    
+    _area = calculateArea();
+    _mass = _material.density == PHYSICS_INFINITY ? PHYSICS_INFINITY : _material.density * _area;
+    _moment = calculateDefaultMoment();
+    
+    if (_body)
+    {
+        _body->_area += _area;
+        if (!_body->_massSetByUser)
+            _body->addMass(_mass);
+        if (!_body->_momentSetByUser)
+            _body->addMoment(_moment);
+        
+        // the bounding box of a sleeping body is only refreshed once it is awake
+        if (cpBodyGetSpace(_body->getCPBody()))
+            cpBodyActivate(_body->getCPBody());
+    }
+}
+
 void PhysicsShapePolygon::updateScale()
 {
     cpFloat factorX = _newScaleX / _scaleX;
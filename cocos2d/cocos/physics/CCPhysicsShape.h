@@ -503,6 +503,18 @@ public:
      */
     int getPointsCount() const;
     
+    /**
+     * Replace this polygon's points in place.
+     *
+     * The underlying chipmunk shape is reused instead of being recreated, so a pooled body can change
+     * geometry without leaving the physics world. The current scale of the shape is applied to the points,
+     * and the area, mass and moment of the shape (and of its body, unless set by the user) are updated.
+     *
+     * @param   points A Vec2 object pointer, it is an array of Vec2 in unscaled body local coordinates.
+     * @param   count An integer number, contains the count of the points array.
+     */
+    void setPoints(const Vec2* points, int count);
+    
     /**
      * Get this polygon's center position.
      *
@@ -103,6 +103,16 @@ cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter *arb, struct c
     PhysicsShape *shapeB = static_cast<PhysicsShape*>(cpShapeGetUserData(b));
     CC_ASSERT(shapeA != nullptr && shapeB != nullptr);
     
+    // No listener can be notified about this pair, so skip constructing a PhysicsContact
+    // and dispatching events for it. The arbiter keeps a null user data and the other
+    // callbacks ignore it.
+    if (!world->isContactTestEnabled(shapeA, shapeB))
+    {
+        cpArbiterSetUserData(arb, nullptr);
+        return !world->isJointCollisionDisabled(shapeA->getBody(), shapeB->getBody())
+            && world->isCollisionEnabled(shapeA, shapeB);
+    }
+    
     auto contact = PhysicsContact::construct(shapeA, shapeB);
     cpArbiterSetUserData(arb, contact);
     contact->_contactInfo = arb;
@@ -112,17 +122,33 @@ cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter *arb, struct c
 
 cpBool PhysicsWorldCallback::collisionPreSolveCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
-    return world->collisionPreSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
+    PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    if (contact == nullptr)
+    {
+        return cpTrue;
+    }
+    
+    return world->collisionPreSolveCallback(*contact);
 }
 
 void PhysicsWorldCallback::collisionPostSolveCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
-    world->collisionPostSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
+    PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    if (contact == nullptr)
+    {
+        return;
+    }
+    
+    world->collisionPostSolveCallback(*contact);
 }
 
 void PhysicsWorldCallback::collisionSeparateCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
     PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    if (contact == nullptr)
+    {
+        return;
+    }
     
     world->collisionSeparateCallback(*contact);
     
@@ -176,6 +202,12 @@ void PhysicsWorldCallback::queryPointFunc(cpShape *shape, cpVect /*point*/, cpFl
 {
     PhysicsShape *physicsShape = static_cast<PhysicsShape*>(cpShapeGetUserData(shape));
     CC_ASSERT(physicsShape != nullptr);
+    
+    if (!PhysicsWorldCallback::continues)
+    {
+        return;
+    }
+    
     PhysicsWorldCallback::continues = info->func(*info->world, *physicsShape, info->data);
 }
 
@@ -297,18 +329,10 @@ void PhysicsWorld::debugDraw()
     }
 }
 
-bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
+bool PhysicsWorld::isJointCollisionDisabled(PhysicsBody* bodyA, PhysicsBody* bodyB) const
 {
-    bool ret = true;
-    
-    PhysicsShape* shapeA = contact.getShapeA();
-    PhysicsShape* shapeB = contact.getShapeB();
-    PhysicsBody* bodyA = shapeA->getBody();
-    PhysicsBody* bodyB = shapeB->getBody();
-    std::vector<PhysicsJoint*> jointsA = bodyA->getJoints();
-    
     // check the joint is collision enable or not
-    for (PhysicsJoint* joint : jointsA)
+    for (PhysicsJoint* joint : bodyA->getJoints())
     {
         if (std::find(_joints.begin(), _joints.end(), joint) == _joints.end())
         {
@@ -321,32 +345,50 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
             
             if (body == bodyB)
             {
-                contact.setNotificationEnable(false);
-                return false;
+                return true;
             }
         }
     }
     
-    // bitmask check
-    if ((shapeA->getCategoryBitmask() & shapeB->getContactTestBitmask()) == 0
-        || (shapeA->getContactTestBitmask() & shapeB->getCategoryBitmask()) == 0)
+    return false;
+}
+
+bool PhysicsWorld::isContactTestEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB) const
+{
+    return (shapeA->getCategoryBitmask() & shapeB->getContactTestBitmask()) != 0
+        && (shapeA->getContactTestBitmask() & shapeB->getCategoryBitmask()) != 0;
+}
+
+bool PhysicsWorld::isCollisionEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB) const
+{
+    if (shapeA->getGroup() != 0 && shapeA->getGroup() == shapeB->getGroup())
     {
-        contact.setNotificationEnable(false);
+        return shapeA->getGroup() > 0;
     }
     
-    if (shapeA->getGroup() != 0 && shapeA->getGroup() == shapeB->getGroup())
+    return (shapeA->getCategoryBitmask() & shapeB->getCollisionBitmask()) != 0
+        && (shapeB->getCategoryBitmask() & shapeA->getCollisionBitmask()) != 0;
+}
+
+bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
+{
+    PhysicsShape* shapeA = contact.getShapeA();
+    PhysicsShape* shapeB = contact.getShapeB();
+    
+    if (isJointCollisionDisabled(shapeA->getBody(), shapeB->getBody()))
     {
-        ret = shapeA->getGroup() > 0;
+        contact.setNotificationEnable(false);
+        return false;
     }
-    else
+    
+    // bitmask check
+    if (!isContactTestEnabled(shapeA, shapeB))
     {
-        if ((shapeA->getCategoryBitmask() & shapeB->getCollisionBitmask()) == 0
-            || (shapeB->getCategoryBitmask() & shapeA->getCollisionBitmask()) == 0)
-        {
-            ret = false;
-        }
+        contact.setNotificationEnable(false);
     }
     
+    bool ret = isCollisionEnabled(shapeA, shapeB);
+    
     if (contact.isNotificationEnabled())
     {
         contact.setEventCode(PhysicsContact::EventCode::BEGIN);
@@ -440,6 +482,11 @@ void PhysicsWorld::queryRect(PhysicsQueryRectCallbackFunc func, const Rect& rect
 }
 
 void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, void* data)
+{
+    queryNearPoint(func, point, 0.0f, data);
+}
+
+void PhysicsWorld::queryNearPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, float maxDistance, void* data)
 {
     CCASSERT(func != nullptr, "func shouldn't be nullptr");
     
@@ -454,7 +501,7 @@ void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& po
         PhysicsWorldCallback::continues = true;
         cpSpacePointQuery(_cpSpace,
                                  PhysicsHelper::point2cpv(point),
-                                 0,
+                                 maxDistance,
                                  CP_SHAPE_FILTER_ALL,
                                  (cpSpacePointQueryFunc)PhysicsWorldCallback::queryPointFunc,
                                  &info);
@@ -862,6 +909,35 @@ void PhysicsWorld::setSubsteps(int steps)
     }
 }
 
+void PhysicsWorld::setSolverThreads(unsigned long threads)
+{
+#if CC_TARGET_PLATFORM != CC_PLATFORM_WIN32
+    cpHastySpaceSetThreads(_cpSpace, threads);
+#else
+    CC_UNUSED_PARAM(threads);
+#endif
+}
+
+void PhysicsWorld::setSleepTimeThreshold(float seconds)
+{
+    cpSpaceSetSleepTimeThreshold(_cpSpace, seconds);
+}
+
+float PhysicsWorld::getSleepTimeThreshold() const
+{
+    return cpSpaceGetSleepTimeThreshold(_cpSpace);
+}
+
+void PhysicsWorld::setIdleSpeedThreshold(float speed)
+{
+    cpSpaceSetIdleSpeedThreshold(_cpSpace, speed);
+}
+
+float PhysicsWorld::getIdleSpeedThreshold() const
+{
+    return cpSpaceGetIdleSpeedThreshold(_cpSpace);
+}
+
 void PhysicsWorld::step(float delta)
 {
     if (_autoStep)
@@ -189,6 +189,19 @@ public:
     */
     void queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, void* data);
     
+    /**
+    * Searches for physics shapes whose surface lies within a distance of the point.
+    *
+    * Uses the spatial index of the space, so the cost depends on the shapes near the point
+    * rather than on the number of bodies in the world.
+    *
+    * @param   func   Func is called for each shape closer than maxDistance to the point, or containing it.
+    * @param   point   A Vec2 object contains the position of the point.
+    * @param   maxDistance   The maximum distance between the point and the surface of a shape.
+    * @param   data   User defined data, it is passed to func.
+    */
+    void queryNearPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, float maxDistance, void* data);
+    
     /**
     * Get physics shapes that contains the point. 
     * 
@@ -286,6 +299,16 @@ public:
      */
     void setSubsteps(int steps);
 
+    /**
+     * Set the number of threads used by the constraint solver.
+     *
+     * The multithreaded solver does not give reproducible results, use 1 when a simulation has to be replayed exactly.
+     * Passing 0 uses one thread per CPU. It has no effect on platforms using the single-threaded space.
+     *
+     * @param threads An unsigned long number.
+     */
+    void setSolverThreads(unsigned long threads);
+
     /**
     * Get the number of substeps of this physics world.
     *
@@ -302,6 +325,39 @@ public:
     /** get the number of substeps */
     int getFixedUpdateRate() const { return _fixedRate; }
 
+    /**
+     * Set how long a group of bodies has to stay idle before it falls asleep.
+     *
+     * Sleeping bodies are skipped by the solver until something touches them or they are moved, so a settled
+     * pile costs almost nothing to simulate. The default value is infinity, which disables sleeping.
+     *
+     * @param seconds A float number, in seconds.
+     */
+    void setSleepTimeThreshold(float seconds);
+
+    /**
+     * Get the time a body has to stay idle before it falls asleep.
+     *
+     * @return A float number, in seconds.
+     */
+    float getSleepTimeThreshold() const;
+
+    /**
+     * Set the speed below which a body is considered idle.
+     *
+     * The default value is 0, which estimates the threshold from the gravity of the world.
+     *
+     * @param speed A float number, in points per second.
+     */
+    void setIdleSpeedThreshold(float speed);
+
+    /**
+     * Get the speed below which a body is considered idle.
+     *
+     * @return A float number, in points per second.
+     */
+    float getIdleSpeedThreshold() const;
+
     /**
     * Set the debug draw mask of this physics world.
     * 
@@ -365,6 +421,10 @@ protected:
 
     virtual void debugDraw();
     
+    bool isJointCollisionDisabled(PhysicsBody* bodyA, PhysicsBody* bodyB) const;
+    bool isContactTestEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB) const;
+    bool isCollisionEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB) const;
+    
     virtual bool collisionBeginCallback(PhysicsContact& contact);
     virtual bool collisionPreSolveCallback(PhysicsContact& contact);
     virtual void collisionPostSolveCallback(PhysicsContact& contact);
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "base/CCEventType.h"
 #include "base/CCEventDispatcher.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/VertexArrayCacheGL.h"
 #include "platform/android/jni/JniHelper.h"
 #include "network/CCDownloader-android.h"
 
@@ -93,6 +95,9 @@ JNIEXPORT void Java_org_cocos2dx_lib_Cocos2dxRenderer_nativeInit(JNIEnv*  env, j
     else
     {
         cocos2d::Director::getInstance()->resetMatrixStack();
+        // The new context starts with default state and may reuse object names, forget the cached bindings before objects are recreated.
+        cocos2d::backend::StateCacheGL::invalidate();
+        cocos2d::backend::VertexArrayCacheGL::reset();
         cocos2d::EventCustom recreatedEvent(EVENT_RENDERER_RECREATED);
         director->getEventDispatcher()->dispatchEvent(&recreatedEvent);
         director->setGLDefaultValues();
@@ -259,6 +259,17 @@ GLViewImpl* GLViewImpl::createWithRect(const std::string& viewName, Rect rect, f
     return nullptr;
 }
 
+GLViewImpl* GLViewImpl::createOffscreen(const std::string& viewName, Rect rect)
+{
+    auto ret = new (std::nothrow) GLViewImpl;
+    if(ret && ret->initWithRect(viewName, rect, 1.0f, false, false)) {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
 GLViewImpl* GLViewImpl::createWithFullScreen(const std::string& viewName)
 {
     auto ret = new (std::nothrow) GLViewImpl();
@@ -281,13 +292,14 @@ GLViewImpl* GLViewImpl::createWithFullScreen(const std::string& viewName, const
     return nullptr;
 }
 
-bool GLViewImpl::initWithRect(const std::string& viewName, Rect rect, float frameZoomFactor, bool resizable)
+bool GLViewImpl::initWithRect(const std::string& viewName, Rect rect, float frameZoomFactor, bool resizable, bool visible)
 {
     setViewName(viewName);
 
     _frameZoomFactor = frameZoomFactor;
 
     glfwWindowHint(GLFW_RESIZABLE,resizable?GL_TRUE:GL_FALSE);
+    glfwWindowHint(GLFW_VISIBLE,visible?GL_TRUE:GL_FALSE);
     glfwWindowHint(GLFW_RED_BITS,_glContextAttrs.redBits);
     glfwWindowHint(GLFW_GREEN_BITS,_glContextAttrs.greenBits);
     glfwWindowHint(GLFW_BLUE_BITS,_glContextAttrs.blueBits);
@@ -61,6 +61,10 @@ public:
     static GLViewImpl* create(const std::string& viewName);
     static GLViewImpl* create(const std::string& viewName, bool resizable);
     static GLViewImpl* createWithRect(const std::string& viewName, Rect size, float frameZoomFactor = 1.0f, bool resizable = false);
+    /** Creates a view whose window is never shown. Rendering still goes to the window's default framebuffer,
+     * which is useful for benchmarks and tests running on machines without a display (e.g. under Xvfb).
+     */
+    static GLViewImpl* createOffscreen(const std::string& viewName, Rect size);
     static GLViewImpl* createWithFullScreen(const std::string& viewName);
     static GLViewImpl* createWithFullScreen(const std::string& viewName, const GLFWvidmode &videoMode, GLFWmonitor *monitor);
 
@@ -135,7 +139,7 @@ protected:
 
     bool initGlew();
 
-    bool initWithRect(const std::string& viewName, Rect rect, float frameZoomFactor, bool resizable);
+    bool initWithRect(const std::string& viewName, Rect rect, float frameZoomFactor, bool resizable, bool visible = true);
     bool initWithFullScreen(const std::string& viewName);
     bool initWithFullscreen(const std::string& viewname, const GLFWvidmode &videoMode, GLFWmonitor *monitor);
 
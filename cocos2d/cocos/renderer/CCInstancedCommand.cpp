@@ -0,0 +1,249 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "renderer/CCInstancedCommand.h"
+#include "renderer/CCTrianglesCommand.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/backend/ProgramState.h"
+#include "renderer/backend/ProgramCache.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+namespace
+{
+    // tl, bl, tr, br like V3F_C4B_T2F_Quad, indexed like the quads of PolygonInfo
+    const unsigned short* getEmulatedQuadIndices()
+    {
+        static std::vector<unsigned short> indices;
+        if (indices.empty())
+        {
+            indices.resize(InstancedCommand::MAX_EMULATED_INSTANCES * 6);
+            for (unsigned int i = 0; i < InstancedCommand::MAX_EMULATED_INSTANCES; ++i)
+            {
+                unsigned short first = (unsigned short)(i * 4);
+                unsigned short* quad = &indices[i * 6];
+                quad[0] = first + 0;
+                quad[1] = first + 1;
+                quad[2] = first + 2;
+                quad[3] = first + 3;
+                quad[4] = first + 2;
+                quad[5] = first + 1;
+            }
+        }
+        return indices.data();
+    }
+}
+
+void InstancedCommand::Instance::set(const V3F_C4B_T2F_Quad& quad, const Mat4& transform)
+{
+    Vec3 bottomRight;
+    Vec3 topLeft;
+    transform.transformPoint(quad.bl.vertices, &origin);
+    transform.transformPoint(quad.br.vertices, &bottomRight);
+    transform.transformPoint(quad.tl.vertices, &topLeft);
+
+    axisX.set(bottomRight.x - origin.x, bottomRight.y - origin.y);
+    axisY.set(topLeft.x - origin.x, topLeft.y - origin.y);
+
+    texOrigin = quad.bl.texCoords;
+    texAxisX = Tex2F(quad.br.texCoords.u - texOrigin.u, quad.br.texCoords.v - texOrigin.v);
+    texAxisY = Tex2F(quad.tl.texCoords.u - texOrigin.u, quad.tl.texCoords.v - texOrigin.v);
+
+    color = quad.bl.colors;
+}
+
+InstancedCommand::InstancedCommand()
+{
+    _type = RenderCommand::Type::INSTANCED_COMMAND;
+}
+
+InstancedCommand::~InstancedCommand()
+{
+    for (auto command : _emulatedCommands)
+        delete command;
+    CC_SAFE_RELEASE(_pipelineDescriptor.programState);
+    CC_SAFE_RELEASE(_emulatedProgramState);
+}
+
+void InstancedCommand::init(float globalOrder, Texture2D* texture, const BlendFunc& blendType, const Mat4& projection, uint32_t flags)
+{
+    RenderCommand::init(globalOrder, Mat4::IDENTITY, flags);
+
+    if (_pipelineDescriptor.programState == nullptr)
+    {
+        auto program = backend::ProgramCache::getInstance()->getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR_INSTANCED);
+        _pipelineDescriptor.programState = new (std::nothrow) backend::ProgramState(program);
+        _mvpMatrixLocation = _pipelineDescriptor.programState->getUniformLocation(backend::Uniform::MVP_MATRIX);
+        _textureLocation = _pipelineDescriptor.programState->getUniformLocation(backend::Uniform::TEXTURE);
+        setVertexLayout();
+    }
+
+    auto programState = _pipelineDescriptor.programState;
+    programState->setUniform(_mvpMatrixLocation, projection.m, sizeof(projection.m));
+    if (_texture != texture)
+    {
+        _texture = texture;
+        programState->setTexture(_textureLocation, 0, texture->getBackendTexture());
+    }
+
+    if (_blendType != blendType)
+    {
+        _blendType = blendType;
+
+        auto& blendDescriptor = _pipelineDescriptor.blendDescriptor;
+        blendDescriptor.blendEnabled = true;
+        blendDescriptor.sourceRGBBlendFactor = blendDescriptor.sourceAlphaBlendFactor = blendType.src;
+        blendDescriptor.destinationRGBBlendFactor = blendDescriptor.destinationAlphaBlendFactor = blendType.dst;
+    }
+
+    _projection = projection;
+    _flags = flags;
+}
+
+void InstancedCommand::setVertexLayout()
+{
+    auto programState = _pipelineDescriptor.programState;
+    auto vertexLayout = programState->getVertexLayout();
+
+    // the corners of the unit quad
+    vertexLayout->setAttribute(backend::ATTRIBUTE_NAME_POSITION,
+                               programState->getAttributeLocation(backend::Attribute::POSITION),
+                               backend::VertexFormat::FLOAT2,
+                               0,
+                               false);
+    vertexLayout->setLayout(sizeof(Vec2));
+
+    // axisX and axisY, texAxisX and texAxisY are read together
+    vertexLayout->setInstanceAttribute("a_instanceOrigin",
+                                       programState->getAttributeLocation("a_instanceOrigin"),
+                                       backend::VertexFormat::FLOAT3,
+                                       offsetof(Instance, origin),
+                                       false);
+    vertexLayout->setInstanceAttribute("a_instanceAxes",
+                                       programState->getAttributeLocation("a_instanceAxes"),
+                                       backend::VertexFormat::FLOAT4,
+                                       offsetof(Instance, axisX),
+                                       false);
+    vertexLayout->setInstanceAttribute("a_instanceTexOrigin",
+                                       programState->getAttributeLocation("a_instanceTexOrigin"),
+                                       backend::VertexFormat::FLOAT2,
+                                       offsetof(Instance, texOrigin),
+                                       false);
+    vertexLayout->setInstanceAttribute("a_instanceTexAxes",
+                                       programState->getAttributeLocation("a_instanceTexAxes"),
+                                       backend::VertexFormat::FLOAT4,
+                                       offsetof(Instance, texAxisX),
+                                       false);
+    vertexLayout->setInstanceAttribute("a_instanceColor",
+                                       programState->getAttributeLocation("a_instanceColor"),
+                                       backend::VertexFormat::UBYTE4,
+                                       offsetof(Instance, color),
+                                       true);
+    vertexLayout->setInstanceLayout(sizeof(Instance));
+}
+
+void InstancedCommand::setEmulatedVertexLayout()
+{
+    auto vertexLayout = _emulatedProgramState->getVertexLayout();
+    vertexLayout->setAttribute(backend::ATTRIBUTE_NAME_POSITION,
+                               _emulatedProgramState->getAttributeLocation(backend::Attribute::POSITION),
+                               backend::VertexFormat::FLOAT3,
+                               0,
+                               false);
+    vertexLayout->setAttribute(backend::ATTRIBUTE_NAME_TEXCOORD,
+                               _emulatedProgramState->getAttributeLocation(backend::Attribute::TEXCOORD),
+                               backend::VertexFormat::FLOAT2,
+                               offsetof(V3F_C4B_T2F, texCoords),
+                               false);
+    vertexLayout->setAttribute(backend::ATTRIBUTE_NAME_COLOR,
+                               _emulatedProgramState->getAttributeLocation(backend::Attribute::COLOR),
+                               backend::VertexFormat::UBYTE4,
+                               offsetof(V3F_C4B_T2F, colors),
+                               true);
+    vertexLayout->setLayout(sizeof(V3F_C4B_T2F));
+}
+
+const std::vector<TrianglesCommand*>& InstancedCommand::updateEmulatedCommands()
+{
+    if (_emulatedProgramState == nullptr)
+    {
+        auto program = backend::ProgramCache::getInstance()->getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR);
+        _emulatedProgramState = new (std::nothrow) backend::ProgramState(program);
+        _emulatedMVPMatrixLocation = _emulatedProgramState->getUniformLocation(backend::Uniform::MVP_MATRIX);
+        _emulatedTextureLocation = _emulatedProgramState->getUniformLocation(backend::Uniform::TEXTURE);
+        setEmulatedVertexLayout();
+    }
+    _emulatedProgramState->setUniform(_emulatedMVPMatrixLocation, _projection.m, sizeof(_projection.m));
+    _emulatedProgramState->setTexture(_emulatedTextureLocation, 0, _texture->getBackendTexture());
+
+    // the instances are already in world space, so the quads are too
+    std::size_t count = _instances.size();
+    _emulatedVertices.resize(count * 4);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto& instance = _instances[i];
+        V3F_C4B_T2F* quad = &_emulatedVertices[i * 4];
+
+        Vec3 axisX(instance.axisX.x, instance.axisX.y, 0.0f);
+        Vec3 axisY(instance.axisY.x, instance.axisY.y, 0.0f);
+        quad[0].vertices = instance.origin + axisY;
+        quad[1].vertices = instance.origin;
+        quad[2].vertices = instance.origin + axisX + axisY;
+        quad[3].vertices = instance.origin + axisX;
+
+        const Tex2F& uv = instance.texOrigin;
+        quad[0].texCoords = Tex2F(uv.u + instance.texAxisY.u, uv.v + instance.texAxisY.v);
+        quad[1].texCoords = uv;
+        quad[2].texCoords = Tex2F(uv.u + instance.texAxisX.u + instance.texAxisY.u, uv.v + instance.texAxisX.v + instance.texAxisY.v);
+        quad[3].texCoords = Tex2F(uv.u + instance.texAxisX.u, uv.v + instance.texAxisX.v);
+
+        quad[0].colors = quad[1].colors = quad[2].colors = quad[3].colors = instance.color;
+    }
+
+    _activeEmulatedCommands.clear();
+    auto indices = getEmulatedQuadIndices();
+    for (std::size_t first = 0, index = 0; first < count; first += MAX_EMULATED_INSTANCES, ++index)
+    {
+        if (index == _emulatedCommands.size())
+        {
+            auto command = new (std::nothrow) TrianglesCommand();
+            command->getPipelineDescriptor().programState = _emulatedProgramState;
+            _emulatedCommands.push_back(command);
+        }
+
+        auto command = _emulatedCommands[index];
+        command->getPipelineDescriptor().programState = _emulatedProgramState;
+
+        unsigned int quads = (unsigned int)std::min<std::size_t>(count - first, MAX_EMULATED_INSTANCES);
+        TrianglesCommand::Triangles triangles(&_emulatedVertices[first * 4], const_cast<unsigned short*>(indices), quads * 4, quads * 6);
+        command->init(_globalOrder, _texture, _blendType, triangles, Mat4::IDENTITY, _flags);
+        _activeEmulatedCommands.push_back(command);
+    }
+    return _activeEmulatedCommands;
+}
+
+NS_CC_END
@@ -0,0 +1,147 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#pragma once
+
+#include <vector>
+
+#include "renderer/CCRenderCommand.h"
+#include "renderer/backend/Types.h"
+#include "base/ccTypes.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class Texture2D;
+class TrianglesCommand;
+
+/**
+ Command used to render many textured quads that share a texture and a blend function with one draw call.
+ Each quad is an instance: its transform, texture rectangle and color are stored once, and the renderer
+ streams them to an instance buffer and draws them with `CommandBuffer::drawElementsInstanced()`.
+ When the backend doesn't support instancing, the instances are expanded into quads and batched like
+ `TrianglesCommand`s with the same texture and blend function.
+*/
+class CC_DLL InstancedCommand : public RenderCommand
+{
+public:
+    /**
+     The data of one instance, laid out like the per-instance attributes of `positionTextureColorInstanced_vert`.
+     The corner (s, t) of the unit quad is drawn at origin + s * axisX + t * axisY, with the texture coordinates
+     texOrigin + s * texAxisX + t * texAxisY, so the quad can be translated, rotated, scaled and skewed.
+     */
+    struct Instance
+    {
+        /**World position of the bottom left corner.*/
+        Vec3 origin;
+        /**World offset from the bottom left corner to the bottom right corner.*/
+        Vec2 axisX;
+        /**World offset from the bottom left corner to the top left corner.*/
+        Vec2 axisY;
+        /**Texture coordinates of the bottom left corner.*/
+        Tex2F texOrigin;
+        /**Texture coordinates offset from the bottom left corner to the bottom right corner.*/
+        Tex2F texAxisX;
+        /**Texture coordinates offset from the bottom left corner to the top left corner.*/
+        Tex2F texAxisY;
+        /**Color of the quad, premultiplied when the texture is.*/
+        Color4B color;
+
+        /**
+         Set the instance from a quad in local space and the transform of its node.
+         The transform must be affine in x and y, the color of the bottom left corner is used for the whole quad.
+         */
+        void set(const V3F_C4B_T2F_Quad& quad, const Mat4& transform);
+    };
+
+    /**The number of instances expanded into a single `TrianglesCommand`, so that their vertices can be indexed with 16 bits.*/
+    static const unsigned int MAX_EMULATED_INSTANCES = 16384;
+
+    /**Constructor.*/
+    InstancedCommand();
+    /**Destructor.*/
+    ~InstancedCommand();
+
+    /**
+     Initializes the command.
+     @param globalOrder GlobalZOrder of the command.
+     @param texture The texture of every instance.
+     @param blendType Blend function for the command.
+     @param projection Projection matrix of the instances, which are in world space.
+     @param flags to indicate that the command is using 3D rendering or not.
+     */
+    void init(float globalOrder, Texture2D* texture, const BlendFunc& blendType, const Mat4& projection, uint32_t flags);
+
+    /**
+     Set the number of instances. The instances that are kept keep their data, new ones are uninitialized.
+     The instances should not be resized while the command is queued in the renderer.
+     */
+    void setInstanceCount(std::size_t count) { _instances.resize(count); }
+    /**Get the number of instances.*/
+    std::size_t getInstanceCount() const { return _instances.size(); }
+    /**Get the instances, they can be written to from several threads as long as each thread writes its own instances.*/
+    Instance* getInstances() { return _instances.data(); }
+    /**Get the instances.*/
+    const Instance* getInstances() const { return _instances.data(); }
+
+    /**Get the texture of the instances.*/
+    Texture2D* getTexture() const { return _texture; }
+
+    /**
+     Expand the instances into quads, for the backends that don't support instancing.
+     @return The `TrianglesCommand`s to process instead of this command, valid until the next call.
+     */
+    const std::vector<TrianglesCommand*>& updateEmulatedCommands();
+
+protected:
+    void setVertexLayout();
+    void setEmulatedVertexLayout();
+
+    std::vector<Instance> _instances;
+    Texture2D* _texture = nullptr;
+    BlendFunc _blendType = BlendFunc::DISABLE;
+    uint32_t _flags = 0;
+
+    backend::UniformLocation _mvpMatrixLocation;
+    backend::UniformLocation _textureLocation;
+
+    // the emulated draws share a position_texture_color program state, they are recreated lazily
+    backend::ProgramState* _emulatedProgramState = nullptr;
+    backend::UniformLocation _emulatedMVPMatrixLocation;
+    backend::UniformLocation _emulatedTextureLocation;
+    Mat4 _projection;
+    std::vector<V3F_C4B_T2F> _emulatedVertices;
+    std::vector<TrianglesCommand*> _emulatedCommands;
+    std::vector<TrianglesCommand*> _activeEmulatedCommands;
+};
+
+NS_CC_END
+/**
+ end of support group
+ @}
+ */
@@ -59,7 +59,9 @@ public:
         TRIANGLES_COMMAND,
         /**Callback command, used for calling callback for rendering.*/
         CALLBACK_COMMAND,
-        CAPTURE_SCREEN_COMMAND
+        CAPTURE_SCREEN_COMMAND,
+        /**Instanced command, used to draw many quads sharing a texture with one draw call.*/
+        INSTANCED_COMMAND
     };
 
     /**
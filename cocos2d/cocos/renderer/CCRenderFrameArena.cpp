@@ -0,0 +1,112 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "renderer/CCRenderFrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+RenderFrameArena::RenderFrameArena(std::size_t blockSize)
+: _blockSize(blockSize)
+{
+}
+
+RenderFrameArena::~RenderFrameArena()
+{
+    reset();
+    releaseBlocks();
+}
+
+void* RenderFrameArena::allocate(std::size_t size, std::size_t alignment)
+{
+    CCASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+
+    while (true)
+    {
+        if (_currentBlock < _blocks.size())
+        {
+            const auto& block = _blocks[_currentBlock];
+            auto base = reinterpret_cast<std::uintptr_t>(block.data);
+            auto aligned = (base + _offset + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+            std::size_t end = (std::size_t)(aligned - base) + size;
+            if (end <= block.size)
+            {
+                _offset = end;
+                _usedBytes += size;
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            // move on to the next block that was kept from an earlier frame, if any
+            ++_currentBlock;
+            _offset = 0;
+            if (_currentBlock < _blocks.size())
+                continue;
+        }
+        addBlock(size + alignment);
+    }
+}
+
+void RenderFrameArena::reset()
+{
+    for (auto it = _destructors.rbegin(); it != _destructors.rend(); ++it)
+        it->destroy(it->object);
+    _destructors.clear();
+
+    // coalesce the blocks of a frame that overflowed, so that the next one fits in a single block
+    if (_blocks.size() > 1)
+    {
+        std::size_t capacity = _capacity;
+        releaseBlocks();
+        _blockSize = std::max(_blockSize, capacity);
+        addBlock(capacity);
+    }
+
+    _currentBlock = 0;
+    _offset = 0;
+    _usedBytes = 0;
+}
+
+void RenderFrameArena::addBlock(std::size_t minSize)
+{
+    std::size_t size = std::max(_blockSize, minSize);
+    _blocks.push_back({ new char[size], size });
+    _capacity += size;
+    _currentBlock = _blocks.size() - 1;
+    _offset = 0;
+}
+
+void RenderFrameArena::releaseBlocks()
+{
+    for (auto& block : _blocks)
+        delete[] block.data;
+    _blocks.clear();
+    _capacity = 0;
+}
+
+NS_CC_END
@@ -0,0 +1,145 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_RENDERFRAMEARENA_H__
+#define __CC_RENDERFRAMEARENA_H__
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ * @class RenderFrameArena
+ * @brief A linear allocator for objects that only live until the end of the frame.
+ * Allocation bumps a pointer inside a block; reset() runs the destructors of the constructed objects
+ * in reverse order and rewinds all blocks at once, so nothing is freed individually.
+ * When a frame needs more than one block, reset() replaces them with a single block of the combined size,
+ * so that in steady state each frame is served from one block without touching the heap.
+ * The arena is not thread safe.
+ */
+class CC_DLL RenderFrameArena
+{
+public:
+    /** The size of the first block, in bytes. */
+    static const std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit RenderFrameArena(std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~RenderFrameArena();
+
+    /**
+     * Allocates uninitialized memory that stays valid until the next reset().
+     * @param size The size in bytes.
+     * @param alignment The alignment, must be a power of two.
+     */
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Constructs an object in the arena. Its destructor is called by reset().
+     */
+    template <typename T, typename... Args>
+    T* construct(Args&&... args)
+    {
+        void* memory = allocate(sizeof(T), alignof(T));
+        return adopt(new (memory) T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Makes reset() call the destructor of an object that was constructed in memory allocated from the arena.
+     */
+    template <typename T>
+    T* adopt(T* object)
+    {
+        _destructors.push_back({ &destroy<T>, object });
+        return object;
+    }
+
+    /**
+     * Allocates an uninitialized array of trivially destructible elements.
+     */
+    template <typename T>
+    T* allocateArray(std::size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /** Destroys all constructed objects and makes the whole capacity available again. */
+    void reset();
+
+    /** Returns the number of bytes allocated since the last reset(). */
+    std::size_t getUsedBytes() const { return _usedBytes; }
+
+    /** Returns the total size of the blocks owned by the arena. */
+    std::size_t getCapacity() const { return _capacity; }
+
+private:
+    struct Block
+    {
+        char* data;
+        std::size_t size;
+    };
+
+    struct Destructor
+    {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    template <typename T>
+    static void destroy(void* object)
+    {
+        static_cast<T*>(object)->~T();
+    }
+
+    void addBlock(std::size_t minSize);
+    void releaseBlocks();
+
+    std::vector<Block> _blocks;
+    std::vector<Destructor> _destructors;
+    std::size_t _currentBlock = 0;
+    std::size_t _offset = 0;
+    std::size_t _usedBytes = 0;
+    std::size_t _capacity = 0;
+    std::size_t _blockSize = 0;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(RenderFrameArena);
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_RENDERFRAMEARENA_H__
@@ -25,9 +25,13 @@
 #include "renderer/CCRenderer.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
 
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCCustomCommand.h"
+#include "renderer/CCInstancedCommand.h"
 #include "renderer/CCCallbackCommand.h"
 #include "renderer/CCGroupCommand.h"
 #include "renderer/CCMeshCommand.h"
@@ -36,6 +40,8 @@
 #include "renderer/CCPass.h"
 #include "renderer/CCTexture2D.h"
 
+#include "math/MathUtil.h"
+
 #include "base/CCConfiguration.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
@@ -46,6 +52,7 @@
 #include "xxhash.h"
 
 #include "renderer/backend/Backend.h"
+#include "renderer/backend/ProgramState.h"
 
 NS_CC_BEGIN
 
@@ -60,6 +67,81 @@ static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
     return  a->getDepth() > b->getDepth();
 }
 
+static bool supportsUIntIndices()
+{
+#ifdef CC_USE_GLES
+    static const bool supported = Configuration::getInstance()->checkForGLExtension("GL_OES_element_index_uint");
+    return supported;
+#else
+    return true;
+#endif
+}
+
+// rebased 16 bits indices can't address more than VBO_SIZE vertices
+static unsigned int maxBatchVertexCapacity()
+{
+    return supportsUIntIndices() ? Renderer::MAX_GROWN_VBO_SIZE : Renderer::VBO_SIZE;
+}
+
+static unsigned int maxBatchIndexCapacity()
+{
+    return Renderer::INDEX_VBO_SIZE * (maxBatchVertexCapacity() / Renderer::VBO_SIZE);
+}
+
+static unsigned int nextPowerOfTwo(unsigned int value)
+{
+    unsigned int result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+static bool isReorderableCommand(RenderCommand* command)
+{
+    return command->getType() == RenderCommand::Type::TRIANGLES_COMMAND && !command->isSkipBatching() && !command->is3D();
+}
+
+// ids of the GPU timers used by the frame timings
+static const unsigned int GPU_TIMER_FRAME = 0;
+static const unsigned int GPU_TIMER_GROUP = 1;
+static const unsigned int GPU_TIMER_CLEAR = 2;
+
+// marks the entries of the frame timings history that were not recorded
+static const uint64_t INVALID_TIMED_FRAME = std::numeric_limits<uint64_t>::max();
+
+static double getTimeInMilliseconds()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// conservative world space bounds of the command on the xy plane
+static Rect computeWorldBounds(const TrianglesCommand* cmd)
+{
+    const V3F_C4B_T2F* verts = cmd->getVertices();
+    size_t vertexCount = cmd->getVertexCount();
+    if (vertexCount == 0)
+        return Rect::ZERO;
+
+    Vec3 minPoint = verts[0].vertices;
+    Vec3 maxPoint = verts[0].vertices;
+    for (size_t i = 1; i < vertexCount; ++i)
+    {
+        const Vec3& v = verts[i].vertices;
+        minPoint.set(std::min(minPoint.x, v.x), std::min(minPoint.y, v.y), std::min(minPoint.z, v.z));
+        maxPoint.set(std::max(maxPoint.x, v.x), std::max(maxPoint.y, v.y), std::max(maxPoint.z, v.z));
+    }
+
+    // transform the center, and project the extents with the absolute matrix
+    const float* m = cmd->getModelView().m;
+    Vec3 center = (minPoint + maxPoint) * 0.5f;
+    Vec3 extent = (maxPoint - minPoint) * 0.5f;
+    float x = center.x * m[0] + center.y * m[4] + center.z * m[8] + m[12];
+    float y = center.x * m[1] + center.y * m[5] + center.z * m[9] + m[13];
+    float ex = extent.x * std::abs(m[0]) + extent.y * std::abs(m[4]) + extent.z * std::abs(m[8]);
+    float ey = extent.x * std::abs(m[1]) + extent.y * std::abs(m[5]) + extent.z * std::abs(m[9]);
+    return Rect(x - ex, y - ey, ex * 2, ey * 2);
+}
+
 // queue
 RenderQueue::RenderQueue()
 {
@@ -153,6 +235,9 @@ void RenderQueue::realloc(size_t reserveSize)
 //
 static const int DEFAULT_RENDER_QUEUE = 0;
 
+// commands added on this thread while visiting a subtree in parallel
+static thread_local std::vector<RenderCommand*>* s_commandRecorder = nullptr;
+
 //
 // constructors, destructor, init
 //
@@ -177,16 +262,17 @@ Renderer::~Renderer()
     
     free(_triBatchesToDraw);
     
+    CC_SAFE_RELEASE(_instanceQuadVertexBuffer);
+    CC_SAFE_RELEASE(_instanceQuadIndexBuffer);
+    CC_SAFE_RELEASE(_instanceBuffer);
     CC_SAFE_RELEASE(_commandBuffer);
     CC_SAFE_RELEASE(_renderPipeline);
 }
 
 void Renderer::init()
 {
-    // Should invoke _triangleCommandBufferManager.init() first.
-    _triangleCommandBufferManager.init();
-    _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
-    _indexBuffer = _triangleCommandBufferManager.getIndexBuffer();
+    // Should create the batch buffers first.
+    resizeBatchBuffers(_batchVertexCapacity, _batchIndexCapacity);
 
     auto device = backend::Device::getInstance();
     _commandBuffer = device->newCommandBuffer();
@@ -194,8 +280,24 @@ void Renderer::init()
     _commandBuffer->setRenderPipeline(_renderPipeline);
 }
 
+void Renderer::setCommandRecorder(std::vector<RenderCommand*>* recorder)
+{
+    s_commandRecorder = recorder;
+}
+
+bool Renderer::isRecordingCommands()
+{
+    return s_commandRecorder != nullptr;
+}
+
 void Renderer::addCommand(RenderCommand* command)
 {
+    if (s_commandRecorder)
+    {
+        s_commandRecorder->push_back(command);
+        return;
+    }
+
     int renderQueueID =_commandGroupStack.top();
     addCommand(command, renderQueueID);
 }
@@ -203,6 +305,7 @@ void Renderer::addCommand(RenderCommand* command)
 void Renderer::addCommand(RenderCommand* command, int renderQueueID)
 {
     CCASSERT(!_isRendering, "Cannot add command while rendering");
+    CCASSERT(!s_commandRecorder, "Only addCommand(RenderCommand*) can be recorded");
     CCASSERT(renderQueueID >=0, "Invalid render queue");
     CCASSERT(command->getType() != RenderCommand::Type::UNKNOWN_COMMAND, "Invalid Command Type");
 
@@ -212,12 +315,14 @@ void Renderer::addCommand(RenderCommand* command, int renderQueueID)
 void Renderer::pushGroup(int renderQueueID)
 {
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    CCASSERT(!s_commandRecorder, "Cannot change render queue while recording commands");
     _commandGroupStack.push(renderQueueID);
 }
 
 void Renderer::popGroup()
 {
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    CCASSERT(!s_commandRecorder, "Cannot change render queue while recording commands");
     _commandGroupStack.pop();
 }
 
@@ -234,6 +339,11 @@ void Renderer::processGroupCommand(GroupCommand* command)
 
     int renderQueueID = ((GroupCommand*) command)->getRenderQueueID();
 
+    // nested groups are part of the outermost one
+    bool timed = _gpuTimingActive && _gpuGroupTimingDepth++ == 0;
+    if (timed)
+        _commandBuffer->beginGPUTimer(GPU_TIMER_GROUP);
+
     pushStateBlock();
     //apply default state for all render queues
     setDepthTest(false);
@@ -241,6 +351,11 @@ void Renderer::processGroupCommand(GroupCommand* command)
     setCullMode(backend::CullMode::NONE);
     visitRenderQueue(_renderGroups[renderQueueID]);
     popStateBlock();
+
+    if (timed)
+        _commandBuffer->endGPUTimer(GPU_TIMER_GROUP);
+    if (_gpuTimingActive)
+        --_gpuGroupTimingDepth;
 }
 
 void Renderer::processRenderCommand(RenderCommand* command)
@@ -256,27 +371,31 @@ void Renderer::processRenderCommand(RenderCommand* command)
             auto cmd = static_cast<TrianglesCommand*>(command);
             
             // flush own queue when buffer is full
-            if(_queuedTotalVertexCount + cmd->getVertexCount() > VBO_SIZE || _queuedTotalIndexCount + cmd->getIndexCount() > INDEX_VBO_SIZE)
+            unsigned int vertexCount = (unsigned int)cmd->getVertexCount();
+            unsigned int indexCount = (unsigned int)cmd->getIndexCount();
+            if(_queuedTotalVertexCount + vertexCount > _batchVertexCapacity || _queuedTotalIndexCount + indexCount > _batchIndexCapacity)
             {
-                CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
-                CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() < INDEX_VBO_SIZE, "VBO for index is not big enough, please break the data down or use customized render command");
                 drawBatchedTriangles();
 
                 _queuedTotalIndexCount = _queuedTotalVertexCount = 0;
-#ifdef CC_USE_METAL
                 _queuedIndexCount = _queuedVertexCount = 0;
+#ifdef CC_USE_METAL
                 _triangleCommandBufferManager.prepareNextBuffer();
                 _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
                 _indexBuffer = _triangleCommandBufferManager.getIndexBuffer();
 #endif
+
+                // a command bigger than the buffers grows them right away, otherwise grow for the next frame
+                if (vertexCount > _batchVertexCapacity || indexCount > _batchIndexCapacity)
+                    growBatchBuffers(vertexCount, indexCount);
+                else
+                    _batchBufferOverflowed = true;
             }
             
             // queue it
             _queuedTriangleCommands.push_back(cmd);
-#ifdef CC_USE_METAL
             _queuedIndexCount += cmd->getIndexCount();
             _queuedVertexCount += cmd->getVertexCount();
-#endif
             _queuedTotalVertexCount += cmd->getVertexCount();
             _queuedTotalIndexCount += cmd->getIndexCount();
 
@@ -301,12 +420,74 @@ void Renderer::processRenderCommand(RenderCommand* command)
             flush();
             captureScreen(command);
             break;
+        case RenderCommand::Type::INSTANCED_COMMAND:
+        {
+            auto cmd = static_cast<InstancedCommand*>(command);
+            if (cmd->getInstanceCount() == 0)
+                break;
+
+            if (_commandBuffer->isInstancingSupported())
+            {
+                flush();
+                drawInstancedCommand(cmd);
+            }
+            else
+            {
+                // emulated: the instances are expanded into quads and batched like sprites
+                for (auto trianglesCommand : cmd->updateEmulatedCommands())
+                    processRenderCommand(trianglesCommand);
+            }
+        }
+            break;
         default:
             assert(false);
             break;
     }
 }
 
+void Renderer::drawInstancedCommand(InstancedCommand* cmd)
+{
+    auto device = backend::Device::getInstance();
+    if (!_instanceQuadVertexBuffer)
+    {
+        // corners of the unit quad, in the order of V3F_C4B_T2F_Quad: tl, bl, tr, br
+        Vec2 corners[] = { Vec2(0, 1), Vec2(0, 0), Vec2(1, 1), Vec2(1, 0) };
+        unsigned short indices[] = { 0, 1, 2, 3, 2, 1 };
+        _instanceQuadVertexBuffer = device->newBuffer(sizeof(corners), backend::BufferType::VERTEX, backend::BufferUsage::STATIC);
+        _instanceQuadVertexBuffer->updateData(corners, sizeof(corners));
+        _instanceQuadIndexBuffer = device->newBuffer(sizeof(indices), backend::BufferType::INDEX, backend::BufferUsage::STATIC);
+        _instanceQuadIndexBuffer->updateData(indices, sizeof(indices));
+    }
+
+    // the instances are streamed like the batched vertices, a command bigger than the buffer grows it
+    std::size_t instanceCount = cmd->getInstanceCount();
+    std::size_t size = instanceCount * sizeof(InstancedCommand::Instance);
+    if (!_instanceBuffer || _instanceBuffer->getSize() < size)
+    {
+        std::size_t capacity = std::max<std::size_t>(INSTANCE_VBO_SIZE, instanceCount * 2);
+        CC_SAFE_RELEASE(_instanceBuffer);
+        _instanceBuffer = device->newBuffer(capacity * sizeof(InstancedCommand::Instance), backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
+    }
+
+    std::size_t offset = 0;
+    auto data = _instanceBuffer->reserveStreamRange(size, sizeof(InstancedCommand::Instance), offset);
+    if (!data)
+        return;
+    memcpy(data, cmd->getInstances(), size);
+    _instanceBuffer->commitStreamRange(size);
+
+    beginRenderPass(cmd);
+    _commandBuffer->setVertexBuffer(_instanceQuadVertexBuffer);
+    _commandBuffer->setIndexBuffer(_instanceQuadIndexBuffer);
+    _commandBuffer->setProgramState(cmd->getPipelineDescriptor().programState);
+    _commandBuffer->setInstanceBuffer(_instanceBuffer, offset);
+    _commandBuffer->drawElementsInstanced(backend::PrimitiveType::TRIANGLE, backend::IndexFormat::U_SHORT, 6, 0, instanceCount);
+    _commandBuffer->endRenderPass();
+
+    _drawnBatches++;
+    _drawnVertices += instanceCount * 6;
+}
+
 void Renderer::captureScreen(RenderCommand *command)
 {
     _commandBuffer->captureScreen(static_cast<CaptureScreenCallbackCommand*>(command)->func);
@@ -360,6 +541,9 @@ void Renderer::render()
 {
     //TODO: setup camera or MVP
     _isRendering = true;
+    double phaseStartTime = _frameTimingEnabled ? getTimeInMilliseconds() : 0;
+    if (_gpuTimingActive)
+        _commandBuffer->beginGPUTimer(GPU_TIMER_FRAME);
 //    if (_glViewAssigned)
     {
         //Process render commands
@@ -367,9 +551,26 @@ void Renderer::render()
         for (auto &renderqueue : _renderGroups)
         {
             renderqueue.sort();
+            if (_batchReorderingEnabled)
+            {
+                reorderBatchableCommands(renderqueue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_NEG));
+                reorderBatchableCommands(renderqueue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_ZERO));
+                reorderBatchableCommands(renderqueue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_POS));
+            }
+        }
+        if (_frameTimingEnabled)
+        {
+            double sortEndTime = getTimeInMilliseconds();
+            _currentFrameTimings.sortTime += sortEndTime - phaseStartTime;
+            phaseStartTime = sortEndTime;
         }
         visitRenderQueue(_renderGroups[0]);
     }
+    if (_gpuTimingActive)
+        _commandBuffer->endGPUTimer(GPU_TIMER_FRAME);
+    // uploads are subtracted when the frame ends
+    if (_frameTimingEnabled)
+        _currentFrameTimings.drawTime += getTimeInMilliseconds() - phaseStartTime;
     clean();
     _isRendering = false;
 }
@@ -377,12 +578,20 @@ void Renderer::render()
 void Renderer::beginFrame()
 {
     _commandBuffer->beginFrame();
+
+    _currentFrameTimings = FrameTimings();
+    _currentFrameTimings.frame = _frameCount++;
+    _gpuTimingActive = _frameTimingEnabled && _commandBuffer->isGPUTimerSupported();
+    _gpuGroupTimingDepth = 0;
 }
 
 void Renderer::endFrame()
 {
     _commandBuffer->endFrame();
 
+    if (_frameTimingEnabled)
+        finishFrameTimings();
+
 #ifdef CC_USE_METAL
     _triangleCommandBufferManager.putbackAllBuffers();
     _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
@@ -390,6 +599,190 @@ void Renderer::endFrame()
 #endif
     _queuedTotalIndexCount = 0;
     _queuedTotalVertexCount = 0;
+
+    if (_batchBufferOverflowed)
+    {
+        _batchBufferOverflowed = false;
+        unsigned int maxVertexCapacity = maxBatchVertexCapacity();
+        unsigned int maxIndexCapacity = maxBatchIndexCapacity();
+        if (_batchVertexCapacity < maxVertexCapacity || _batchIndexCapacity < maxIndexCapacity)
+            growBatchBuffers(std::min(_batchVertexCapacity * 2, maxVertexCapacity), std::min(_batchIndexCapacity * 2, maxIndexCapacity));
+    }
+}
+
+void Renderer::setFrameTimingEnabled(bool enabled)
+{
+    if (enabled && !_frameTimingEnabled)
+    {
+        FrameTimings unrecorded;
+        unrecorded.frame = INVALID_TIMED_FRAME;
+        _frameTimingsHistory.fill(unrecorded);
+    }
+    _frameTimingEnabled = enabled;
+}
+
+bool Renderer::isGPUTimingSupported() const
+{
+    return _commandBuffer->isGPUTimerSupported();
+}
+
+void Renderer::getFrameTimings(std::vector<FrameTimings>& timings) const
+{
+    timings.clear();
+    for (const auto& entry : _frameTimingsHistory)
+    {
+        if (entry.frame != INVALID_TIMED_FRAME)
+            timings.push_back(entry);
+    }
+    std::sort(timings.begin(), timings.end(), [](const FrameTimings& a, const FrameTimings& b) {
+        return a.frame < b.frame;
+    });
+}
+
+Renderer::FrameTimings Renderer::getAverageFrameTimings() const
+{
+    FrameTimings average;
+    average.gpuTime = average.gpuGroupTime = average.gpuClearTime = 0;
+
+    unsigned int frames = 0;
+    unsigned int gpuFrames = 0;
+    double drawnBatches = 0;
+    double drawnVertices = 0;
+    for (const auto& entry : _frameTimingsHistory)
+    {
+        if (entry.frame == INVALID_TIMED_FRAME)
+            continue;
+
+        ++frames;
+        average.frame = std::max(average.frame, entry.frame);
+        average.visitTime += entry.visitTime;
+        average.sortTime += entry.sortTime;
+        average.uploadTime += entry.uploadTime;
+        average.drawTime += entry.drawTime;
+        drawnBatches += entry.drawnBatches;
+        drawnVertices += entry.drawnVertices;
+
+        if (entry.gpuTime >= 0)
+        {
+            ++gpuFrames;
+            average.gpuTime += entry.gpuTime;
+            average.gpuGroupTime += std::max(entry.gpuGroupTime, 0.0);
+            average.gpuClearTime += std::max(entry.gpuClearTime, 0.0);
+        }
+    }
+
+    if (frames > 0)
+    {
+        average.visitTime /= frames;
+        average.sortTime /= frames;
+        average.uploadTime /= frames;
+        average.drawTime /= frames;
+        average.drawnBatches = (unsigned int)(drawnBatches / frames + 0.5);
+        average.drawnVertices = (unsigned int)(drawnVertices / frames + 0.5);
+    }
+    if (gpuFrames > 0)
+    {
+        average.gpuTime /= gpuFrames;
+        average.gpuGroupTime /= gpuFrames;
+        average.gpuClearTime /= gpuFrames;
+    }
+    else
+    {
+        average.gpuTime = average.gpuGroupTime = average.gpuClearTime = -1;
+    }
+    return average;
+}
+
+void Renderer::beginVisitTiming()
+{
+    if (_frameTimingEnabled)
+        _visitStartTime = getTimeInMilliseconds();
+}
+
+void Renderer::endVisitTiming()
+{
+    if (_frameTimingEnabled)
+        _currentFrameTimings.visitTime += getTimeInMilliseconds() - _visitStartTime;
+}
+
+void Renderer::finishFrameTimings()
+{
+    auto& timings = _currentFrameTimings;
+    timings.drawTime = std::max(timings.drawTime - timings.uploadTime, 0.0);
+    timings.drawnBatches = _drawnBatches;
+    timings.drawnVertices = _drawnVertices;
+    _frameTimingsHistory[timings.frame % FRAME_TIMINGS_HISTORY] = timings;
+
+    // GPU times arrive a few frames late, fill them into the frames they belong to
+    uint64_t frame = 0;
+    double gpuTimes[backend::CommandBuffer::MAX_GPU_TIMERS];
+    while (_commandBuffer->popGPUTimerResults(frame, gpuTimes))
+    {
+        auto& entry = _frameTimingsHistory[frame % FRAME_TIMINGS_HISTORY];
+        if (entry.frame != frame)
+            continue;
+        entry.gpuTime = gpuTimes[GPU_TIMER_FRAME];
+        entry.gpuGroupTime = gpuTimes[GPU_TIMER_GROUP];
+        entry.gpuClearTime = gpuTimes[GPU_TIMER_CLEAR];
+    }
+}
+
+void Renderer::setBatchBufferCapacity(unsigned int vertexCount, unsigned int indexCount)
+{
+    CCASSERT(!_isRendering, "Cannot resize the batch buffers while rendering");
+    CCASSERT(vertexCount > 0 && indexCount > 0, "Invalid batch buffer capacity");
+    CCASSERT(supportsUIntIndices() || vertexCount <= VBO_SIZE, "32 bits indices are not supported, the vertex capacity can't exceed VBO_SIZE");
+
+    if (!supportsUIntIndices())
+        vertexCount = std::min(vertexCount, (unsigned int)VBO_SIZE);
+
+    // buffers are created in init()
+    if (!_vertexBuffer)
+    {
+        _batchVertexCapacity = vertexCount;
+        _batchIndexCapacity = indexCount;
+        return;
+    }
+
+    flushTriangles();
+    _queuedTotalIndexCount = _queuedTotalVertexCount = 0;
+    resizeBatchBuffers(vertexCount, indexCount);
+}
+
+void Renderer::growBatchBuffers(unsigned int vertexCount, unsigned int indexCount)
+{
+    unsigned int newVertexCapacity = std::max(_batchVertexCapacity, nextPowerOfTwo(vertexCount));
+    unsigned int newIndexCapacity = std::max(_batchIndexCapacity, nextPowerOfTwo(indexCount));
+
+    // rebased 16 bits indices can't address more vertices, a single command always fits since its own indices are 16 bits
+    if (!supportsUIntIndices())
+    {
+        newVertexCapacity = std::min(newVertexCapacity, (unsigned int)VBO_SIZE);
+        newIndexCapacity = std::min(newIndexCapacity, std::max(_batchIndexCapacity, std::max(indexCount, (unsigned int)INDEX_VBO_SIZE)));
+    }
+
+    if (newVertexCapacity == _batchVertexCapacity && newIndexCapacity == _batchIndexCapacity)
+        return;
+
+    CCLOG("cocos2d: Renderer: growing batch buffers to %u vertices, %u indices", newVertexCapacity, newIndexCapacity);
+    resizeBatchBuffers(newVertexCapacity, newIndexCapacity);
+}
+
+void Renderer::resizeBatchBuffers(unsigned int vertexCount, unsigned int indexCount)
+{
+    _batchVertexCapacity = vertexCount;
+    _batchIndexCapacity = indexCount;
+    _batchIndexFormat = vertexCount > 65536 && supportsUIntIndices() ? backend::IndexFormat::U_INT : backend::IndexFormat::U_SHORT;
+
+    size_t indexSize = backend::IndexFormat::U_INT == _batchIndexFormat ? sizeof(unsigned int) : sizeof(unsigned short);
+    _triangleCommandBufferManager.setBufferSize(vertexCount * sizeof(V3F_C4B_T2F), indexCount * indexSize);
+    _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
+    _indexBuffer = _triangleCommandBufferManager.getIndexBuffer();
+
+#ifdef CC_USE_METAL
+    _verts.resize(vertexCount);
+    _indices.resize((indexCount * indexSize + sizeof(unsigned int) - 1) / sizeof(unsigned int));
+#endif
 }
 
 void Renderer::clean()
@@ -407,6 +800,22 @@ void Renderer::clean()
 
     // Clear batch commands
     _queuedTriangleCommands.clear();
+
+    // Destroy the transient commands of the frame after they have been executed
+    _frameArena.reset();
+}
+
+void* Renderer::allocateTransientMemory(size_t size, size_t alignment)
+{
+    CCASSERT(!isRecordingCommands(), "The frame arena can only be used on the main thread");
+    return _frameArena.allocate(size, alignment);
+}
+
+backend::ProgramState* Renderer::cloneTransientProgramState(const backend::ProgramState* programState)
+{
+    void* memory = allocateTransientMemory(sizeof(backend::ProgramState), alignof(backend::ProgramState));
+    char* uniformStorage = allocateTransientArray<char>(programState->getUniformStorageSize());
+    return _frameArena.adopt(programState->clone(memory, uniformStorage));
 }
 
 void Renderer::setDepthTest(bool value)
@@ -525,42 +934,113 @@ void Renderer::setViewPort(int x, int y, unsigned int w, unsigned int h)
     _viewport.h = h;
 }
 
-void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset)
+void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset, V3F_C4B_T2F* verts, void* indices)
 {
-    size_t vertexCount = cmd->getVertexCount();
-    memcpy(&_verts[_filledVertex], cmd->getVertices(), sizeof(V3F_C4B_T2F) * vertexCount);
-    
     // fill vertex, and convert them to world coordinates
-    const Mat4& modelView = cmd->getModelView();
-    for (size_t i=0; i < vertexCount; ++i)
-    {
-        modelView.transformPoint(&(_verts[i + _filledVertex].vertices));
-    }
+    // the destination may be write-combined GPU memory, so every vertex is written once and never read back
+    size_t vertexCount = cmd->getVertexCount();
+    MathUtil::transformVertices(verts + _filledVertex, cmd->getVertices(), vertexCount, cmd->getModelView());
     
     // fill index
-    const unsigned short* indices = cmd->getIndices();
     size_t indexCount = cmd->getIndexCount();
-    for (size_t i = 0; i < indexCount; ++i)
-    {
-        _indices[_filledIndex + i] = vertexBufferOffset + _filledVertex + indices[i];
-    }
+    if (backend::IndexFormat::U_INT == _batchIndexFormat)
+        MathUtil::transformIndices(static_cast<unsigned int*>(indices) + _filledIndex, cmd->getIndices(), indexCount, vertexBufferOffset + _filledVertex);
+    else
+        MathUtil::transformIndices(static_cast<unsigned short*>(indices) + _filledIndex, cmd->getIndices(), indexCount, (unsigned short)(vertexBufferOffset + _filledVertex));
     
     _filledVertex += vertexCount;
     _filledIndex += indexCount;
 }
 
+void Renderer::reorderBatchableCommands(std::vector<RenderCommand*>& commands)
+{
+    // how far back a command may move, keeps the pass linear for long runs of unrelated materials
+    static const int MAX_LOOKBACK = 32;
+
+    size_t count = commands.size();
+    size_t begin = 0;
+    while (begin < count)
+    {
+        if (!isReorderableCommand(commands[begin]))
+        {
+            ++begin;
+            continue;
+        }
+
+        // a run of batchable commands sharing one global Z
+        float globalOrder = commands[begin]->getGlobalOrder();
+        size_t end = begin + 1;
+        while (end < count && isReorderableCommand(commands[end]) && commands[end]->getGlobalOrder() == globalOrder)
+            ++end;
+
+        if (end - begin > 2)
+        {
+            _reorderEntries.clear();
+            int batchesBefore = 0;
+            uint32_t prevMaterialID = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto cmd = static_cast<TrianglesCommand*>(commands[i]);
+                if (i == begin || cmd->getMaterialID() != prevMaterialID)
+                    ++batchesBefore;
+                prevMaterialID = cmd->getMaterialID();
+
+                ReorderEntry entry;
+                entry.cmd = cmd;
+                entry.bounds = computeWorldBounds(cmd);
+
+                // move the command right behind the nearest one with the same material,
+                // unless it would be drawn before a command it overlaps
+                size_t insertPos = _reorderEntries.size();
+                for (int j = (int)_reorderEntries.size() - 1, last = std::max(0, j - MAX_LOOKBACK); j >= last; --j)
+                {
+                    if (_reorderEntries[j].cmd->getMaterialID() == cmd->getMaterialID())
+                    {
+                        insertPos = j + 1;
+                        break;
+                    }
+                    if (_reorderEntries[j].bounds.intersectsRect(entry.bounds))
+                        break;
+                }
+                _reorderEntries.insert(_reorderEntries.begin() + insertPos, entry);
+            }
+
+            int batchesAfter = 0;
+            for (size_t i = 0; i < _reorderEntries.size(); ++i)
+            {
+                if (i == 0 || _reorderEntries[i].cmd->getMaterialID() != _reorderEntries[i - 1].cmd->getMaterialID())
+                    ++batchesAfter;
+                commands[begin + i] = _reorderEntries[i].cmd;
+            }
+            _reorderSavedBatches += batchesBefore - batchesAfter;
+        }
+
+        begin = end;
+    }
+}
+
 void Renderer::drawBatchedTriangles()
 {
     if(_queuedTriangleCommands.empty())
         return;
     
     /************** 1: Setup up vertices/indices *************/
+    double uploadStartTime = _frameTimingEnabled ? getTimeInMilliseconds() : 0;
+    const size_t indexSize = backend::IndexFormat::U_INT == _batchIndexFormat ? sizeof(unsigned int) : sizeof(unsigned short);
 #ifdef CC_USE_METAL
     unsigned int vertexBufferFillOffset = _queuedTotalVertexCount - _queuedVertexCount;
     unsigned int indexBufferFillOffset = _queuedTotalIndexCount - _queuedIndexCount;
+    V3F_C4B_T2F* verts = _verts.data();
+    void* indices = _indices.data();
 #else
-    unsigned int vertexBufferFillOffset = 0;
-    unsigned int indexBufferFillOffset = 0;
+    // write straight into a ring range of the GL buffers instead of re-specifying them on every flush
+    std::size_t vertexByteOffset = 0;
+    std::size_t indexByteOffset = 0;
+    auto verts = static_cast<V3F_C4B_T2F*>(_vertexBuffer->reserveStreamRange(_queuedVertexCount * sizeof(V3F_C4B_T2F), sizeof(V3F_C4B_T2F), vertexByteOffset));
+    auto indices = _indexBuffer->reserveStreamRange(_queuedIndexCount * indexSize, indexSize, indexByteOffset);
+    CCASSERT(verts && indices, "triangle command buffers should support streaming");
+    unsigned int vertexBufferFillOffset = (unsigned int)(vertexByteOffset / sizeof(V3F_C4B_T2F));
+    unsigned int indexBufferFillOffset = (unsigned int)(indexByteOffset / indexSize);
 #endif
 
     _triBatchesToDraw[0].offset = indexBufferFillOffset;
@@ -579,7 +1059,7 @@ void Renderer::drawBatchedTriangles()
         auto currentMaterialID = cmd->getMaterialID();
         const bool batchable = !cmd->isSkipBatching();
         
-        fillVerticesAndIndices(cmd, vertexBufferFillOffset);
+        fillVerticesAndIndices(cmd, vertexBufferFillOffset, verts, indices);
         
         // in the same batch ?
         if (batchable && (prevMaterialID == currentMaterialID || firstCommand))
@@ -618,12 +1098,14 @@ void Renderer::drawBatchedTriangles()
     }
     batchesTotal++;
 #ifdef CC_USE_METAL
-    _vertexBuffer->updateSubData(_verts, vertexBufferFillOffset * sizeof(_verts[0]), _filledVertex * sizeof(_verts[0]));
-    _indexBuffer->updateSubData(_indices, indexBufferFillOffset * sizeof(_indices[0]), _filledIndex * sizeof(_indices[0]));
+    _vertexBuffer->updateSubData(verts, vertexBufferFillOffset * sizeof(V3F_C4B_T2F), _filledVertex * sizeof(V3F_C4B_T2F));
+    _indexBuffer->updateSubData(indices, indexBufferFillOffset * indexSize, _filledIndex * indexSize);
 #else
-    _vertexBuffer->updateData(_verts, _filledVertex * sizeof(_verts[0]));
-    _indexBuffer->updateData(_indices,  _filledIndex * sizeof(_indices[0]));
+    _vertexBuffer->commitStreamRange(_filledVertex * sizeof(V3F_C4B_T2F));
+    _indexBuffer->commitStreamRange(_filledIndex * indexSize);
 #endif
+    if (_frameTimingEnabled)
+        _currentFrameTimings.uploadTime += getTimeInMilliseconds() - uploadStartTime;
 
     /************** 2: Draw *************/
     for (int i = 0; i < batchesTotal; ++i)
@@ -634,9 +1116,9 @@ void Renderer::drawBatchedTriangles()
         auto& pipelineDescriptor = _triBatchesToDraw[i].cmd->getPipelineDescriptor();
         _commandBuffer->setProgramState(pipelineDescriptor.programState);
         _commandBuffer->drawElements(backend::PrimitiveType::TRIANGLE,
-                                     backend::IndexFormat::U_SHORT,
+                                     _batchIndexFormat,
                                      _triBatchesToDraw[i].indicesToDraw,
-                                     _triBatchesToDraw[i].offset * sizeof(_indices[0]));
+                                     _triBatchesToDraw[i].offset * indexSize);
         _commandBuffer->endRenderPass();
 
         _drawnBatches++;
@@ -646,10 +1128,8 @@ void Renderer::drawBatchedTriangles()
     /************** 3: Cleanup *************/
     _queuedTriangleCommands.clear();
 
-#ifdef CC_USE_METAL
     _queuedIndexCount = 0;
     _queuedVertexCount = 0;
-#endif
 }
 
 void Renderer::drawCustomCommand(RenderCommand *command)
@@ -833,9 +1313,21 @@ void Renderer::clear(ClearFlag flags, const Color4F& color, float depth, unsigne
 {
     _clearFlag = flags;
 
-    CallbackCommand* command = new CallbackCommand();
+    // keep the captures small enough for std::function to store them without allocating
+    struct ClearParams
+    {
+        ClearFlag flags;
+        Color4F color;
+        float depth;
+        unsigned int stencil;
+    };
+    auto params = new (allocateTransientArray<ClearParams>(1)) ClearParams{flags, color, depth, stencil};
+
+    auto command = createTransientCommand<CallbackCommand>();
     command->init(globalOrder);
-    command->func = [=]() -> void {
+    command->func = [this, params]() -> void {
+        const ClearFlag flags = params->flags;
+        const Color4F& color = params->color;
         backend::RenderPassDescriptor descriptor;
 
         if (flags & ClearFlag::COLOR)
@@ -848,23 +1340,25 @@ void Renderer::clear(ClearFlag flags, const Color4F& color, float depth, unsigne
         }
         if (flags & ClearFlag::DEPTH)
         {
-            descriptor.clearDepthValue = depth;
+            descriptor.clearDepthValue = params->depth;
             descriptor.needClearDepth = true;
             descriptor.depthTestEnabled = true;
             descriptor.depthAttachmentTexture = _renderPassDescriptor.depthAttachmentTexture;
         }
         if (flags & ClearFlag::STENCIL)
         {
-            descriptor.clearStencilValue = stencil;
+            descriptor.clearStencilValue = params->stencil;
             descriptor.needClearStencil = true;
             descriptor.stencilTestEnabled = true;
             descriptor.stencilAttachmentTexture = _renderPassDescriptor.stencilAttachmentTexture;
         }
 
+        if (_gpuTimingActive)
+            _commandBuffer->beginGPUTimer(GPU_TIMER_CLEAR);
         _commandBuffer->beginRenderPass(descriptor);
         _commandBuffer->endRenderPass();
-
-        delete command;
+        if (_gpuTimingActive)
+            _commandBuffer->endGPUTimer(GPU_TIMER_CLEAR);
     };
     addCommand(command);
 }
@@ -934,16 +1428,28 @@ void Renderer::setScissorRect(float x, float y, float width, float height)
 
 // TriangleCommandBufferManager
 Renderer::TriangleCommandBufferManager::~TriangleCommandBufferManager()
+{
+    releaseBuffers();
+}
+
+void Renderer::TriangleCommandBufferManager::releaseBuffers()
 {
     for (auto& vertexBuffer : _vertexBufferPool)
         vertexBuffer->release();
+    _vertexBufferPool.clear();
 
     for (auto& indexBuffer : _indexBufferPool)
         indexBuffer->release();
+    _indexBufferPool.clear();
+
+    _currentBufferIndex = 0;
 }
 
-void Renderer::TriangleCommandBufferManager::init()
+void Renderer::TriangleCommandBufferManager::setBufferSize(std::size_t vertexBufferSize, std::size_t indexBufferSize)
 {
+    releaseBuffers();
+    _vertexBufferSize = vertexBufferSize;
+    _indexBufferSize = indexBufferSize;
     createBuffer();
 }
 
@@ -980,39 +1486,28 @@ void Renderer::TriangleCommandBufferManager::createBuffer()
 
 #ifdef CC_USE_METAL
     // Metal doesn't need to update buffer to make sure it has the correct size.
-    auto vertexBuffer = device->newBuffer(Renderer::VBO_SIZE * sizeof(_verts[0]), backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
+    auto vertexBuffer = device->newBuffer(_vertexBufferSize, backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
     if (!vertexBuffer)
         return;
 
-    auto indexBuffer = device->newBuffer(Renderer::INDEX_VBO_SIZE * sizeof(_indices[0]), backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
+    auto indexBuffer = device->newBuffer(_indexBufferSize, backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
     if (!indexBuffer)
     {
         vertexBuffer->release();
         return;
     }
 #else
-    auto tmpData = malloc(Renderer::VBO_SIZE * sizeof(V3F_C4B_T2F));
-    if (!tmpData)
-        return;
-
-    auto vertexBuffer = device->newBuffer(Renderer::VBO_SIZE * sizeof(V3F_C4B_T2F), backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
+    // GL buffers allocate their storage on the first reserveStreamRange().
+    auto vertexBuffer = device->newBuffer(_vertexBufferSize, backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
     if (!vertexBuffer)
-    {
-        free(tmpData);
         return;
-    }
-    vertexBuffer->updateData(tmpData, Renderer::VBO_SIZE * sizeof(V3F_C4B_T2F));
 
-    auto indexBuffer = device->newBuffer(Renderer::INDEX_VBO_SIZE * sizeof(unsigned short), backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
+    auto indexBuffer = device->newBuffer(_indexBufferSize, backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
     if (! indexBuffer)
     {
-        free(tmpData);
         vertexBuffer->release();
         return;
     }
-    indexBuffer->updateData(tmpData, Renderer::INDEX_VBO_SIZE * sizeof(unsigned short));
-
-    free(tmpData);
 #endif
 
     _vertexBufferPool.push_back(vertexBuffer);
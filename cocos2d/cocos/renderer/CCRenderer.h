@@ -31,6 +31,7 @@
 
 #include "platform/CCPlatformMacros.h"
 #include "renderer/CCRenderCommand.h"
+#include "renderer/CCRenderFrameArena.h"
 #include "renderer/backend/Types.h"
 
 /**
@@ -49,6 +50,7 @@ namespace backend
     class CommandBuffer;
     class RenderPipeline;
     class RenderPass;
+    class ProgramState;
     struct RenderPipelineDescriptor;
 }
 
@@ -57,6 +59,7 @@ class TrianglesCommand;
 class MeshCommand;
 class GroupCommand;
 class CallbackCommand;
+class InstancedCommand;
 struct PipelineDescriptor;
 class Texture2D;
 
@@ -129,10 +132,16 @@ class CC_DLL Renderer
 {
 public:
     
-    /**The max number of vertices in a vertex buffer object.*/
+    /**The initial number of vertices in the vertex buffer used to batch triangles.*/
     static const int VBO_SIZE = 65536;
-    /**The max number of indices in a index buffer.*/
+    /**The initial number of indices in the index buffer used to batch triangles.*/
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
+    /**The number of vertices the batch buffers grow to at most when a frame had to flush because they were full.*/
+    static const int MAX_GROWN_VBO_SIZE = VBO_SIZE * 16;
+    /**The initial number of instances the instance buffer used by `InstancedCommand` can hold.*/
+    static const int INSTANCE_VBO_SIZE = 4096;
+    /**The number of frames kept by the frame timings history.*/
+    static const int FRAME_TIMINGS_HISTORY = 120;
     /**The rendercommands which can be batched will be saved into a list, this is the reserved size of this list.*/
     static const int BATCH_TRIAGCOMMAND_RESERVED_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
@@ -151,6 +160,13 @@ public:
     /** Adds a `RenderComamnd` into the renderer specifying a particular render queue ID */
     void addCommand(RenderCommand* command, int renderQueueID);
 
+    /**
+     Redirects `addCommand(RenderCommand*)` calls made on the calling thread into the given list
+     instead of the current render queue. Used while visiting subtrees in parallel, the list is
+     added to the renderer on the main thread afterwards. Pass nullptr to stop recording.
+     */
+    static void setCommandRecorder(std::vector<RenderCommand*>* recorder);
+
     /** Pushes a group into the render queue */
     void pushGroup(int renderQueueID);
 
@@ -163,9 +179,47 @@ public:
     /** Renders into the GLView all the queued `RenderCommand` objects */
     void render();
 
-    /** Cleans all `RenderCommand`s in the queue */
+    /** Cleans all `RenderCommand`s in the queue and releases the transient allocations of the frame */
     void clean();
 
+    /**
+     Constructs a render command, or any other object, in the frame arena. It is destroyed by the next
+     `clean()`, i.e. at the end of the frame it is rendered in, so it must not be deleted by the caller.
+     Use it for commands that are created every frame instead of being embedded in a node.
+     Must be called on the main thread, not while recording commands.
+     */
+    template <typename T, typename... Args>
+    T* createTransientCommand(Args&&... args)
+    {
+        CCASSERT(!isRecordingCommands(), "The frame arena can only be used on the main thread");
+        return _frameArena.construct<T>(std::forward<Args>(args)...);
+    }
+
+    /**
+     Allocates scratch memory in the frame arena, such as the vertices of a transient command.
+     It stays valid until the next `clean()`.
+     */
+    void* allocateTransientMemory(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /** Allocates an uninitialized array of trivially destructible elements in the frame arena. */
+    template <typename T>
+    T* allocateTransientArray(size_t count)
+    {
+        return static_cast<T*>(allocateTransientMemory(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     Copies a program state into the frame arena, uniforms included, so that a transient command can
+     change its uniforms without affecting the original. The copy is destroyed by the next `clean()`
+     and must not be retained or released.
+     */
+    backend::ProgramState* cloneTransientProgramState(const backend::ProgramState* programState);
+
+    /* returns the number of bytes allocated from the frame arena since the last clean */
+    size_t getTransientMemoryUsed() const { return _frameArena.getUsedBytes(); }
+    /* returns the capacity of the frame arena */
+    size_t getTransientMemoryCapacity() const { return _frameArena.getCapacity(); }
+
     /* returns the number of drawn batches in the last frame */
     ssize_t getDrawnBatches() const { return _drawnBatches; }
     /* RenderCommands (except) TrianglesCommand should update this value */
@@ -175,7 +229,76 @@ public:
     /* RenderCommands (except) TrianglesCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats() { _drawnBatches = _drawnVertices = _reorderSavedBatches = 0; }
+
+    /**
+     Enable or disable reordering of batchable `TrianglesCommand`s. When enabled, consecutive commands
+     with the same global Z are grouped by material ID, as long as no command moves past another one
+     whose bounding box it overlaps. Disabled by default.
+     */
+    void setBatchReorderingEnabled(bool enabled) { _batchReorderingEnabled = enabled; }
+    /** Whether batchable `TrianglesCommand`s are reordered by material ID. */
+    bool isBatchReorderingEnabled() const { return _batchReorderingEnabled; }
+    /* returns the number of batches saved by reordering in the last frame */
+    ssize_t getReorderSavedBatches() const { return _reorderSavedBatches; }
+
+    /**
+     Set the number of vertices and indices the buffers used to batch `TrianglesCommand`s can hold.
+     The buffers also grow on demand: right away when a single command doesn't fit, and for the next frame
+     (up to `MAX_GROWN_VBO_SIZE` vertices) when a frame had to flush because they were full.
+     Indices switch to 32 bits once more than 65536 vertices are batched, if the device supports it.
+     Otherwise the vertex capacity is limited to `VBO_SIZE`, and the buffers grow no further than
+     `VBO_SIZE` vertices and `INDEX_VBO_SIZE` indices, unless a single command needs more indices.
+     */
+    void setBatchBufferCapacity(unsigned int vertexCount, unsigned int indexCount);
+    /** Get the number of vertices the batch vertex buffer can hold. */
+    unsigned int getBatchVertexCapacity() const { return _batchVertexCapacity; }
+    /** Get the number of indices the batch index buffer can hold. */
+    unsigned int getBatchIndexCapacity() const { return _batchIndexCapacity; }
+    /** Get the format of the batched indices. */
+    backend::IndexFormat getBatchIndexFormat() const { return _batchIndexFormat; }
+
+    /**
+     Where the time of a frame went, see `setFrameTimingEnabled()`. Times are in milliseconds.
+     GPU times are negative until the results of the timer queries come back, usually a few frames later,
+     and stay negative when the backend has no GPU timers or could not measure them.
+     */
+    struct FrameTimings
+    {
+        /**The index of the frame, counted in calls to `beginFrame()`.*/
+        uint64_t frame = 0;
+        /**CPU: visiting the scene, i.e. updating transforms and generating render commands.*/
+        double visitTime = 0;
+        /**CPU: sorting and reordering the render queues.*/
+        double sortTime = 0;
+        /**CPU: filling the batched vertices and indices into the GPU buffers.*/
+        double uploadTime = 0;
+        /**CPU: executing the render commands and issuing the draw calls, uploads excluded.*/
+        double drawTime = 0;
+        /**GPU: everything rendered by `render()`.*/
+        double gpuTime = -1;
+        /**GPU: the group commands, i.e. the render textures and other render targets.*/
+        double gpuGroupTime = -1;
+        /**GPU: the clear passes, including the ones of render targets.*/
+        double gpuClearTime = -1;
+        unsigned int drawnBatches = 0;
+        unsigned int drawnVertices = 0;
+    };
+
+    /**
+     Enable or disable the frame timings. The CPU phases of a frame are measured with a steady clock and,
+     if the backend supports it, the GPU time of the frame, of the group commands and of the clear passes
+     with timer queries. Disabled by default. Enabling it clears the history.
+     */
+    void setFrameTimingEnabled(bool enabled);
+    /** Whether the frame timings are measured. */
+    bool isFrameTimingEnabled() const { return _frameTimingEnabled; }
+    /** Whether the backend can measure GPU times. */
+    bool isGPUTimingSupported() const;
+    /** Get the timings of the last `FRAME_TIMINGS_HISTORY` frames at most, oldest first. */
+    void getFrameTimings(std::vector<FrameTimings>& timings) const;
+    /** Get the average timings of the frames in the history, GPU times are averaged over the frames that have them. */
+    FrameTimings getAverageFrameTimings() const;
 
     /**
      Set render targets. If not set, will use default render targets. It will effect all commands.
@@ -409,6 +532,13 @@ protected:
     friend class Director;
     friend class GroupCommand;
 
+    static bool isRecordingCommands();
+
+    // called by Director around the scene traversal, for the frame timings
+    void beginVisitTiming();
+    void endVisitTiming();
+    void finishFrameTimings();
+
     /**
      * Create and reuse vertex and index buffer for triangleCommand.
      * When queued vertex or index count exceed the limited value, a new vertex or index buffer will be created.
@@ -418,12 +548,6 @@ protected:
     public:
         ~TriangleCommandBufferManager();
 
-        /**
-         * Create a new vertex buffer and a index buffer and push it to cache.
-         * @note Should invoke firstly.
-         */
-        void init();
-
         /**
          * Reset avalable buffer index to zero.
          * That means when get vertex buffer or index buffer, the earliest created buffer object in the cache will be returned.
@@ -435,13 +559,23 @@ protected:
          */
         void prepareNextBuffer();
 
+        /**
+         * Release all cached buffers and create buffers of the given sizes from now on.
+         * @param vertexBufferSize Specifies the size of the vertex buffers in bytes.
+         * @param indexBufferSize Specifies the size of the index buffers in bytes.
+         */
+        void setBufferSize(std::size_t vertexBufferSize, std::size_t indexBufferSize);
+
         backend::Buffer* getVertexBuffer() const; ///< Get the vertex buffer.
         backend::Buffer* getIndexBuffer() const; ///< Get the index buffer.
 
     private:
         void createBuffer();
+        void releaseBuffers();
 
         int _currentBufferIndex = 0;
+        std::size_t _vertexBufferSize = Renderer::VBO_SIZE * sizeof(V3F_C4B_T2F);
+        std::size_t _indexBufferSize = Renderer::INDEX_VBO_SIZE * sizeof(unsigned short);
         std::vector<backend::Buffer*> _vertexBufferPool;
         std::vector<backend::Buffer*> _indexBufferPool;
     };
@@ -450,6 +584,7 @@ protected:
     void drawBatchedTriangles();
     void drawCustomCommand(RenderCommand* command);
     void drawMeshCommand(RenderCommand* command);
+    void drawInstancedCommand(InstancedCommand* command);
     void captureScreen(RenderCommand* command);
 
     void beginFrame(); /// Indicate the begining of a frame
@@ -469,7 +604,10 @@ protected:
     void visitRenderQueue(RenderQueue& queue);
     void doVisitRenderQueue(const std::vector<RenderCommand*>&);
 
-    void fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset);
+    void fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset, V3F_C4B_T2F* verts, void* indices);
+    void resizeBatchBuffers(unsigned int vertexCount, unsigned int indexCount);
+    void growBatchBuffers(unsigned int vertexCount, unsigned int indexCount);
+    void reorderBatchableCommands(std::vector<RenderCommand*>& commands);
     void beginRenderPass(RenderCommand*); /// Begin a render pass.
     
     /**
@@ -496,12 +634,35 @@ protected:
 
     std::vector<TrianglesCommand*> _queuedTriangleCommands;
 
+    // scratch list for reordering batchable commands, commands with their world space bounds
+    struct ReorderEntry
+    {
+        TrianglesCommand* cmd = nullptr;
+        Rect bounds;
+    };
+    std::vector<ReorderEntry> _reorderEntries;
+
+    // transient commands, program states and scratch memory, reset by clean()
+    RenderFrameArena _frameArena;
+
     //for TrianglesCommand
-    V3F_C4B_T2F _verts[VBO_SIZE];
-    unsigned short _indices[INDEX_VBO_SIZE];
+#ifdef CC_USE_METAL
+    // GL fills the mapped ranges of the buffers directly
+    std::vector<V3F_C4B_T2F> _verts;
+    std::vector<unsigned int> _indices; // holds 16 or 32 bits indices, depending on _batchIndexFormat
+#endif
+    unsigned int _batchVertexCapacity = VBO_SIZE;
+    unsigned int _batchIndexCapacity = INDEX_VBO_SIZE;
+    backend::IndexFormat _batchIndexFormat = backend::IndexFormat::U_SHORT;
+    bool _batchBufferOverflowed = false;
     backend::Buffer* _vertexBuffer = nullptr;
     backend::Buffer* _indexBuffer = nullptr;
     TriangleCommandBufferManager _triangleCommandBufferManager;
+
+    //for InstancedCommand, the unit quad and a stream of instances
+    backend::Buffer* _instanceQuadVertexBuffer = nullptr;
+    backend::Buffer* _instanceQuadIndexBuffer = nullptr;
+    backend::Buffer* _instanceBuffer = nullptr;
     
     backend::CommandBuffer* _commandBuffer = nullptr;
     backend::RenderPassDescriptor _renderPassDescriptor;
@@ -529,9 +690,20 @@ protected:
     // stats
     unsigned int _drawnBatches = 0;
     unsigned int _drawnVertices = 0;
+    unsigned int _reorderSavedBatches = 0;
+
+    // frame timings, the history is indexed by frame modulo FRAME_TIMINGS_HISTORY
+    bool _frameTimingEnabled = false;
+    bool _gpuTimingActive = false;
+    unsigned int _gpuGroupTimingDepth = 0;
+    uint64_t _frameCount = 0;
+    double _visitStartTime = 0;
+    FrameTimings _currentFrameTimings;
+    std::array<FrameTimings, FRAME_TIMINGS_HISTORY> _frameTimingsHistory;
     //the flag for checking whether renderer is rendering
     bool _isRendering = false;
     bool _isDepthTestFor2D = false;
+    bool _batchReorderingEnabled = false;
         
     GroupCommandManager* _groupCommandManager = nullptr;
 
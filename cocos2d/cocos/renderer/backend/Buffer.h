@@ -70,6 +70,23 @@ public:
      */
     virtual void usingDefaultStoredData(bool needDefaultStoredData) = 0;
 
+    /**
+     * Reserve a range of the buffer for streamed data. The buffer is used as a ring: ranges are handed out one after
+     * another and wrap around to the beginning when the rest of the buffer is too small, so earlier ranges stay
+     * valid for draws that were already encoded. A streamed buffer should not be updated with `updateData()`.
+     * @param size Specifies the size in bytes of the range.
+     * @param alignment Specifies the alignment in bytes of the range offset, i.e. the vertex size.
+     * @param offset Returns the offset in bytes of the range in the buffer.
+     * @return Memory to write the range to, valid until `commitStreamRange()`. nullptr if the backend doesn't stream through buffers.
+     */
+    virtual void* reserveStreamRange(std::size_t size, std::size_t alignment, std::size_t& offset) { return nullptr; }
+
+    /**
+     * Make the range returned by the last `reserveStreamRange()` visible to the draws encoded after it.
+     * @param size Specifies the size in bytes that was written, at most the reserved size.
+     */
+    virtual void commitStreamRange(std::size_t size) {}
+
     /**
      * Get buffer size in bytes.
      * @return The buffer size in bytes.
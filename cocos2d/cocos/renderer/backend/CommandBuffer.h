@@ -135,6 +135,30 @@ public:
     */
     virtual void drawElements(PrimitiveType primitiveType, IndexFormat indexType, std::size_t count, std::size_t offset) = 0;
     
+    /**
+     * Whether `drawElementsInstanced()` is supported.
+     */
+    virtual bool isInstancingSupported() const { return false; }
+
+    /**
+     * Set the buffer the per-instance attributes of the vertex layout are read from, for the next draw only.
+     * @param buffer The buffer holding the instance data.
+     * @param offset Byte offset of the first instance within the buffer.
+     * @see `VertexLayout::setInstanceAttribute()`
+     */
+    virtual void setInstanceBuffer(Buffer* buffer, std::size_t offset) {}
+
+    /**
+     * Draw several instances of primitives with an index list, only when `isInstancingSupported()` is true.
+     * @param primitiveType The type of primitives that elements are assembled into.
+     * @param indexType The type if indexes, either 16 bit integer or 32 bit integer.
+     * @param count The number of indexes to read from the index buffer for each instance.
+     * @param offset Byte offset within indexBuffer to start reading indexes from.
+     * @param instanceCount The number of instances to draw.
+     * @see `setInstanceBuffer(Buffer* buffer, std::size_t offset)`
+     */
+    virtual void drawElementsInstanced(PrimitiveType primitiveType, IndexFormat indexType, std::size_t count, std::size_t offset, std::size_t instanceCount) {}
+
     /**
      * Do some resources release.
      */
@@ -170,6 +194,36 @@ public:
      * @param callback A callback to deal with screen snapshot image.
      */
     virtual void captureScreen(std::function<void(const unsigned char*, int, int)> callback) = 0;
+
+    /// The number of different GPU timer ids.
+    static const unsigned int MAX_GPU_TIMERS = 4;
+
+    /**
+     * Whether GPU timers are supported, see `beginGPUTimer(unsigned int id)`.
+     */
+    virtual bool isGPUTimerSupported() const { return false; }
+
+    /**
+     * Start measuring the GPU time of the commands encoded until the matching `endGPUTimer(unsigned int id)`.
+     * Timers can nest when the backend has timestamps, otherwise only the outermost timer is measured.
+     * @param id Identifies what is measured, less than MAX_GPU_TIMERS. Times with the same id are summed per frame.
+     */
+    virtual void beginGPUTimer(unsigned int id) {}
+
+    /**
+     * Stop measuring the GPU time started by `beginGPUTimer(unsigned int id)`.
+     * @param id The id given to `beginGPUTimer(unsigned int id)`.
+     */
+    virtual void endGPUTimer(unsigned int id) {}
+
+    /**
+     * Get the GPU times of the oldest frame whose results are available, and forget them.
+     * Results are usually a few frames late, and frames whose results take too long are dropped.
+     * @param frame Receives the index of that frame, counted in calls to `beginFrame()` starting at 0.
+     * @param milliseconds Receives MAX_GPU_TIMERS times, negative for ids that were not measured in that frame.
+     * @return false if there are no new results.
+     */
+    virtual bool popGPUTimerResults(uint64_t& frame, double* milliseconds) { return false; }
     
     /**
      * Update both front and back stencil reference value.
@@ -42,7 +42,11 @@ enum class FeatureType : uint32_t
     VAO,
     MAPBUFFER,
     DEPTH24,
-    ASTC
+    ASTC,
+    MAP_BUFFER_RANGE,
+    BUFFER_STORAGE,
+    TIMER_QUERY,
+    INSTANCING
 };
 
 /**
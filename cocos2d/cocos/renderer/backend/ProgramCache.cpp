@@ -126,6 +126,7 @@ bool ProgramCache::init()
     addProgram(ProgramType::TERRAIN_3D);
     addProgram(ProgramType::PARTICLE_TEXTURE_3D);
     addProgram(ProgramType::PARTICLE_COLOR_3D);
+    addProgram(ProgramType::POSITION_TEXTURE_COLOR_INSTANCED);
     return true;
 }
 
@@ -240,6 +241,9 @@ void ProgramCache::addProgram(ProgramType type)
         case ProgramType::PARTICLE_COLOR_3D:
             program = backend::Device::getInstance()->newProgram(CC3D_particle_vert, CC3D_particleColor_frag);
             break;
+        case ProgramType::POSITION_TEXTURE_COLOR_INSTANCED:
+            program = backend::Device::getInstance()->newProgram(positionTextureColorInstanced_vert, positionTextureColor_frag);
+            break;
         default:
             CCASSERT(false, "Not built-in program type.");
             break;
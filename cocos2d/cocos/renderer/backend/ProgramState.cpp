@@ -32,6 +32,7 @@
 #include "base/CCDirector.h"
 
 #include <algorithm>
+#include <new>
 
 #ifdef CC_USE_METAL
 #include "glsl_optimizer.h"
@@ -210,8 +211,11 @@ ProgramState::ProgramState()
 ProgramState::~ProgramState()
 {
     CC_SAFE_RELEASE(_program);
-    CC_SAFE_DELETE_ARRAY(_vertexUniformBuffer);
-    CC_SAFE_DELETE_ARRAY(_fragmentUniformBuffer);
+    if (_ownsUniformBuffers)
+    {
+        CC_SAFE_DELETE_ARRAY(_vertexUniformBuffer);
+        CC_SAFE_DELETE_ARRAY(_fragmentUniformBuffer);
+    }
     
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
@@ -221,21 +225,41 @@ ProgramState::~ProgramState()
 ProgramState *ProgramState::clone() const
 {
     ProgramState *cp = new ProgramState();
+    char* fragmentUniformBuffer = nullptr;
+#ifdef CC_USE_METAL
+    fragmentUniformBuffer = new char[_fragmentUniformBufferSize];
+#endif
+    copyTo(cp, new char[_vertexUniformBufferSize], fragmentUniformBuffer);
+    return cp;
+}
+
+ProgramState *ProgramState::clone(void* memory, char* uniformStorage) const
+{
+    ProgramState *cp = new (memory) ProgramState();
+    cp->_ownsUniformBuffers = false;
+    char* fragmentUniformBuffer = nullptr;
+#ifdef CC_USE_METAL
+    fragmentUniformBuffer = uniformStorage + _vertexUniformBufferSize;
+#endif
+    copyTo(cp, uniformStorage, fragmentUniformBuffer);
+    return cp;
+}
+
+void ProgramState::copyTo(ProgramState* cp, char* vertexUniformBuffer, char* fragmentUniformBuffer) const
+{
     cp->_program = _program;
     cp->_vertexUniformBufferSize = _vertexUniformBufferSize;
     cp->_fragmentUniformBufferSize = _fragmentUniformBufferSize;
     cp->_vertexTextureInfos = _vertexTextureInfos;
     cp->_fragmentTextureInfos = _fragmentTextureInfos;
-    cp->_vertexUniformBuffer = new char[_vertexUniformBufferSize];
+    cp->_vertexUniformBuffer = vertexUniformBuffer;
     memcpy(cp->_vertexUniformBuffer, _vertexUniformBuffer, _vertexUniformBufferSize);
     cp->_vertexLayout = _vertexLayout;
 #ifdef CC_USE_METAL
-    cp->_fragmentUniformBuffer = new char[_fragmentUniformBufferSize];
+    cp->_fragmentUniformBuffer = fragmentUniformBuffer;
     memcpy(cp->_fragmentUniformBuffer, _fragmentUniformBuffer, _fragmentUniformBufferSize);
 #endif
     CC_SAFE_RETAIN(cp->_program);
-
-    return cp;
 }
 
 backend::UniformLocation ProgramState::getUniformLocation(backend::Uniform name) const
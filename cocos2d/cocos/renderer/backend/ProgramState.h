@@ -89,6 +89,20 @@ public:
      * Deep clone ProgramState
      */
     ProgramState *clone() const;
+
+    /**
+     * Deep clone ProgramState into memory owned by the caller, such as the renderer's frame arena.
+     * The uniform data is copied to uniformStorage, which must hold getUniformStorageSize() bytes.
+     * The clone does not own that memory and must be destroyed by calling its destructor, not release().
+     * @param memory Specifies the storage for the clone, at least sizeof(ProgramState) bytes.
+     * @param uniformStorage Specifies the storage for the uniform buffers.
+     */
+    ProgramState *clone(void* memory, char* uniformStorage) const;
+
+    /**
+     * Get the size of the uniform buffers, in bytes.
+     */
+    std::size_t getUniformStorageSize() const { return _vertexUniformBufferSize + _fragmentUniformBufferSize; }
     
     /**
      * Get the program object.
@@ -317,12 +331,16 @@ protected:
     */
     void applyAutoBinding(const std::string &, const std::string &);
 
+    ///Copy the program, uniforms and textures to a program state created by clone().
+    void copyTo(ProgramState* cp, char* vertexUniformBuffer, char* fragmentUniformBuffer) const;
+
     backend::Program*                                       _program = nullptr;
     std::unordered_map<UniformLocation, UniformCallback, UniformLocation>   _callbackUniforms;
     char* _vertexUniformBuffer = nullptr;
     char* _fragmentUniformBuffer = nullptr;
     std::size_t _vertexUniformBufferSize = 0;
     std::size_t _fragmentUniformBufferSize = 0;
+    bool _ownsUniformBuffers = true;
 
     std::unordered_map<int, TextureInfo>                    _vertexTextureInfos;
     std::unordered_map<int, TextureInfo>                    _fragmentTextureInfos;
@@ -362,6 +362,8 @@ enum class ProgramType : size_t
     PARTICLE_TEXTURE_3D,                    //CC3D_particle_vert,                   CC3D_particleTexture_frag
     PARTICLE_COLOR_3D,                      //CC3D_particle_vert,                   CC3D_particleColor_frag
 
+    POSITION_TEXTURE_COLOR_INSTANCED,       //positionTextureColorInstanced_vert,   positionTextureColor_frag
+
     CUSTOM_PROGRAM,                         //user-define program
 };
 
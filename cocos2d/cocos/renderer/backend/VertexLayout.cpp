@@ -25,6 +25,7 @@
 #include "VertexLayout.h"
 #include "base/ccMacros.h"
 #include <cassert>
+#include <functional>
 
 CC_BACKEND_BEGIN
 
@@ -34,11 +35,58 @@ void VertexLayout::setAttribute(const std::string &name, std::size_t index, Vert
         return;
     
     _attributes[name] = { name, index, format, offset, needToBeNormallized };
+    _hashDirty = true;
 }
 
 void VertexLayout::setLayout(std::size_t stride)
 {
     _stride = stride;
+    _hashDirty = true;
+}
+
+void VertexLayout::setInstanceAttribute(const std::string &name, std::size_t index, VertexFormat format, std::size_t offset, bool needToBeNormallized)
+{
+    if(index == -1)
+        return;
+
+    _instanceAttributes[name] = { name, index, format, offset, needToBeNormallized };
+    _hashDirty = true;
+}
+
+void VertexLayout::setInstanceLayout(std::size_t stride)
+{
+    _instanceStride = stride;
+    _hashDirty = true;
+}
+
+std::size_t VertexLayout::getHash() const
+{
+    if (!_hashDirty)
+        return _hash;
+
+    // Attributes are kept in an unordered map, so combine them with an order independent sum.
+    std::hash<std::size_t> hasher;
+    std::size_t hash = hasher(_stride) ^ (hasher(_instanceStride) * 31);
+    for (const auto& iter : _attributes)
+    {
+        const auto& attribute = iter.second;
+        std::size_t key = (attribute.index << 1) | (attribute.needToBeNormallized ? 1 : 0);
+        key = key * 31 + static_cast<std::size_t>(attribute.format);
+        key = key * 31 + attribute.offset;
+        hash += hasher(key) * 0x9E3779B1u;
+    }
+    for (const auto& iter : _instanceAttributes)
+    {
+        const auto& attribute = iter.second;
+        std::size_t key = (attribute.index << 1) | (attribute.needToBeNormallized ? 1 : 0);
+        key = key * 31 + static_cast<std::size_t>(attribute.format);
+        key = key * 31 + attribute.offset;
+        hash += hasher(key) * 0x85EBCA6Bu;
+    }
+
+    _hash = hash;
+    _hashDirty = false;
+    return _hash;
 }
 
 CC_BACKEND_END
@@ -81,6 +81,33 @@ public:
      */
     void setLayout(std::size_t stride);
     
+    /**
+     * Set a per-instance attribute, read from the instance buffer once per instance instead of once per vertex.
+     * @param name Specifies the attribute name.
+     * @param index Specifies the index of the generic vertex attribute to be modified.
+     * @param format Specifies how the attribute data is laid out in memory.
+     * @param offset Specifies the byte offset of the attribute from the start of an instance.
+     * @param needToBeNormallized Specifies whether fixed-point data values should be normalized.
+     * @see `CommandBuffer::drawElementsInstanced()`
+     */
+    void setInstanceAttribute(const std::string& name, std::size_t index, VertexFormat format, std::size_t offset, bool needToBeNormallized);
+
+    /**
+     * Set stride of instances.
+     * @param stride Specifies the distance between the data of two instances, in bytes.
+     */
+    void setInstanceLayout(std::size_t stride);
+
+    /**
+     * Get the distance between the data of two instances, in bytes.
+     */
+    inline std::size_t getInstanceStride() const { return _instanceStride; }
+
+    /**
+     * Get per-instance attribute informations
+     */
+    inline const std::unordered_map<std::string, Attribute>& getInstanceAttributes() const { return _instanceAttributes; }
+
     /**
      * Get the distance between the data of two vertices, in bytes.
      * @return The distance between the data of two vertices, in bytes.
@@ -104,10 +131,21 @@ public:
      * Check if vertex layout has been set.
      */
     inline bool isValid() const { return _stride != 0; }
+
+    /**
+     * Get a hash of the strides and the attribute indexes, formats, offsets and normalization.
+     * Layouts that describe the same vertex data have the same hash, whatever their attribute names are.
+     * @return The layout hash, computed on first use after the layout changes.
+     */
+    std::size_t getHash() const;
     
 private:
     std::unordered_map<std::string, Attribute> _attributes;
+    std::unordered_map<std::string, Attribute> _instanceAttributes;
     std::size_t _stride = 0;
+    std::size_t _instanceStride = 0;
+    mutable std::size_t _hash = 0;
+    mutable bool _hashDirty = true;
     VertexStepMode _stepMode = VertexStepMode::VERTEX;
 };
 
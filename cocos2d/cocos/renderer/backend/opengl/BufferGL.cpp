@@ -28,6 +28,9 @@
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
 #include "base/CCEventDispatcher.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/VertexArrayCacheGL.h"
+#include "renderer/backend/Device.h"
 
 CC_BACKEND_BEGIN
 
@@ -61,8 +64,14 @@ BufferGL::BufferGL(std::size_t size, BufferType type, BufferUsage usage)
 
 BufferGL::~BufferGL()
 {
+    releaseStream();
+
     if (_buffer)
+    {
+        VertexArrayCacheGL::removeBuffer(_buffer);
+        StateCacheGL::deleteBuffer(_buffer);
         glDeleteBuffers(1, &_buffer);
+    }
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     CC_SAFE_DELETE_ARRAY(_data);
@@ -82,6 +91,25 @@ void BufferGL::reloadBuffer()
 {
     glGenBuffers(1, &_buffer);
 
+    // Streamed data only lives until it is drawn, allocate a new ring on next use.
+    // The mapping and the fences died with the old context, drop them without calling GL.
+    if (_streamMode != StreamMode::NONE)
+    {
+        if (_streamMode == StreamMode::SUB_DATA)
+            CC_SAFE_DELETE_ARRAY(_streamData);
+        _streamData = nullptr;
+#if CC_GL_BUFFER_STORAGE
+        for (auto& fence : _streamFences)
+            fence = nullptr;
+#endif
+        _streamMode = StreamMode::NONE;
+        _streamHead = 0;
+        _streamReservedSize = 0;
+        _streamRegion = 0;
+        _streamFenceRegion = 0;
+        return;
+    }
+
     if(!_needDefaultStoredData)
         return;
 
@@ -107,17 +135,18 @@ void BufferGL::fillBuffer(void* data, std::size_t offset, std::size_t size)
 void BufferGL::updateData(void* data, std::size_t size)
 {
     assert(size && size <= _size);
+    assert(_streamMode == StreamMode::NONE && "streamed buffers are written with reserveStreamRange()");
     
     if (_buffer)
     {
         if (BufferType::VERTEX == _type)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+            StateCacheGL::bindBuffer(GL_ARRAY_BUFFER, _buffer);
             glBufferData(GL_ARRAY_BUFFER, size, data, toGLUsage(_usage));
         }
         else
         {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
+            StateCacheGL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, toGLUsage(_usage));
         }
         CHECK_GL_ERROR_DEBUG();
@@ -133,6 +162,7 @@ void BufferGL::updateSubData(void* data, std::size_t offset, std::size_t size)
 {
 
     CCASSERT(_bufferAllocated != 0, "updateData should be invoke before updateSubData");
+    CCASSERT(_streamMode == StreamMode::NONE, "streamed buffers are written with reserveStreamRange()");
     CCASSERT(offset + size <= _bufferAllocated, "buffer size overflow");
  
     if (_buffer)
@@ -140,12 +170,12 @@ void BufferGL::updateSubData(void* data, std::size_t offset, std::size_t size)
         CHECK_GL_ERROR_DEBUG();
         if (BufferType::VERTEX == _type)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+            StateCacheGL::bindBuffer(GL_ARRAY_BUFFER, _buffer);
             glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
         }
         else
         {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
+            StateCacheGL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
             glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
         }
 
@@ -156,4 +186,212 @@ void BufferGL::updateSubData(void* data, std::size_t offset, std::size_t size)
     }
 }
 
+GLenum BufferGL::getTarget() const
+{
+    return BufferType::VERTEX == _type ? GL_ARRAY_BUFFER : GL_ELEMENT_ARRAY_BUFFER;
+}
+
+void BufferGL::initStream()
+{
+    GLenum target = getTarget();
+    StateCacheGL::bindBuffer(target, _buffer);
+
+#if CC_GL_BUFFER_STORAGE
+    static const bool supportsBufferStorage = Device::getInstance()->getDeviceInfo()->checkForFeatureSupported(FeatureType::BUFFER_STORAGE);
+    if (supportsBufferStorage)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, _size, nullptr, flags);
+        _streamData = (char*)glMapBufferRange(target, 0, _size, flags);
+        if (_streamData)
+        {
+            _streamMode = StreamMode::PERSISTENT;
+            _bufferAllocated = _size;
+            return;
+        }
+
+        // The store is immutable now, so start over with a new buffer object.
+        VertexArrayCacheGL::removeBuffer(_buffer);
+        StateCacheGL::deleteBuffer(_buffer);
+        glDeleteBuffers(1, &_buffer);
+        glGenBuffers(1, &_buffer);
+        StateCacheGL::bindBuffer(target, _buffer);
+    }
+#endif
+
+    glBufferData(target, _size, nullptr, GL_DYNAMIC_DRAW);
+    _bufferAllocated = _size;
+
+#if CC_GL_MAP_BUFFER_RANGE
+    static const bool supportsMapBufferRange = Device::getInstance()->getDeviceInfo()->checkForFeatureSupported(FeatureType::MAP_BUFFER_RANGE);
+    if (supportsMapBufferRange)
+    {
+        _streamMode = StreamMode::MAP_RANGE;
+        return;
+    }
+#endif
+
+    if (_streamData == nullptr)
+        _streamData = new (std::nothrow) char[_size];
+    if (_streamData)
+        _streamMode = StreamMode::SUB_DATA;
+}
+
+void* BufferGL::reserveStreamRange(std::size_t size, std::size_t alignment, std::size_t& offset)
+{
+    CCASSERT(size <= _size, "stream range is larger than the buffer");
+    CCASSERT(_streamReservedSize == 0, "commitStreamRange should be invoked before reserving another range");
+
+    if (_streamMode == StreamMode::NONE)
+    {
+        initStream();
+        if (_streamMode == StreamMode::NONE)
+            return nullptr;
+    }
+
+    std::size_t start = _streamHead;
+    if (alignment > 1)
+        start = (start + alignment - 1) / alignment * alignment;
+
+    // The first range after allocating the store counts as a wrap, there is nothing to wait for and nothing to keep.
+    bool wrapped = (_streamHead == 0) || (start + size > _size);
+    if (start + size > _size)
+        start = 0;
+
+    _streamReservedOffset = start;
+    _streamReservedSize = size;
+    offset = start;
+
+    GLenum target = getTarget();
+    switch (_streamMode)
+    {
+#if CC_GL_BUFFER_STORAGE
+        case StreamMode::PERSISTENT:
+            waitStreamRegions(start, start + size, wrapped && _streamHead != 0);
+            return _streamData + start;
+#endif
+#if CC_GL_MAP_BUFFER_RANGE
+        case StreamMode::MAP_RANGE:
+        {
+            // Orphan the whole store when wrapping, the ranges written since then are never read by queued draws.
+            GLbitfield access = GL_MAP_WRITE_BIT | (wrapped ? GL_MAP_INVALIDATE_BUFFER_BIT : (GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+            StateCacheGL::bindBuffer(target, _buffer);
+            void* data = glMapBufferRange(target, start, size, access);
+            if (data)
+                return data;
+
+            // Mapping failed, keep streaming through a CPU copy from now on.
+            _streamData = new (std::nothrow) char[_size];
+            if (!_streamData)
+            {
+                _streamReservedSize = 0;
+                return nullptr;
+            }
+            _streamMode = StreamMode::SUB_DATA;
+        }
+#endif
+        // fall through
+        case StreamMode::SUB_DATA:
+        default:
+            if (wrapped)
+            {
+                StateCacheGL::bindBuffer(target, _buffer);
+                glBufferData(target, _size, nullptr, GL_DYNAMIC_DRAW);
+            }
+            return _streamData + start;
+    }
+}
+
+void BufferGL::commitStreamRange(std::size_t size)
+{
+    CCASSERT(size <= _streamReservedSize, "committed more than the reserved range");
+
+    GLenum target = getTarget();
+    switch (_streamMode)
+    {
+#if CC_GL_MAP_BUFFER_RANGE
+        case StreamMode::MAP_RANGE:
+            StateCacheGL::bindBuffer(target, _buffer);
+            glUnmapBuffer(target);
+            break;
+#endif
+        case StreamMode::SUB_DATA:
+            if (size > 0)
+            {
+                StateCacheGL::bindBuffer(target, _buffer);
+                glBufferSubData(target, _streamReservedOffset, size, _streamData + _streamReservedOffset);
+            }
+            break;
+        default:
+            // The persistent mapping is coherent, written data is visible to the following draws.
+            break;
+    }
+    CHECK_GL_ERROR_DEBUG();
+
+    _streamHead = _streamReservedOffset + size;
+    _streamReservedSize = 0;
+}
+
+void BufferGL::waitStreamRegions(std::size_t start, std::size_t end, bool wrapped)
+{
+#if CC_GL_BUFFER_STORAGE
+    const std::size_t regionSize = (_size + STREAM_REGION_COUNT - 1) / STREAM_REGION_COUNT;
+    int firstRegion = (int)(start / regionSize);
+    int lastRegion = (int)((end > start ? end - 1 : start) / regionSize);
+
+    // Fence the regions the writer leaves, draws reading them are already encoded.
+    // A range spanning several regions leaves them unfenced until the writer moves on, so start from the first unfenced one.
+    int firstWait = firstRegion;
+    if (wrapped || firstRegion != _streamRegion)
+    {
+        int leaveEnd = wrapped ? STREAM_REGION_COUNT : firstRegion;
+        for (int region = _streamFenceRegion; region < leaveEnd; ++region)
+        {
+            if (_streamFences[region])
+                glDeleteSync(_streamFences[region]);
+            _streamFences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        _streamFenceRegion = firstRegion;
+    }
+    else
+        firstWait = firstRegion + 1;
+
+    // Wait until the GPU is done with what the previous lap wrote into the regions about to be overwritten.
+    for (int region = firstWait; region <= lastRegion; ++region)
+    {
+        GLsync fence = _streamFences[region];
+        if (!fence)
+            continue;
+
+        GLenum result = GL_TIMEOUT_EXPIRED;
+        while (result == GL_TIMEOUT_EXPIRED)
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        glDeleteSync(fence);
+        _streamFences[region] = nullptr;
+    }
+
+    _streamRegion = lastRegion;
+#endif
+}
+
+void BufferGL::releaseStream()
+{
+#if CC_GL_BUFFER_STORAGE
+    for (auto& fence : _streamFences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+#endif
+
+    // The persistent mapping goes away with the buffer object.
+    if (_streamMode != StreamMode::PERSISTENT)
+        CC_SAFE_DELETE_ARRAY(_streamData);
+    _streamData = nullptr;
+    _streamMode = StreamMode::NONE;
+    _streamRegion = 0;
+    _streamFenceRegion = 0;
+}
+
 CC_BACKEND_END
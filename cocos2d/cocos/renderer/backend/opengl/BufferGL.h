@@ -30,6 +30,14 @@
 
 #include <vector>
 
+// glMapBufferRange and fences are not declared by opengl es 2.0 headers, streaming falls back to glBufferSubData there.
+#if defined(GL_MAP_UNSYNCHRONIZED_BIT)
+#define CC_GL_MAP_BUFFER_RANGE 1
+#endif
+#if defined(GL_MAP_PERSISTENT_BIT) && defined(GL_SYNC_GPU_COMMANDS_COMPLETE)
+#define CC_GL_BUFFER_STORAGE 1
+#endif
+
 CC_BACKEND_BEGIN
 /**
  * @addtogroup _opengl
@@ -74,6 +82,26 @@ public:
      */
     virtual void usingDefaultStoredData(bool needDefaultStoredData) override ;
 
+    /**
+     * Reserve a range of the buffer for streamed data, see `Buffer::reserveStreamRange()`.
+     * The data store is allocated on first use: persistently mapped storage guarded by fences where buffer storage is supported,
+     * otherwise ranges mapped with glMapBufferRange and orphaned when the ring wraps, otherwise a CPU copy uploaded with glBufferSubData.
+     * @param size Specifies the size in bytes of the range, at most the buffer size.
+     * @param alignment Specifies the alignment in bytes of the range offset.
+     * @param offset Returns the offset in bytes of the range in the buffer.
+     * @return Memory to write the range to, valid until `commitStreamRange()`.
+     */
+    virtual void* reserveStreamRange(std::size_t size, std::size_t alignment, std::size_t& offset) override;
+
+    /**
+     * Make the reserved range visible to the draws encoded after it.
+     * @param size Specifies the size in bytes that was written, at most the reserved size.
+     */
+    virtual void commitStreamRange(std::size_t size) override;
+
+    /// The ring is split into regions, a region gets a fence when the writer leaves it and is waited on when the writer comes back.
+    static const int STREAM_REGION_COUNT = 4;
+
     /**
      * Get buffer object.
      * @return Buffer object.
@@ -81,6 +109,19 @@ public:
     inline GLuint getHandler() const { return _buffer; }
 
 private:
+    enum class StreamMode
+    {
+        NONE,
+        PERSISTENT,
+        MAP_RANGE,
+        SUB_DATA
+    };
+
+    GLenum getTarget() const;
+    void initStream();
+    void waitStreamRegions(std::size_t start, std::size_t end, bool wrapped);
+    void releaseStream();
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     void reloadBuffer();
     void fillBuffer(void* data, std::size_t offset, std::size_t size);
@@ -93,6 +134,17 @@ private:
     std::size_t _bufferAllocated = 0;
     char* _data = nullptr;
     bool _needDefaultStoredData = true;
+
+    StreamMode _streamMode = StreamMode::NONE;
+    std::size_t _streamHead = 0; ///< offset following the last committed range
+    std::size_t _streamReservedOffset = 0;
+    std::size_t _streamReservedSize = 0;
+    char* _streamData = nullptr; ///< persistently mapped store, or the CPU copy for SUB_DATA
+    int _streamRegion = 0; ///< region the writer is in
+    int _streamFenceRegion = 0; ///< first region written since the writer last placed fences
+#if CC_GL_BUFFER_STORAGE
+    GLsync _streamFences[STREAM_REGION_COUNT] = {};
+#endif
 };
 //end of _opengl group
 ///> @}
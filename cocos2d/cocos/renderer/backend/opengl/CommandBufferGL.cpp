@@ -33,6 +33,9 @@
 #include "base/CCEventType.h"
 #include "base/CCDirector.h"
 #include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/VertexArrayCacheGL.h"
+#include "renderer/backend/Device.h"
 #include <algorithm>
 
 CC_BACKEND_BEGIN
@@ -74,11 +77,13 @@ namespace
 CommandBufferGL::CommandBufferGL()
 {
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_defaultFBO);
+    StateCacheGL::invalidate();
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     _backToForegroundListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom*){
        if(_generatedFBO)
            glGenFramebuffers(1, &_generatedFBO); //recreate framebuffer
+       _gpuTimer.reset(); //queries were lost with the context
     });
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_backToForegroundListener, -1);
 #endif
@@ -86,6 +91,7 @@ CommandBufferGL::CommandBufferGL()
 
 CommandBufferGL::~CommandBufferGL()
 {
+    StateCacheGL::deleteFramebuffer(_generatedFBO);
     glDeleteFramebuffers(1, &_generatedFBO);
     CC_SAFE_RELEASE_NULL(_renderPipeline);
 
@@ -98,6 +104,8 @@ CommandBufferGL::~CommandBufferGL()
 
 void CommandBufferGL::beginFrame()
 {
+    StateCacheGL::beginFrame();
+    _gpuTimer.beginFrame();
 }
 
 void CommandBufferGL::beginRenderPass(const RenderPassDescriptor& descirptor)
@@ -124,7 +132,7 @@ void CommandBufferGL::applyRenderPassDescriptor(const RenderPassDescriptor& desc
     {
         _currentFBO = _defaultFBO;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, _currentFBO);
+    StateCacheGL::bindFramebuffer(_currentFBO);
     
     if (useDepthAttachmentExternal)
     {
@@ -234,22 +242,14 @@ void CommandBufferGL::applyRenderPassDescriptor(const RenderPassDescriptor& desc
     
     CHECK_GL_ERROR_DEBUG();
     
-    GLboolean oldDepthWrite = GL_FALSE;
-    GLboolean oldDepthTest = GL_FALSE;
-    GLfloat oldDepthClearValue = 0.f;
-    GLint oldDepthFunc = GL_LESS;
+    // The depth state is not restored after clearing, every draw applies its own depth state in prepareDrawing().
     if (descirptor.needClearDepth)
     {
-        glGetBooleanv(GL_DEPTH_WRITEMASK, &oldDepthWrite);
-        glGetBooleanv(GL_DEPTH_TEST, &oldDepthTest);
-        glGetFloatv(GL_DEPTH_CLEAR_VALUE, &oldDepthClearValue);
-        glGetIntegerv(GL_DEPTH_FUNC, &oldDepthFunc);
-        
         mask |= GL_DEPTH_BUFFER_BIT;
         glClearDepth(descirptor.clearDepthValue);
-        glEnable(GL_DEPTH_TEST);
-        glDepthMask(GL_TRUE);
-        glDepthFunc(GL_ALWAYS);
+        StateCacheGL::setEnabled(GL_DEPTH_TEST, true);
+        StateCacheGL::depthMask(true);
+        StateCacheGL::depthFunc(GL_ALWAYS);
     }
     
     CHECK_GL_ERROR_DEBUG();
@@ -263,19 +263,6 @@ void CommandBufferGL::applyRenderPassDescriptor(const RenderPassDescriptor& desc
     if(mask) glClear(mask);
     
     CHECK_GL_ERROR_DEBUG();
-    
-    // restore depth test
-    if (descirptor.needClearDepth)
-    {
-        if (!oldDepthTest)
-            glDisable(GL_DEPTH_TEST);
-        
-        glDepthMask(oldDepthWrite);
-        glDepthFunc(oldDepthFunc);
-        glClearDepth(oldDepthClearValue);
-    }
-    
-    CHECK_GL_ERROR_DEBUG();
 }
 
 void CommandBufferGL::setRenderPipeline(RenderPipeline* renderPipeline)
@@ -292,7 +279,7 @@ void CommandBufferGL::setRenderPipeline(RenderPipeline* renderPipeline)
 
 void CommandBufferGL::setViewport(int x, int y, unsigned int w, unsigned int h)
 {
-    glViewport(x, y, w, h);
+    StateCacheGL::viewport(x, y, w, h);
     _viewPort.x = x;
     _viewPort.y = y;
     _viewPort.w = w;
@@ -306,7 +293,7 @@ void CommandBufferGL::setCullMode(CullMode mode)
 
 void CommandBufferGL::setWinding(Winding winding)
 {
-    glFrontFace(UtilsGL::toGLFrontFace(winding));
+    StateCacheGL::frontFace(UtilsGL::toGLFrontFace(winding));
 }
 
 void CommandBufferGL::setIndexBuffer(Buffer* buffer)
@@ -348,12 +335,48 @@ void CommandBufferGL::drawArrays(PrimitiveType primitiveType, std::size_t start,
 void CommandBufferGL::drawElements(PrimitiveType primitiveType, IndexFormat indexType, std::size_t count, std::size_t offset)
 {
     prepareDrawing();
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer->getHandler());
+    if (!VertexArrayCacheGL::isSupported())
+        StateCacheGL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer->getHandler());
     glDrawElements(UtilsGL::toGLPrimitiveType(primitiveType), count, UtilsGL::toGLIndexType(indexType), (GLvoid*)offset);
     CHECK_GL_ERROR_DEBUG();
     cleanResources();
 }
 
+bool CommandBufferGL::isInstancingSupported() const
+{
+    static const bool supported = Device::getInstance()->getDeviceInfo()->checkForFeatureSupported(FeatureType::INSTANCING);
+    return supported;
+}
+
+void CommandBufferGL::setInstanceBuffer(Buffer* buffer, std::size_t offset)
+{
+    assert(buffer != nullptr);
+    if (buffer == nullptr)
+        return;
+
+    buffer->retain();
+    CC_SAFE_RELEASE(_instanceBuffer);
+    _instanceBuffer = static_cast<BufferGL*>(buffer);
+    _instanceBufferOffset = offset;
+}
+
+void CommandBufferGL::drawElementsInstanced(PrimitiveType primitiveType, IndexFormat indexType, std::size_t count, std::size_t offset, std::size_t instanceCount)
+{
+#if CC_GL_INSTANCING
+    assert(_instanceBuffer != nullptr && isInstancingSupported());
+    prepareDrawing();
+    if (!VertexArrayCacheGL::isSupported())
+        StateCacheGL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer->getHandler());
+    glDrawElementsInstanced(UtilsGL::toGLPrimitiveType(primitiveType), count, UtilsGL::toGLIndexType(indexType), (GLvoid*)offset, (GLsizei)instanceCount);
+    CHECK_GL_ERROR_DEBUG();
+
+    // without vertex array objects the divisors are global state, and would apply to the next draws
+    if (!VertexArrayCacheGL::isSupported())
+        resetInstanceDivisors(*_programState->getVertexLayout());
+#endif
+    cleanResources();
+}
+
 void CommandBufferGL::endRenderPass()
 {
 }
@@ -362,6 +385,21 @@ void CommandBufferGL::endFrame()
 {
 }
 
+void CommandBufferGL::beginGPUTimer(unsigned int id)
+{
+    _gpuTimer.begin(id);
+}
+
+void CommandBufferGL::endGPUTimer(unsigned int id)
+{
+    _gpuTimer.end(id);
+}
+
+bool CommandBufferGL::popGPUTimerResults(uint64_t& frame, double* milliseconds)
+{
+    return _gpuTimer.popResults(frame, milliseconds);
+}
+
 void CommandBufferGL::setDepthStencilState(DepthStencilState* depthStencilState)	
 {	
     if (depthStencilState)	
@@ -377,7 +415,7 @@ void CommandBufferGL::setDepthStencilState(DepthStencilState* depthStencilState)
 void CommandBufferGL::prepareDrawing() const
 {   
     const auto& program = _renderPipeline->getProgram();
-    glUseProgram(program->getHandler());
+    StateCacheGL::useProgram(program->getHandler());
     
     bindVertexBuffer(program);
     setUniforms(program);
@@ -394,12 +432,12 @@ void CommandBufferGL::prepareDrawing() const
     // Set cull mode.
     if (CullMode::NONE == _cullMode)
     {
-        glDisable(GL_CULL_FACE);
+        StateCacheGL::setEnabled(GL_CULL_FACE, false);
     }
     else
     {
-        glEnable(GL_CULL_FACE);
-        glCullFace(UtilsGL::toGLCullMode(_cullMode));
+        StateCacheGL::setEnabled(GL_CULL_FACE, true);
+        StateCacheGL::cullFace(UtilsGL::toGLCullMode(_cullMode));
     }
 }
 
@@ -407,17 +445,34 @@ void CommandBufferGL::bindVertexBuffer(ProgramGL *program) const
 {
     // Bind vertex buffers and set the attributes.
     auto vertexLayout = _programState->getVertexLayout();
-    
+
     if (!vertexLayout->isValid())
         return;
+
+    // The vertex array object records the index buffer as well, so drawElements() doesn't bind it again.
+    if (VertexArrayCacheGL::isSupported())
+    {
+        VertexArrayCacheGL::bind(*vertexLayout, _vertexBuffer->getHandler(), _indexBuffer ? _indexBuffer->getHandler() : 0);
+        bindInstanceAttributes(*vertexLayout, false);
+        return;
+    }
     
-    glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer->getHandler());
+    StateCacheGL::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer->getHandler());
 
     const auto& attributes = vertexLayout->getAttributes();
+    uint32_t enabledAttribs = 0;
+    for (const auto& attributeInfo : attributes)
+        enabledAttribs |= 1u << attributeInfo.second.index;
+    if (_instanceBuffer)
+    {
+        for (const auto& attributeInfo : vertexLayout->getInstanceAttributes())
+            enabledAttribs |= 1u << attributeInfo.second.index;
+    }
+    StateCacheGL::enableVertexAttribArrays(enabledAttribs);
+
     for (const auto& attributeInfo : attributes)
     {
         const auto& attribute = attributeInfo.second;
-        glEnableVertexAttribArray(attribute.index);
         glVertexAttribPointer(attribute.index,
             UtilsGL::getGLAttributeSize(attribute.format),
             UtilsGL::toGLAttributeType(attribute.format),
@@ -425,6 +480,39 @@ void CommandBufferGL::bindVertexBuffer(ProgramGL *program) const
             vertexLayout->getStride(),
             (GLvoid*)attribute.offset);
     }
+
+    bindInstanceAttributes(*vertexLayout, true);
+}
+
+void CommandBufferGL::bindInstanceAttributes(const VertexLayout& vertexLayout, bool setDivisors) const
+{
+#if CC_GL_INSTANCING
+    if (!_instanceBuffer)
+        return;
+
+    // the instance buffer is a ring range that moves every frame, so its pointers are not part of the cached vertex array objects
+    StateCacheGL::bindBuffer(GL_ARRAY_BUFFER, _instanceBuffer->getHandler());
+    for (const auto& attributeInfo : vertexLayout.getInstanceAttributes())
+    {
+        const auto& attribute = attributeInfo.second;
+        glVertexAttribPointer(attribute.index,
+            UtilsGL::getGLAttributeSize(attribute.format),
+            UtilsGL::toGLAttributeType(attribute.format),
+            attribute.needToBeNormallized,
+            vertexLayout.getInstanceStride(),
+            (GLvoid*)(_instanceBufferOffset + attribute.offset));
+        if (setDivisors)
+            glVertexAttribDivisor(attribute.index, 1);
+    }
+#endif
+}
+
+void CommandBufferGL::resetInstanceDivisors(const VertexLayout& vertexLayout) const
+{
+#if CC_GL_INSTANCING
+    for (const auto& attributeInfo : vertexLayout.getInstanceAttributes())
+        glVertexAttribDivisor(attributeInfo.second.index, 0);
+#endif
 }
 
 void CommandBufferGL::setUniforms(ProgramGL* program) const
@@ -442,7 +530,9 @@ void CommandBufferGL::setUniforms(ProgramGL* program) const
             cb.second(_programState, cb.first);
         }
 
-        int i = 0;
+        // Only upload the uniforms whose value differs from what the program already holds.
+        unsigned int issuedUniforms = 0;
+        unsigned int skippedUniforms = 0;
         for(auto& iter : uniformInfos)
         {
             auto& uniformInfo = iter.second;
@@ -450,11 +540,19 @@ void CommandBufferGL::setUniforms(ProgramGL* program) const
                 continue;
 
             int elementCount = uniformInfo.count;
+            void* data = buffer + uniformInfo.bufferOffset;
+            if (!program->updateUniformShadow(uniformInfo.bufferOffset, data, uniformInfo.size * elementCount))
+            {
+                ++skippedUniforms;
+                continue;
+            }
+
+            ++issuedUniforms;
             setUniform(uniformInfo.isArray,
                 uniformInfo.location,
                 elementCount,
                 uniformInfo.type,
-                (void*)(buffer + uniformInfo.bufferOffset));
+                data);
         }
         
         const auto& textureInfo = _programState->getVertexTextureInfos();
@@ -473,12 +571,21 @@ void CommandBufferGL::setUniforms(ProgramGL* program) const
                 ++i;
             }
             
+            if (!program->updateSamplerShadow(location, slot))
+            {
+                ++skippedUniforms;
+                continue;
+            }
+
+            ++issuedUniforms;
             auto arrayCount = slot.size();
             if (arrayCount > 1)
                 glUniform1iv(location, (uint32_t)arrayCount, (GLint*)slot.data());
             else
                 glUniform1i(location, slot[0]);
         }
+
+        StateCacheGL::countCalls(issuedUniforms, skippedUniforms);
     }
 }
 
@@ -577,6 +684,7 @@ void CommandBufferGL::setUniform(bool isArray, GLuint location, unsigned int siz
 void CommandBufferGL::cleanResources()
 {
     CC_SAFE_RELEASE_NULL(_indexBuffer);
+    CC_SAFE_RELEASE_NULL(_instanceBuffer);
     CC_SAFE_RELEASE_NULL(_programState);  
     CC_SAFE_RELEASE_NULL(_vertexBuffer);
 }
@@ -584,9 +692,9 @@ void CommandBufferGL::cleanResources()
 void CommandBufferGL::setLineWidth(float lineWidth)
 {
     if(lineWidth > 0.0f)
-        glLineWidth(lineWidth);
+        StateCacheGL::lineWidth(lineWidth);
     else
-        glLineWidth(1.0f);
+        StateCacheGL::lineWidth(1.0f);
     
 }
 
@@ -595,12 +703,12 @@ void CommandBufferGL::setScissorRect(bool isEnabled, float x, float y, float wid
 {
     if(isEnabled)
     {
-        glEnable(GL_SCISSOR_TEST);
-        glScissor(x, y, width, height);
+        StateCacheGL::setEnabled(GL_SCISSOR_TEST, true);
+        StateCacheGL::scissor(x, y, width, height);
     }
     else
     {
-        glDisable(GL_SCISSOR_TEST);
+        StateCacheGL::setEnabled(GL_SCISSOR_TEST, false);
     }
 }
 
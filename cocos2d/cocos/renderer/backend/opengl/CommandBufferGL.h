@@ -26,6 +26,7 @@
 
 #include "../Macros.h"
 #include "../CommandBuffer.h"
+#include "GPUTimerGL.h"
 #include "base/CCEventListenerCustom.h"
 #include "platform/CCGL.h"
 
@@ -133,6 +134,28 @@ public:
     */
     virtual void drawElements(PrimitiveType primitiveType, IndexFormat indexType, std::size_t count, std::size_t offset) override;
     
+    /**
+     * Whether the context has instanced arrays.
+     */
+    virtual bool isInstancingSupported() const override;
+
+    /**
+     * Set the buffer the per-instance attributes are read from, for the next draw only.
+     * @param buffer The buffer holding the instance data.
+     * @param offset Byte offset of the first instance within the buffer.
+     */
+    virtual void setInstanceBuffer(Buffer* buffer, std::size_t offset) override;
+
+    /**
+     * Draw several instances of primitives with an index list.
+     * @param primitiveType The type of primitives that elements are assembled into.
+     * @param indexType The type if indexes, either 16 bit integer or 32 bit integer.
+     * @param count The number of indexes to read from the index buffer for each instance.
+     * @param offset Byte offset within indexBuffer to start reading indexes from.
+     * @param instanceCount The number of instances to draw.
+     */
+    virtual void drawElementsInstanced(PrimitiveType primitiveType, IndexFormat indexType, std::size_t count, std::size_t offset, std::size_t instanceCount) override;
+
     /**
      * Do some resources release.
      */
@@ -169,6 +192,30 @@ public:
      */
     virtual void captureScreen(std::function<void(const unsigned char*, int, int)> callback) override ;
 
+    /**
+     * Whether the context has timer queries.
+     */
+    virtual bool isGPUTimerSupported() const override { return _gpuTimer.isSupported(); }
+
+    /**
+     * Start measuring the GPU time of the following commands.
+     * @param id Identifies what is measured.
+     */
+    virtual void beginGPUTimer(unsigned int id) override;
+
+    /**
+     * Stop measuring the GPU time.
+     * @param id The id given to `beginGPUTimer(unsigned int id)`.
+     */
+    virtual void endGPUTimer(unsigned int id) override;
+
+    /**
+     * Get the GPU times of the oldest frame whose timer queries are finished.
+     * @param frame Receives the index of that frame.
+     * @param milliseconds Receives MAX_GPU_TIMERS times.
+     */
+    virtual bool popGPUTimerResults(uint64_t& frame, double* milliseconds) override;
+
 private:
     struct Viewport
     {
@@ -180,6 +227,8 @@ private:
     
     void prepareDrawing() const;
     void bindVertexBuffer(ProgramGL* program) const;
+    void bindInstanceAttributes(const VertexLayout& vertexLayout, bool setDivisors) const;
+    void resetInstanceDivisors(const VertexLayout& vertexLayout) const;
     void setUniforms(ProgramGL* program) const;
     void setUniform(bool isArray, GLuint location, unsigned int size, GLenum uniformType, void* data) const;
     void cleanResources();
@@ -196,11 +245,14 @@ private:
     BufferGL* _vertexBuffer;
     ProgramState* _programState = nullptr;
     BufferGL* _indexBuffer = nullptr;
+    BufferGL* _instanceBuffer = nullptr;
+    std::size_t _instanceBufferOffset = 0;
     RenderPipelineGL* _renderPipeline = nullptr;
     CullMode _cullMode = CullMode::NONE;
     DepthStencilStateGL* _depthStencilStateGL = nullptr;
     Viewport _viewPort;
     GLboolean _alphaTestEnabled = false;
+    GPUTimerGL _gpuTimer;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     EventListenerCustom* _backToForegroundListener = nullptr;
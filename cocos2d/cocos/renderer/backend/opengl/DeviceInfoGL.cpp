@@ -25,6 +25,9 @@
 #include "DeviceInfoGL.h"
 #include "platform/CCGL.h"
 
+#include <cctype>
+#include <cstdio>
+
 CC_BACKEND_BEGIN
 
 bool DeviceInfoGL::init()
@@ -98,6 +101,33 @@ bool DeviceInfoGL::checkForFeatureSupported(FeatureType feature)
     case FeatureType::DEPTH24:
         featureSupported = checkForGLExtension("GL_OES_depth24");
         break;
+    case FeatureType::MAP_BUFFER_RANGE:
+#ifdef GL_MAP_UNSYNCHRONIZED_BIT //glMapBufferRange is not declared in opengl es 2.0 headers
+        featureSupported = isGLVersionAtLeast(3, 0) || checkForGLExtension("GL_ARB_map_buffer_range");
+#endif
+        break;
+    case FeatureType::BUFFER_STORAGE:
+#if defined(GL_MAP_PERSISTENT_BIT) && defined(GL_SYNC_GPU_COMMANDS_COMPLETE)
+        // Persistently mapped buffers are only safe to reuse with fences.
+        featureSupported = (isGLVersionAtLeast(4, 4) || checkForGLExtension("GL_ARB_buffer_storage")) &&
+                           (isGLVersionAtLeast(3, 2) || checkForGLExtension("GL_ARB_sync"));
+#endif
+        break;
+    case FeatureType::TIMER_QUERY:
+#if defined(GL_TIME_ELAPSED) && defined(GL_TIMESTAMP) //timer queries are an extension of opengl es
+        featureSupported = isGLVersionAtLeast(3, 3) || checkForGLExtension("GL_ARB_timer_query");
+#endif
+        break;
+    case FeatureType::INSTANCING:
+#ifdef GL_VERTEX_ATTRIB_ARRAY_DIVISOR
+#ifdef CC_USE_GLES
+        featureSupported = isGLVersionAtLeast(3, 0);
+#else
+        featureSupported = isGLVersionAtLeast(3, 3) ||
+                           (checkForGLExtension("GL_ARB_instanced_arrays") && checkForGLExtension("GL_ARB_draw_instanced"));
+#endif
+#endif
+        break;
     default:
         break;
     }
@@ -109,4 +139,22 @@ bool DeviceInfoGL::checkForGLExtension(const std::string &searchName) const
     return _glExtensions.find(searchName) != std::string::npos;
 }
 
+bool DeviceInfoGL::isGLVersionAtLeast(int major, int minor) const
+{
+    // Desktop version strings start with the version, i.e. "4.6.0 NVIDIA", ES ones with "OpenGL ES 3.2".
+    const char* version = getVersion();
+    if (version == nullptr)
+        return false;
+
+    while (*version && !isdigit(*version))
+        ++version;
+
+    int versionMajor = 0;
+    int versionMinor = 0;
+    if (sscanf(version, "%d.%d", &versionMajor, &versionMinor) != 2)
+        return false;
+
+    return versionMajor > major || (versionMajor == major && versionMinor >= minor);
+}
+
 CC_BACKEND_END
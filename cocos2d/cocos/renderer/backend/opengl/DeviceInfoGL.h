@@ -79,6 +79,7 @@ public:
     
 private:
     bool checkForGLExtension(const std::string &searchName) const;
+    bool isGLVersionAtLeast(int major, int minor) const;
 
     std::string _glExtensions;
 };
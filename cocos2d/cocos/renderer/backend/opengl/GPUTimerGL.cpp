@@ -0,0 +1,230 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "GPUTimerGL.h"
+#include "renderer/backend/Device.h"
+#include "base/ccMacros.h"
+
+CC_BACKEND_BEGIN
+
+GPUTimerGL::GPUTimerGL()
+{
+#if CC_GL_TIMER_QUERY
+    if (!Device::getInstance()->getDeviceInfo()->checkForFeatureSupported(FeatureType::TIMER_QUERY))
+        return;
+
+    // some implementations have GL_TIME_ELAPSED but a 0 bit timestamp counter
+    GLint timestampBits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &timestampBits);
+    _mode = timestampBits > 0 ? Mode::TIMESTAMP : Mode::TIME_ELAPSED;
+#endif
+}
+
+GPUTimerGL::~GPUTimerGL()
+{
+#if CC_GL_TIMER_QUERY
+    for (auto& frame : _frames)
+        recycleQueries(frame);
+    if (!_freeQueries.empty())
+        glDeleteQueries((GLsizei)_freeQueries.size(), _freeQueries.data());
+#endif
+}
+
+void GPUTimerGL::beginFrame()
+{
+    if (!isSupported())
+        return;
+
+    CCASSERT(_openRegions.empty(), "GPU timers must be ended before the next frame");
+    _openRegions.clear();
+
+    // the GPU is more than MAX_PENDING_FRAMES behind or nobody reads the results, drop them
+    auto& frame = _frames[_frameCount % MAX_PENDING_FRAMES];
+    recycleQueries(frame);
+
+    frame.index = _frameCount++;
+    frame.pending = true;
+    frame.unmeasuredIds = 0;
+    frame.lastQuery = 0;
+    _currentFrame = &frame;
+}
+
+void GPUTimerGL::begin(unsigned int id)
+{
+#if CC_GL_TIMER_QUERY
+    if (!_currentFrame)
+        return;
+
+    CCASSERT(id < CommandBuffer::MAX_GPU_TIMERS, "Invalid GPU timer id");
+
+    // GL_TIME_ELAPSED queries can't be nested
+    if (_mode == Mode::TIME_ELAPSED && !_openRegions.empty())
+    {
+        _currentFrame->unmeasuredIds |= 1u << id;
+        _openRegions.push_back(-1);
+        return;
+    }
+
+    Region region = { id, acquireQuery(), 0 };
+    if (_mode == Mode::TIMESTAMP)
+        glQueryCounter(region.startQuery, GL_TIMESTAMP);
+    else
+        glBeginQuery(GL_TIME_ELAPSED, region.startQuery);
+    _currentFrame->lastQuery = region.startQuery;
+
+    _openRegions.push_back((int)_currentFrame->regions.size());
+    _currentFrame->regions.push_back(region);
+#endif
+}
+
+void GPUTimerGL::end(unsigned int id)
+{
+#if CC_GL_TIMER_QUERY
+    if (!_currentFrame || _openRegions.empty())
+        return;
+
+    int index = _openRegions.back();
+    _openRegions.pop_back();
+    if (index < 0)
+        return;
+
+    auto& region = _currentFrame->regions[index];
+    CCASSERT(region.id == id, "GPU timers must be ended in the reverse order they were begun");
+
+    if (_mode == Mode::TIMESTAMP)
+    {
+        region.endQuery = acquireQuery();
+        glQueryCounter(region.endQuery, GL_TIMESTAMP);
+        _currentFrame->lastQuery = region.endQuery;
+    }
+    else
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+#endif
+}
+
+bool GPUTimerGL::popResults(uint64_t& frameIndex, double* milliseconds)
+{
+#if CC_GL_TIMER_QUERY
+    // the current frame may still get regions
+    Frame* oldest = nullptr;
+    for (auto& frame : _frames)
+    {
+        if (frame.pending && &frame != _currentFrame && (!oldest || frame.index < oldest->index))
+            oldest = &frame;
+    }
+    if (!oldest || !isAvailable(*oldest))
+        return false;
+
+    for (unsigned int i = 0; i < CommandBuffer::MAX_GPU_TIMERS; ++i)
+        milliseconds[i] = (oldest->unmeasuredIds & (1u << i)) ? -1.0 : 0.0;
+
+    for (const auto& region : oldest->regions)
+    {
+        if (milliseconds[region.id] < 0)
+            continue;
+
+        GLuint64 elapsed = 0;
+        if (_mode == Mode::TIMESTAMP)
+        {
+            if (!region.endQuery)
+                continue;
+            GLuint64 start = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(region.startQuery, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(region.endQuery, GL_QUERY_RESULT, &end);
+            elapsed = end > start ? end - start : 0;
+        }
+        else
+        {
+            glGetQueryObjectui64v(region.startQuery, GL_QUERY_RESULT, &elapsed);
+        }
+        milliseconds[region.id] += elapsed / 1000000.0;
+    }
+
+    frameIndex = oldest->index;
+    recycleQueries(*oldest);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void GPUTimerGL::reset()
+{
+    for (auto& frame : _frames)
+    {
+        frame.regions.clear();
+        frame.pending = false;
+    }
+    _currentFrame = nullptr;
+    _openRegions.clear();
+    _freeQueries.clear();
+}
+
+GLuint GPUTimerGL::acquireQuery()
+{
+    GLuint query = 0;
+#if CC_GL_TIMER_QUERY
+    if (_freeQueries.empty())
+    {
+        glGenQueries(1, &query);
+        return query;
+    }
+    query = _freeQueries.back();
+    _freeQueries.pop_back();
+#endif
+    return query;
+}
+
+void GPUTimerGL::recycleQueries(Frame& frame)
+{
+    for (const auto& region : frame.regions)
+    {
+        _freeQueries.push_back(region.startQuery);
+        if (region.endQuery)
+            _freeQueries.push_back(region.endQuery);
+    }
+    frame.regions.clear();
+    frame.pending = false;
+    if (_currentFrame == &frame)
+        _currentFrame = nullptr;
+}
+
+bool GPUTimerGL::isAvailable(const Frame& frame) const
+{
+#if CC_GL_TIMER_QUERY
+    // queries finish in the order they were issued
+    if (!frame.lastQuery)
+        return true;
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available == GL_TRUE;
+#else
+    return false;
+#endif
+}
+
+CC_BACKEND_END
@@ -0,0 +1,116 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include "../Macros.h"
+#include "../CommandBuffer.h"
+#include "platform/CCGL.h"
+
+#include <cstdint>
+#include <vector>
+
+// timer queries are not declared by opengl es headers, GPU timers are not supported there.
+#if defined(GL_TIME_ELAPSED) && defined(GL_TIMESTAMP)
+#define CC_GL_TIMER_QUERY 1
+#endif
+
+CC_BACKEND_BEGIN
+
+/**
+ * @addtogroup _opengl
+ * @{
+ */
+
+/**
+ * Measures the GPU time of regions of a frame with timer queries, without waiting for the results.
+ * Uses a pair of GL_TIMESTAMP queries per region when the context has timestamps, so regions can nest,
+ * otherwise a GL_TIME_ELAPSED query that only measures the outermost region.
+ */
+class GPUTimerGL
+{
+public:
+    /// The number of frames whose results can be outstanding, older ones are dropped.
+    static const unsigned int MAX_PENDING_FRAMES = 4;
+
+    GPUTimerGL();
+    ~GPUTimerGL();
+
+    /// Whether the context has timer queries.
+    bool isSupported() const { return _mode != Mode::NONE; }
+
+    /// Start a new frame, the results of the frame that used the same slot are dropped if still not read.
+    void beginFrame();
+
+    /// Start measuring a region, see `CommandBuffer::beginGPUTimer(unsigned int id)`.
+    void begin(unsigned int id);
+
+    /// Stop measuring the innermost region.
+    void end(unsigned int id);
+
+    /// Read the results of the oldest finished frame, see `CommandBuffer::popGPUTimerResults(uint64_t&, double*)`.
+    bool popResults(uint64_t& frame, double* milliseconds);
+
+    /// Forget every query without deleting it, used when the GL context was lost together with them.
+    void reset();
+
+private:
+    enum class Mode
+    {
+        NONE,
+        TIMESTAMP,
+        TIME_ELAPSED
+    };
+
+    struct Region
+    {
+        unsigned int id;
+        GLuint startQuery;
+        GLuint endQuery; // 0 when a single GL_TIME_ELAPSED query measures the region
+    };
+
+    struct Frame
+    {
+        uint64_t index = 0;
+        bool pending = false;
+        unsigned int unmeasuredIds = 0; // bit per id with a region that could not be measured
+        GLuint lastQuery = 0;
+        std::vector<Region> regions;
+    };
+
+    GLuint acquireQuery();
+    void recycleQueries(Frame& frame);
+    bool isAvailable(const Frame& frame) const;
+
+    Mode _mode = Mode::NONE;
+    Frame _frames[MAX_PENDING_FRAMES];
+    Frame* _currentFrame = nullptr;
+    uint64_t _frameCount = 0;
+    std::vector<int> _openRegions; // indexes into the regions of the current frame, -1 when not measured
+    std::vector<GLuint> _freeQueries;
+};
+
+//end of _opengl group
+/// @}
+CC_BACKEND_END
@@ -30,6 +30,7 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
 #include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
 
 CC_BACKEND_BEGIN
 namespace {
@@ -75,7 +76,10 @@ ProgramGL::~ProgramGL()
     CC_SAFE_RELEASE(_vertexShaderModule);
     CC_SAFE_RELEASE(_fragmentShaderModule);
     if (_program)
+    {
+        StateCacheGL::deleteProgram(_program);
         glDeleteProgram(_program);
+    }
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
@@ -128,6 +132,7 @@ void ProgramGL::compileProgram()
     if (GL_FALSE == status)
     {
         printf("cocos2d: ERROR: %s: failed to link program ", __FUNCTION__);
+        StateCacheGL::deleteProgram(_program);
         glDeleteProgram(_program);
         _program = 0;
     }
@@ -270,6 +275,10 @@ void ProgramGL::computeUniformInfos()
         _maxLocation = _maxLocation <= uniform.location ? (uniform.location + 1) : _maxLocation;
     }
     free(uniformName);
+
+    // A freshly linked program has every uniform set to zero.
+    _uniformShadow.assign(_totalBufferSize, 0);
+    _samplerShadow.clear();
 }
 
 int ProgramGL::getAttributeLocation(Attribute name) const
@@ -345,4 +354,27 @@ std::size_t ProgramGL::getUniformBufferSize(ShaderStage stage) const
     return _totalBufferSize;
 }
 
+bool ProgramGL::updateUniformShadow(std::size_t offset, const void* data, std::size_t size)
+{
+    if (offset + size > _uniformShadow.size())
+        return true;
+
+    char* shadow = _uniformShadow.data() + offset;
+    if (memcmp(shadow, data, size) == 0)
+        return false;
+
+    memcpy(shadow, data, size);
+    return true;
+}
+
+bool ProgramGL::updateSamplerShadow(int location, const std::vector<uint32_t>& slots)
+{
+    auto& shadow = _samplerShadow[location];
+    if (shadow == slots)
+        return false;
+
+    shadow = slots;
+    return true;
+}
+
 CC_BACKEND_END
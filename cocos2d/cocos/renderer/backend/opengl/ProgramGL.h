@@ -157,6 +157,24 @@ public:
      */
     virtual const std::unordered_map<std::string, UniformInfo>& getAllActiveUniformInfo(ShaderStage stage) const override ;
 
+    /**
+     * Compare a uniform value with the copy last uploaded to this program, and update the copy if it differs.
+     * The copy starts zero filled, which is the value GL gives every uniform when the program is linked.
+     * @param offset The uniform offset in the uniform buffer, i.e. UniformInfo::bufferOffset.
+     * @param data The uniform value.
+     * @param size The uniform size in bytes.
+     * @return true if the value changed and has to be uploaded.
+     */
+    bool updateUniformShadow(std::size_t offset, const void* data, std::size_t size);
+
+    /**
+     * Compare the texture slots of a sampler uniform with the slots last uploaded to this program, and update the copy if they differ.
+     * @param location The sampler uniform location.
+     * @param slots The texture slots.
+     * @return true if the slots changed and have to be uploaded.
+     */
+    bool updateSamplerShadow(int location, const std::vector<uint32_t>& slots);
+
 private:
     void compileProgram();
     bool getAttributeLocation(const std::string& attributeName, unsigned int& location) const;
@@ -187,6 +205,8 @@ private:
     UniformLocation _builtinUniformLocation[UNIFORM_MAX];
     int _builtinAttributeLocation[Attribute::ATTRIBUTE_MAX];
     std::unordered_map<int, int> _bufferOffset;
+    std::vector<char> _uniformShadow; ///< uniform values last uploaded to the program, laid out like the uniform buffer
+    std::unordered_map<int, std::vector<uint32_t>> _samplerShadow; ///< texture slots last uploaded to each sampler uniform
 };
 //end of _opengl group
 /// @}
@@ -27,6 +27,7 @@
 #include "DepthStencilStateGL.h"
 #include "ProgramGL.h"
 #include "UtilsGL.h"
+#include "StateCacheGL.h"
 
 #include <assert.h>
 
@@ -58,19 +59,17 @@ void RenderPipelineGL::updateBlendState(const BlendDescriptor& descriptor)
     auto writeMaskBlue = (uint32_t)descriptor.writeMask & (uint32_t)ColorWriteMask::BLUE;
     auto writeMaskAlpha = (uint32_t)descriptor.writeMask & (uint32_t)ColorWriteMask::ALPHA;
 
+    StateCacheGL::setEnabled(GL_BLEND, blendEnabled);
     if (blendEnabled)
     {
-        glEnable(GL_BLEND);
-        glBlendEquationSeparate(rgbBlendOperation, alphaBlendOperation);
-        glBlendFuncSeparate(sourceRGBBlendFactor,
-                            destinationRGBBlendFactor,
-                            sourceAlphaBlendFactor,
-                            destinationAlphaBlendFactor);
+        StateCacheGL::blendEquation(rgbBlendOperation, alphaBlendOperation);
+        StateCacheGL::blendFunc(sourceRGBBlendFactor,
+                                destinationRGBBlendFactor,
+                                sourceAlphaBlendFactor,
+                                destinationAlphaBlendFactor);
     }
-    else
-        glDisable(GL_BLEND);
     
-    glColorMask(writeMaskRed, writeMaskGreen, writeMaskBlue, writeMaskAlpha);
+    StateCacheGL::colorMask(writeMaskRed, writeMaskGreen, writeMaskBlue, writeMaskAlpha);
 }
 
 RenderPipelineGL::~RenderPipelineGL()
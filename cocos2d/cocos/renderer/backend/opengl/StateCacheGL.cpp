@@ -0,0 +1,494 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+#include "StateCacheGL.h"
+
+CC_BACKEND_BEGIN
+
+namespace
+{
+    const GLuint UNKNOWN = 0xFFFFFFFF;
+    const int8_t UNKNOWN_FLAG = -1;
+
+    // Vertex attribute locations that are synchronized when the enabled mask is unknown, GL guarantees at least 16.
+    const unsigned int MAX_VERTEX_ATTRIBS = 16;
+
+    enum CapabilityIndex
+    {
+        CAPABILITY_BLEND,
+        CAPABILITY_DEPTH_TEST,
+        CAPABILITY_STENCIL_TEST,
+        CAPABILITY_CULL_FACE,
+        CAPABILITY_SCISSOR_TEST,
+        CAPABILITY_MAX
+    };
+
+    struct StencilFaceState
+    {
+        GLenum function = UNKNOWN;
+        GLint reference = 0;
+        GLuint readMask = 0;
+        GLenum stencilFailure = UNKNOWN;
+        GLenum depthFailure = UNKNOWN;
+        GLenum depthStencilPass = UNKNOWN;
+        GLuint writeMask = 0;
+        bool writeMaskKnown = false;
+    };
+
+    struct RectState
+    {
+        GLint x = 0;
+        GLint y = 0;
+        GLsizei width = -1;
+        GLsizei height = -1;
+    };
+
+    struct State
+    {
+        GLuint program = UNKNOWN;
+        GLuint framebuffer = UNKNOWN;
+        GLuint arrayBuffer = UNKNOWN;
+        GLuint elementArrayBuffer = UNKNOWN; ///< binding of vertex array object 0
+        GLuint vertexArray = 0; ///< assumed 0 after invalidate(), nothing outside the backend binds vertex array objects
+        uint32_t enabledAttribs = 0;
+        bool enabledAttribsKnown = false;
+
+        GLuint activeTextureUnit = UNKNOWN;
+        GLuint textures2D[StateCacheGL::MAX_TEXTURE_UNITS];
+        GLuint texturesCube[StateCacheGL::MAX_TEXTURE_UNITS];
+
+        int8_t capabilities[CAPABILITY_MAX];
+        GLenum blendEquation[2] = {UNKNOWN, UNKNOWN};
+        GLenum blendFunc[4] = {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+        int8_t colorMask[4] = {UNKNOWN_FLAG, UNKNOWN_FLAG, UNKNOWN_FLAG, UNKNOWN_FLAG};
+        int8_t depthMask = UNKNOWN_FLAG;
+        GLenum depthFunc = UNKNOWN;
+        GLenum cullFace = UNKNOWN;
+        GLenum frontFace = UNKNOWN;
+        GLfloat lineWidth = -1.0f;
+        RectState viewport;
+        RectState scissor;
+
+        // 0 is the front face, 1 is the back face.
+        StencilFaceState stencil[2];
+
+        State()
+        {
+            for (unsigned int i = 0; i < StateCacheGL::MAX_TEXTURE_UNITS; ++i)
+            {
+                textures2D[i] = UNKNOWN;
+                texturesCube[i] = UNKNOWN;
+            }
+            for (auto& capability : capabilities)
+                capability = UNKNOWN_FLAG;
+        }
+    };
+
+    State state;
+    StateCacheGL::FrameStats currentFrame;
+    StateCacheGL::FrameStats lastFrame;
+
+    inline bool skip()
+    {
+        ++currentFrame.skippedCalls;
+        return true;
+    }
+
+    inline void issue()
+    {
+        ++currentFrame.issuedCalls;
+    }
+
+    int getCapabilityIndex(GLenum capability)
+    {
+        switch (capability)
+        {
+            case GL_BLEND:
+                return CAPABILITY_BLEND;
+            case GL_DEPTH_TEST:
+                return CAPABILITY_DEPTH_TEST;
+            case GL_STENCIL_TEST:
+                return CAPABILITY_STENCIL_TEST;
+            case GL_CULL_FACE:
+                return CAPABILITY_CULL_FACE;
+            case GL_SCISSOR_TEST:
+                return CAPABILITY_SCISSOR_TEST;
+            default:
+                return -1;
+        }
+    }
+
+    // Returns true when the given face (or both faces) already match, i.e. the call can be skipped.
+    template <typename Compare, typename Assign>
+    bool updateStencilFaces(GLenum face, Compare compare, Assign assign)
+    {
+        bool front = (face == GL_FRONT || face == GL_FRONT_AND_BACK);
+        bool back = (face == GL_BACK || face == GL_FRONT_AND_BACK);
+        bool same = (!front || compare(state.stencil[0])) && (!back || compare(state.stencil[1]));
+        if (same)
+            return true;
+
+        if (front)
+            assign(state.stencil[0]);
+        if (back)
+            assign(state.stencil[1]);
+        return false;
+    }
+}
+
+void StateCacheGL::invalidate()
+{
+    state = State();
+}
+
+void StateCacheGL::beginFrame()
+{
+    lastFrame = currentFrame;
+    currentFrame = FrameStats();
+}
+
+const StateCacheGL::FrameStats& StateCacheGL::getLastFrameStats()
+{
+    return lastFrame;
+}
+
+void StateCacheGL::countCalls(unsigned int issued, unsigned int skipped)
+{
+    currentFrame.issuedCalls += issued;
+    currentFrame.skippedCalls += skipped;
+}
+
+void StateCacheGL::useProgram(GLuint program)
+{
+    if (state.program == program && skip())
+        return;
+
+    issue();
+    state.program = program;
+    glUseProgram(program);
+}
+
+void StateCacheGL::bindFramebuffer(GLuint framebuffer)
+{
+    if (state.framebuffer == framebuffer && skip())
+        return;
+
+    issue();
+    state.framebuffer = framebuffer;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void StateCacheGL::bindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* current = nullptr;
+    if (target == GL_ARRAY_BUFFER)
+        current = &state.arrayBuffer;
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        // Keep the element array binding of cached vertex array objects intact.
+        if (state.vertexArray != 0)
+            bindVertexArray(0);
+        current = &state.elementArrayBuffer;
+    }
+
+    if (current && *current == buffer && skip())
+        return;
+
+    issue();
+    if (current)
+        *current = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void StateCacheGL::bindVertexArray(GLuint vertexArray)
+{
+    if (state.vertexArray == vertexArray && skip())
+        return;
+
+    issue();
+    state.vertexArray = vertexArray;
+    glBindVertexArray(vertexArray);
+}
+
+void StateCacheGL::enableVertexAttribArrays(uint32_t mask)
+{
+    uint32_t changed = state.enabledAttribsKnown ? (state.enabledAttribs ^ mask) : ((1u << MAX_VERTEX_ATTRIBS) - 1) | mask;
+    if (changed == 0 && skip())
+        return;
+
+    for (unsigned int i = 0; changed != 0; ++i, changed >>= 1)
+    {
+        if ((changed & 1) == 0)
+            continue;
+
+        issue();
+        if (mask & (1u << i))
+            glEnableVertexAttribArray(i);
+        else
+            glDisableVertexAttribArray(i);
+    }
+    state.enabledAttribs = mask;
+    state.enabledAttribsKnown = true;
+}
+
+void StateCacheGL::bindTexture(GLenum target, GLuint texture, unsigned int unit)
+{
+    GLuint* current = nullptr;
+    if (unit < MAX_TEXTURE_UNITS)
+        current = (target == GL_TEXTURE_CUBE_MAP) ? &state.texturesCube[unit] : &state.textures2D[unit];
+
+    if (current && *current == texture && skip())
+        return;
+
+    if (state.activeTextureUnit != unit)
+    {
+        issue();
+        state.activeTextureUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    issue();
+    if (current)
+        *current = texture;
+    glBindTexture(target, texture);
+}
+
+void StateCacheGL::setEnabled(GLenum capability, bool enabled)
+{
+    int index = getCapabilityIndex(capability);
+    if (index >= 0 && state.capabilities[index] == (int8_t)enabled && skip())
+        return;
+
+    issue();
+    if (index >= 0)
+        state.capabilities[index] = enabled;
+
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void StateCacheGL::blendEquation(GLenum rgbOperation, GLenum alphaOperation)
+{
+    if (state.blendEquation[0] == rgbOperation && state.blendEquation[1] == alphaOperation && skip())
+        return;
+
+    issue();
+    state.blendEquation[0] = rgbOperation;
+    state.blendEquation[1] = alphaOperation;
+    glBlendEquationSeparate(rgbOperation, alphaOperation);
+}
+
+void StateCacheGL::blendFunc(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha)
+{
+    auto& current = state.blendFunc;
+    if (current[0] == sourceRGB && current[1] == destinationRGB &&
+        current[2] == sourceAlpha && current[3] == destinationAlpha && skip())
+        return;
+
+    issue();
+    current[0] = sourceRGB;
+    current[1] = destinationRGB;
+    current[2] = sourceAlpha;
+    current[3] = destinationAlpha;
+    glBlendFuncSeparate(sourceRGB, destinationRGB, sourceAlpha, destinationAlpha);
+}
+
+void StateCacheGL::colorMask(bool red, bool green, bool blue, bool alpha)
+{
+    auto& current = state.colorMask;
+    if (current[0] == (int8_t)red && current[1] == (int8_t)green &&
+        current[2] == (int8_t)blue && current[3] == (int8_t)alpha && skip())
+        return;
+
+    issue();
+    current[0] = red;
+    current[1] = green;
+    current[2] = blue;
+    current[3] = alpha;
+    glColorMask(red, green, blue, alpha);
+}
+
+void StateCacheGL::depthMask(bool enabled)
+{
+    if (state.depthMask == (int8_t)enabled && skip())
+        return;
+
+    issue();
+    state.depthMask = enabled;
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void StateCacheGL::depthFunc(GLenum function)
+{
+    if (state.depthFunc == function && skip())
+        return;
+
+    issue();
+    state.depthFunc = function;
+    glDepthFunc(function);
+}
+
+void StateCacheGL::cullFace(GLenum mode)
+{
+    if (state.cullFace == mode && skip())
+        return;
+
+    issue();
+    state.cullFace = mode;
+    glCullFace(mode);
+}
+
+void StateCacheGL::frontFace(GLenum mode)
+{
+    if (state.frontFace == mode && skip())
+        return;
+
+    issue();
+    state.frontFace = mode;
+    glFrontFace(mode);
+}
+
+void StateCacheGL::lineWidth(GLfloat width)
+{
+    if (state.lineWidth == width && skip())
+        return;
+
+    issue();
+    state.lineWidth = width;
+    glLineWidth(width);
+}
+
+void StateCacheGL::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    auto& current = state.viewport;
+    if (current.x == x && current.y == y && current.width == width && current.height == height && skip())
+        return;
+
+    issue();
+    current.x = x;
+    current.y = y;
+    current.width = width;
+    current.height = height;
+    glViewport(x, y, width, height);
+}
+
+void StateCacheGL::scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    auto& current = state.scissor;
+    if (current.x == x && current.y == y && current.width == width && current.height == height && skip())
+        return;
+
+    issue();
+    current.x = x;
+    current.y = y;
+    current.width = width;
+    current.height = height;
+    glScissor(x, y, width, height);
+}
+
+void StateCacheGL::stencilFunc(GLenum face, GLenum function, GLint reference, GLuint mask)
+{
+    bool same = updateStencilFaces(face,
+        [&](const StencilFaceState& s) { return s.function == function && s.reference == reference && s.readMask == mask; },
+        [&](StencilFaceState& s) { s.function = function; s.reference = reference; s.readMask = mask; });
+    if (same && skip())
+        return;
+
+    issue();
+    if (face == GL_FRONT_AND_BACK)
+        glStencilFunc(function, reference, mask);
+    else
+        glStencilFuncSeparate(face, function, reference, mask);
+}
+
+void StateCacheGL::stencilOp(GLenum face, GLenum stencilFailure, GLenum depthFailure, GLenum depthStencilPass)
+{
+    bool same = updateStencilFaces(face,
+        [&](const StencilFaceState& s) { return s.stencilFailure == stencilFailure && s.depthFailure == depthFailure && s.depthStencilPass == depthStencilPass; },
+        [&](StencilFaceState& s) { s.stencilFailure = stencilFailure; s.depthFailure = depthFailure; s.depthStencilPass = depthStencilPass; });
+    if (same && skip())
+        return;
+
+    issue();
+    if (face == GL_FRONT_AND_BACK)
+        glStencilOp(stencilFailure, depthFailure, depthStencilPass);
+    else
+        glStencilOpSeparate(face, stencilFailure, depthFailure, depthStencilPass);
+}
+
+void StateCacheGL::stencilMask(GLenum face, GLuint mask)
+{
+    bool same = updateStencilFaces(face,
+        [&](const StencilFaceState& s) { return s.writeMaskKnown && s.writeMask == mask; },
+        [&](StencilFaceState& s) { s.writeMask = mask; s.writeMaskKnown = true; });
+    if (same && skip())
+        return;
+
+    issue();
+    if (face == GL_FRONT_AND_BACK)
+        glStencilMask(mask);
+    else
+        glStencilMaskSeparate(face, mask);
+}
+
+void StateCacheGL::deleteProgram(GLuint program)
+{
+    if (state.program == program)
+        state.program = UNKNOWN;
+}
+
+void StateCacheGL::deleteBuffer(GLuint buffer)
+{
+    if (state.arrayBuffer == buffer)
+        state.arrayBuffer = 0;
+    if (state.elementArrayBuffer == buffer)
+        state.elementArrayBuffer = 0;
+}
+
+void StateCacheGL::deleteTexture(GLuint texture)
+{
+    for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+    {
+        if (state.textures2D[i] == texture)
+            state.textures2D[i] = 0;
+        if (state.texturesCube[i] == texture)
+            state.texturesCube[i] = 0;
+    }
+}
+
+void StateCacheGL::deleteVertexArray(GLuint vertexArray)
+{
+    if (state.vertexArray == vertexArray)
+        state.vertexArray = 0;
+}
+
+void StateCacheGL::deleteFramebuffer(GLuint framebuffer)
+{
+    if (state.framebuffer == framebuffer)
+        state.framebuffer = 0;
+}
+
+CC_BACKEND_END
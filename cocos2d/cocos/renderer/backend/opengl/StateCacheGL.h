@@ -0,0 +1,164 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+#pragma once
+
+#include "../Macros.h"
+#include "platform/CCGL.h"
+
+#include <cstdint>
+
+CC_BACKEND_BEGIN
+/**
+ * @addtogroup _opengl
+ * @{
+ */
+
+/**
+ * Shadow copy of the OpenGL context state touched by the backend.
+ * Every backend object binds programs, buffers, textures and fixed-function state through this class,
+ * so a call that would set a value which is already current is skipped instead of reaching the driver.
+ * Code that changes the same GL state directly must call `invalidate()` afterwards.
+ */
+class StateCacheGL
+{
+public:
+    /// Number of GL state calls issued and skipped by the cache during one frame.
+    struct FrameStats
+    {
+        unsigned int issuedCalls = 0;
+        unsigned int skippedCalls = 0;
+    };
+
+    /// The number of texture units whose bindings are tracked. Bindings to higher units are never skipped.
+    static const unsigned int MAX_TEXTURE_UNITS = 16;
+
+    /// Forget every cached value, so the next call of each kind is issued. Call it after changing GL state outside the backend or after the context is recreated.
+    static void invalidate();
+
+    /// Start counting a new frame. The counters of the frame that just ended are kept for `getLastFrameStats()`.
+    static void beginFrame();
+
+    /// Get the counters of the last completed frame.
+    static const FrameStats& getLastFrameStats();
+
+    /**
+     * Count state calls that were skipped or issued by a caller-side cache, i.e. the per-program uniform shadow copies.
+     * @param issued The number of calls that reached the driver.
+     * @param skipped The number of calls that were skipped.
+     */
+    static void countCalls(unsigned int issued, unsigned int skipped);
+
+    /// glUseProgram
+    static void useProgram(GLuint program);
+
+    /// glBindFramebuffer(GL_FRAMEBUFFER, ...)
+    static void bindFramebuffer(GLuint framebuffer);
+
+    /**
+     * glBindBuffer, GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are cached.
+     * The element array binding belongs to the bound vertex array object, so binding GL_ELEMENT_ARRAY_BUFFER
+     * switches back to vertex array object 0 first instead of overwriting the binding recorded in a cached one.
+     */
+    static void bindBuffer(GLenum target, GLuint buffer);
+
+    /// glBindVertexArray, only call it when vertex array objects are supported.
+    static void bindVertexArray(GLuint vertexArray);
+
+    /**
+     * Enable the vertex attribute arrays in the mask and disable the others that are enabled.
+     * The mask is the state of vertex array object 0, so only call it when no other vertex array object is bound.
+     * @param mask Bit i set means attribute location i is enabled.
+     */
+    static void enableVertexAttribArrays(uint32_t mask);
+
+    /**
+     * Bind a texture to a texture unit, switching the active texture unit only when needed.
+     * @param target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.
+     * @param texture The texture handler.
+     * @param unit The texture unit index, 0 means GL_TEXTURE0.
+     */
+    static void bindTexture(GLenum target, GLuint texture, unsigned int unit);
+
+    /// glEnable/glDisable, GL_BLEND, GL_DEPTH_TEST, GL_STENCIL_TEST, GL_CULL_FACE and GL_SCISSOR_TEST are cached.
+    static void setEnabled(GLenum capability, bool enabled);
+
+    /// glBlendEquationSeparate
+    static void blendEquation(GLenum rgbOperation, GLenum alphaOperation);
+
+    /// glBlendFuncSeparate
+    static void blendFunc(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha);
+
+    /// glColorMask
+    static void colorMask(bool red, bool green, bool blue, bool alpha);
+
+    /// glDepthMask
+    static void depthMask(bool enabled);
+
+    /// glDepthFunc
+    static void depthFunc(GLenum function);
+
+    /// glCullFace
+    static void cullFace(GLenum mode);
+
+    /// glFrontFace
+    static void frontFace(GLenum mode);
+
+    /// glLineWidth
+    static void lineWidth(GLfloat width);
+
+    /// glViewport
+    static void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    /// glScissor
+    static void scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    /// glStencilFuncSeparate, GL_FRONT_AND_BACK is issued as glStencilFunc.
+    static void stencilFunc(GLenum face, GLenum function, GLint reference, GLuint mask);
+
+    /// glStencilOpSeparate, GL_FRONT_AND_BACK is issued as glStencilOp.
+    static void stencilOp(GLenum face, GLenum stencilFailure, GLenum depthFailure, GLenum depthStencilPass);
+
+    /// glStencilMaskSeparate, GL_FRONT_AND_BACK is issued as glStencilMask.
+    static void stencilMask(GLenum face, GLuint mask);
+
+    /// Forget a deleted program. The GL object name may be reused by the next glCreateProgram.
+    static void deleteProgram(GLuint program);
+
+    /// Forget a deleted buffer, GL unbinds deleted buffers from every target.
+    static void deleteBuffer(GLuint buffer);
+
+    /// Forget a deleted texture, GL unbinds deleted textures from every unit.
+    static void deleteTexture(GLuint texture);
+
+    /// Forget a deleted vertex array object, GL binds vertex array object 0 when the bound one is deleted.
+    static void deleteVertexArray(GLuint vertexArray);
+
+    /// Forget a deleted framebuffer, GL binds the default framebuffer when the bound one is deleted.
+    static void deleteFramebuffer(GLuint framebuffer);
+};
+
+//end of _opengl group
+/// @}
+CC_BACKEND_END
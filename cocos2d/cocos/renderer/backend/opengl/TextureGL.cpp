@@ -30,6 +30,7 @@
 #include "base/CCDirector.h"
 #include "platform/CCPlatformConfig.h"
 #include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
 
 CC_BACKEND_BEGIN
 
@@ -122,7 +123,10 @@ void Texture2DGL::updateTextureDescriptor(const cocos2d::backend::TextureDescrip
 Texture2DGL::~Texture2DGL()
 {
     if (_textureInfo.texture)
+    {
+        StateCacheGL::deleteTexture(_textureInfo.texture);
         glDeleteTextures(1, &_textureInfo.texture);
+    }
     _textureInfo.texture = 0;
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
@@ -133,8 +137,7 @@ void Texture2DGL::updateSamplerDescriptor(const SamplerDescriptor &sampler) {
     bool isPow2 = ISPOW2(_width) && ISPOW2(_height);
     _textureInfo.applySamplerDescriptor(sampler, isPow2, _hasMipmaps);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_2D, _textureInfo.texture, 0);
 
     if (sampler.magFilter != SamplerFilter::DONT_CARE)
     {
@@ -187,8 +190,7 @@ void Texture2DGL::updateData(uint8_t* data, std::size_t width , std::size_t heig
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_2D, _textureInfo.texture, 0);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _textureInfo.magFilterGL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _textureInfo.minFilterGL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _textureInfo.sAddressModeGL);
@@ -215,8 +217,7 @@ void Texture2DGL::updateCompressedData(uint8_t *data, std::size_t width, std::si
 {
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_2D, _textureInfo.texture, 0);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _textureInfo.magFilterGL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _textureInfo.minFilterGL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _textureInfo.sAddressModeGL);
@@ -239,8 +240,7 @@ void Texture2DGL::updateCompressedData(uint8_t *data, std::size_t width, std::si
 
 void Texture2DGL::updateSubData(std::size_t xoffset, std::size_t yoffset, std::size_t width, std::size_t height, std::size_t level, uint8_t* data)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_2D, _textureInfo.texture, 0);
 
     glTexSubImage2D(GL_TEXTURE_2D,
                     level,
@@ -261,8 +261,7 @@ void Texture2DGL::updateCompressedSubData(std::size_t xoffset, std::size_t yoffs
                                           std::size_t height, std::size_t dataLen, std::size_t level,
                                           uint8_t *data)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_2D, _textureInfo.texture, 0);
 
     glCompressedTexSubImage2D(GL_TEXTURE_2D,
                               level,
@@ -281,8 +280,7 @@ void Texture2DGL::updateCompressedSubData(std::size_t xoffset, std::size_t yoffs
 
 void Texture2DGL::apply(int index) const
 {
-    glActiveTexture(GL_TEXTURE0 + index);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_2D, _textureInfo.texture, index);
 }
 
 void Texture2DGL::generateMipmaps()
@@ -293,7 +291,7 @@ void Texture2DGL::generateMipmaps()
     if(!_hasMipmaps)
     {
         _hasMipmaps = true;
-        glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+        StateCacheGL::bindTexture(GL_TEXTURE_2D, _textureInfo.texture, 0);
         glGenerateMipmap(GL_TEXTURE_2D);
     }
 }
@@ -305,7 +303,7 @@ void Texture2DGL::getBytes(std::size_t x, std::size_t y, std::size_t width, std:
 
     GLuint frameBuffer = 0;
     glGenFramebuffers(1, &frameBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+    StateCacheGL::bindFramebuffer(frameBuffer);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _textureInfo.texture, 0);
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
@@ -330,7 +328,8 @@ void Texture2DGL::getBytes(std::size_t x, std::size_t y, std::size_t width, std:
         CC_SAFE_DELETE_ARRAY(image);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
+    StateCacheGL::bindFramebuffer(defaultFBO);
+    StateCacheGL::deleteFramebuffer(frameBuffer);
     glDeleteFramebuffers(1, &frameBuffer);
 }
 
@@ -356,15 +355,14 @@ TextureCubeGL::TextureCubeGL(const TextureDescriptor& descriptor)
 
 void TextureCubeGL::setTexParameters()
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture, 0);
 
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, _textureInfo.minFilterGL);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, _textureInfo.magFilterGL);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, _textureInfo.sAddressModeGL);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, _textureInfo.tAddressModeGL);
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, 0, 0);
 }
 
 void TextureCubeGL::updateTextureDescriptor(const cocos2d::backend::TextureDescriptor &descriptor)
@@ -377,7 +375,10 @@ void TextureCubeGL::updateTextureDescriptor(const cocos2d::backend::TextureDescr
 TextureCubeGL::~TextureCubeGL()
 {
     if(_textureInfo.texture)
+    {
+        StateCacheGL::deleteTexture(_textureInfo.texture);
         glDeleteTextures(1, &_textureInfo.texture);
+    }
     _textureInfo.texture = 0;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -393,15 +394,13 @@ void TextureCubeGL::updateSamplerDescriptor(const SamplerDescriptor &sampler)
 
 void TextureCubeGL::apply(int index) const
 {
-    glActiveTexture(GL_TEXTURE0+ index);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture, index);
     CHECK_GL_ERROR_DEBUG();
 }
 
 void TextureCubeGL::updateFaceData(TextureCubeFace side, void *data)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture, 0);
     CHECK_GL_ERROR_DEBUG();
     int i = static_cast<int>(side);
     glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
@@ -415,7 +414,7 @@ void TextureCubeGL::updateFaceData(TextureCubeFace side, void *data)
         data);              // pixel data
 
     CHECK_GL_ERROR_DEBUG();
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, 0, 0);
 }
 
 void TextureCubeGL::getBytes(std::size_t x, std::size_t y, std::size_t width, std::size_t height, bool flipImage, std::function<void(const unsigned char*, std::size_t, std::size_t)> callback)
@@ -424,7 +423,7 @@ void TextureCubeGL::getBytes(std::size_t x, std::size_t y, std::size_t width, st
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFBO);
     GLuint frameBuffer = 0;
     glGenFramebuffers(1, &frameBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+    StateCacheGL::bindFramebuffer(frameBuffer);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP, _textureInfo.texture, 0);
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
@@ -449,7 +448,8 @@ void TextureCubeGL::getBytes(std::size_t x, std::size_t y, std::size_t width, st
         CC_SAFE_DELETE_ARRAY(image);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
+    StateCacheGL::bindFramebuffer(defaultFBO);
+    StateCacheGL::deleteFramebuffer(frameBuffer);
     glDeleteFramebuffers(1, &frameBuffer);
 }
 
@@ -461,7 +461,7 @@ void TextureCubeGL::generateMipmaps()
     if(!_hasMipmaps)
     {
         _hasMipmaps = true;
-        glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
+        StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture, 0);
         glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
     }
 }
@@ -28,6 +28,11 @@
 #include "platform/CCGL.h"
 #include "renderer/backend/Types.h"
 
+// instanced arrays are not declared by opengl es 2.0 headers, instanced commands are emulated there.
+#if defined(GL_VERTEX_ATTRIB_ARRAY_DIVISOR)
+#define CC_GL_INSTANCING 1
+#endif
+
 CC_BACKEND_BEGIN
 /**
  * @addtogroup _opengl
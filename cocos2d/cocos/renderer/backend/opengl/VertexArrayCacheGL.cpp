@@ -0,0 +1,164 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+#include "VertexArrayCacheGL.h"
+#include "StateCacheGL.h"
+#include "UtilsGL.h"
+#include "../VertexLayout.h"
+#include "base/CCConfiguration.h"
+
+#include <functional>
+
+CC_BACKEND_BEGIN
+
+std::unordered_map<VertexArrayCacheGL::Key, VertexArrayCacheGL::Entry, VertexArrayCacheGL::KeyHash> VertexArrayCacheGL::_entries;
+
+std::size_t VertexArrayCacheGL::KeyHash::operator()(const Key& key) const
+{
+    std::size_t hash = key.layoutHash;
+    hash ^= std::hash<GLuint>()(key.vertexBuffer) + 0x9E3779B9u + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<GLuint>()(key.indexBuffer) + 0x9E3779B9u + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+bool VertexArrayCacheGL::isSupported()
+{
+    // GPU info is gathered when the view is set, which happens before the first draw.
+    static const bool supported = Configuration::getInstance()->supportsShareableVAO() && glGenVertexArrays != nullptr;
+    return supported;
+}
+
+void VertexArrayCacheGL::bind(const VertexLayout& layout, GLuint vertexBuffer, GLuint indexBuffer)
+{
+    Key key = {layout.getHash(), vertexBuffer, indexBuffer};
+    auto& entry = _entries[key];
+    if (entry.vertexArray == 0 || !matches(entry, layout))
+        build(entry, layout, vertexBuffer, indexBuffer);
+    else
+        StateCacheGL::bindVertexArray(entry.vertexArray);
+}
+
+void VertexArrayCacheGL::removeBuffer(GLuint buffer)
+{
+    for (auto iter = _entries.begin(); iter != _entries.end();)
+    {
+        if (iter->first.vertexBuffer == buffer || iter->first.indexBuffer == buffer)
+        {
+            StateCacheGL::deleteVertexArray(iter->second.vertexArray);
+            glDeleteVertexArrays(1, &iter->second.vertexArray);
+            iter = _entries.erase(iter);
+        }
+        else
+            ++iter;
+    }
+}
+
+void VertexArrayCacheGL::reset()
+{
+    _entries.clear();
+}
+
+bool VertexArrayCacheGL::matches(const Entry& entry, const VertexLayout& layout)
+{
+    return entry.stride == layout.getStride() &&
+           matches(entry.attributes, layout.getAttributes()) &&
+           matches(entry.instanceAttributes, layout.getInstanceAttributes());
+}
+
+bool VertexArrayCacheGL::matches(const std::vector<AttributeFormat>& formats, const std::unordered_map<std::string, VertexLayout::Attribute>& attributes)
+{
+    if (formats.size() != attributes.size())
+        return false;
+
+    for (const auto& iter : attributes)
+    {
+        const auto& attribute = iter.second;
+        bool found = false;
+        for (const auto& format : formats)
+        {
+            if (format.index == attribute.index)
+            {
+                found = format.offset == attribute.offset &&
+                        format.format == static_cast<int>(attribute.format) &&
+                        format.normalized == attribute.needToBeNormallized;
+                break;
+            }
+        }
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+void VertexArrayCacheGL::build(Entry& entry, const VertexLayout& layout, GLuint vertexBuffer, GLuint indexBuffer)
+{
+    if (entry.vertexArray == 0)
+        glGenVertexArrays(1, &entry.vertexArray);
+
+    // A vertex array object records the attribute pointers together with the buffer bound to GL_ARRAY_BUFFER
+    // at the time, and the element array binding itself. A rebuilt object may still have old attributes enabled.
+    StateCacheGL::bindVertexArray(entry.vertexArray);
+    StateCacheGL::bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+    for (const auto& format : entry.attributes)
+        glDisableVertexAttribArray(format.index);
+#if CC_GL_INSTANCING
+    for (const auto& format : entry.instanceAttributes)
+    {
+        glDisableVertexAttribArray(format.index);
+        glVertexAttribDivisor(format.index, 0);
+    }
+#endif
+
+    entry.stride = layout.getStride();
+    entry.attributes.clear();
+    for (const auto& iter : layout.getAttributes())
+    {
+        const auto& attribute = iter.second;
+        glEnableVertexAttribArray(attribute.index);
+        glVertexAttribPointer(attribute.index,
+            UtilsGL::getGLAttributeSize(attribute.format),
+            UtilsGL::toGLAttributeType(attribute.format),
+            attribute.needToBeNormallized,
+            entry.stride,
+            (GLvoid*)attribute.offset);
+
+        entry.attributes.push_back({attribute.index, attribute.offset, static_cast<int>(attribute.format), attribute.needToBeNormallized});
+    }
+
+    entry.instanceAttributes.clear();
+#if CC_GL_INSTANCING
+    for (const auto& iter : layout.getInstanceAttributes())
+    {
+        const auto& attribute = iter.second;
+        glEnableVertexAttribArray(attribute.index);
+        glVertexAttribDivisor(attribute.index, 1);
+        entry.instanceAttributes.push_back({attribute.index, attribute.offset, static_cast<int>(attribute.format), attribute.needToBeNormallized});
+    }
+#endif
+    CHECK_GL_ERROR_DEBUG();
+}
+
+CC_BACKEND_END
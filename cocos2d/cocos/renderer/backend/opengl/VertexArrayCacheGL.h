@@ -0,0 +1,111 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+#pragma once
+
+#include "../Macros.h"
+#include "platform/CCGL.h"
+#include "../VertexLayout.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+CC_BACKEND_BEGIN
+
+
+/**
+ * @addtogroup _opengl
+ * @{
+ */
+
+/**
+ * Vertex array objects baked from a vertex layout and the vertex/index buffers it reads, so that switching
+ * between batches of different commands is a single glBindVertexArray instead of re-specifying every attribute.
+ * Only used when the context supports vertex array objects, see `Configuration::supportsShareableVAO()`.
+ */
+class VertexArrayCacheGL
+{
+public:
+    /// Whether vertex array objects are supported and enabled.
+    static bool isSupported();
+
+    /**
+     * Bind the vertex array object for the given layout and buffers, creating it on first use.
+     * @param layout The vertex layout, its attribute indexes are the attribute locations.
+     * @param vertexBuffer The vertex buffer handler.
+     * @param indexBuffer The index buffer handler, 0 when drawing without indexes.
+     */
+    static void bind(const VertexLayout& layout, GLuint vertexBuffer, GLuint indexBuffer);
+
+    /// Delete every vertex array object that reads the buffer, GL may reuse the buffer name once it is deleted.
+    static void removeBuffer(GLuint buffer);
+
+    /// Forget every vertex array object without deleting it, used when the GL context was lost together with them.
+    static void reset();
+
+private:
+    struct Key
+    {
+        std::size_t layoutHash;
+        GLuint vertexBuffer;
+        GLuint indexBuffer;
+
+        bool operator==(const Key& other) const
+        {
+            return layoutHash == other.layoutHash && vertexBuffer == other.vertexBuffer && indexBuffer == other.indexBuffer;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct AttributeFormat
+    {
+        std::size_t index;
+        std::size_t offset;
+        int format;
+        bool normalized;
+    };
+
+    struct Entry
+    {
+        GLuint vertexArray = 0;
+        std::size_t stride = 0;
+        std::vector<AttributeFormat> attributes; ///< kept to tell layouts apart when their hashes collide
+        std::vector<AttributeFormat> instanceAttributes; ///< enabled with a divisor of 1, their pointers are set for each draw
+    };
+
+    static bool matches(const Entry& entry, const VertexLayout& layout);
+    static bool matches(const std::vector<AttributeFormat>& formats, const std::unordered_map<std::string, VertexLayout::Attribute>& attributes);
+    static void build(Entry& entry, const VertexLayout& layout, GLuint vertexBuffer, GLuint indexBuffer);
+
+    static std::unordered_map<Key, Entry, KeyHash> _entries;
+};
+
+//end of _opengl group
+/// @}
+CC_BACKEND_END
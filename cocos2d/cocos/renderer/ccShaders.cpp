@@ -36,6 +36,7 @@ NS_CC_BEGIN
 #include "renderer/shaders/positionTexture.frag"
 #include "renderer/shaders/positionTextureColor.vert"
 #include "renderer/shaders/positionTextureColor.frag"
+#include "renderer/shaders/positionTextureColorInstanced.vert"
 #include "renderer/shaders/positionTextureColorAlphaTest.frag"
 #include "renderer/shaders/label_normal.frag"
 #include "renderer/shaders/label_distanceNormal.frag"
@@ -43,6 +43,7 @@ extern CC_DLL const char * positionTexture_vert;
 extern CC_DLL const char * positionTexture_frag;
 extern CC_DLL const char * positionTextureColor_vert;
 extern CC_DLL const char * positionTextureColor_frag;
+extern CC_DLL const char * positionTextureColorInstanced_vert;
 extern CC_DLL const char * positionTextureColorAlphaTest_frag;
 extern CC_DLL const char * label_normal_frag;
 extern CC_DLL const char * label_distanceNormal_frag;
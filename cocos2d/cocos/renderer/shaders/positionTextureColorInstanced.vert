@@ -0,0 +1,52 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+// a_position is a corner of the unit quad, every other attribute is read once per instance.
+// The quad corner (s, t) maps to origin + s * axisX + t * axisY, in world space and in texture space.
+const char* positionTextureColorInstanced_vert = R"(
+attribute vec2 a_position;
+attribute vec3 a_instanceOrigin;
+attribute vec4 a_instanceAxes;
+attribute vec2 a_instanceTexOrigin;
+attribute vec4 a_instanceTexAxes;
+attribute vec4 a_instanceColor;
+
+uniform mat4 u_MVPMatrix;
+
+#ifdef GL_ES
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+#else
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+#endif
+
+void main()
+{
+    vec2 position = a_instanceOrigin.xy + a_position.x * a_instanceAxes.xy + a_position.y * a_instanceAxes.zw;
+    gl_Position = u_MVPMatrix * vec4(position, a_instanceOrigin.z, 1.0);
+    v_fragmentColor = a_instanceColor;
+    v_texCoord = a_instanceTexOrigin + a_position.x * a_instanceTexAxes.xy + a_position.y * a_instanceTexAxes.zw;
+}
+)";
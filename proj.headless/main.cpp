@@ -0,0 +1,491 @@
+#include "cocos2d.h"
+#include "audio/include/AudioEngine.h"
+#include "ShapeGameScene.h"
+#include "ShapePool.h"
+#include "ShapeTextureAtlas.h"
+#include "ShapeGeometry.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/BufferGL.h"
+#include "renderer/backend/Device.h"
+#include "math/MathUtil.inl" // 스칼라 경로(MathUtilC)와 비교하기 위해 직접 포함
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+// 창을 띄우지 않고 ShapeGameScene을 고정 프레임으로 돌리면서 성능을 측정하는 헤드리스 드라이버
+// GPU가 없는 리눅스 머신에서는 Xvfb + Mesa(llvmpipe) 위에서 실행: xvfb-run ./samplemap_bench --frames 3600
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        int frames = 3600;
+        int spawnInterval = 2;     // 몇 프레임마다 터치를 넣을지
+        Size boxSize = Size(2000.0f, 2000.0f);
+        std::string replayPath;    // 지정하면 스크립트 대신 기록된 입력을 재생
+    };
+
+    void PrintUsage(const char* program)
+    {
+        printf("usage: %s [--frames N] [--spawn-interval N] [--box WxH] [--replay FILE]\n", program);
+    }
+
+    bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool hasValue = (i + 1 < argc);
+
+            if (arg == "--frames" && hasValue)
+                options.frames = atoi(argv[++i]);
+
+            else if (arg == "--spawn-interval" && hasValue)
+                options.spawnInterval = std::max(1, atoi(argv[++i]));
+
+            else if (arg == "--box" && hasValue)
+            {
+                float width = 0.0f;
+                float height = 0.0f;
+
+                if (sscanf(argv[++i], "%fx%f", &width, &height) != 2 || width <= 0.0f || height <= 0.0f)
+                    return false;
+
+                options.boxSize = Size(width, height);
+            }
+
+            else if (arg == "--replay" && hasValue)
+                options.replayPath = argv[++i];
+
+            else
+                return false;
+        }
+
+        return options.frames > 0;
+    }
+
+    double Percentile(std::vector<double> samples, double percent)
+    {
+        if (samples.empty())
+            return 0.0;
+
+        std::sort(samples.begin(), samples.end());
+
+        size_t index = (size_t)std::ceil(percent / 100.0 * samples.size());
+
+        return samples[std::min(samples.size(), std::max<size_t>(index, 1)) - 1];
+    }
+
+    double Mean(const std::vector<double>& samples)
+    {
+        if (samples.empty())
+            return 0.0;
+
+        double sum = 0.0;
+
+        for (double sample : samples)
+            sum += sample;
+
+        return sum / samples.size();
+    }
+
+    // 배치 커널을 SIMD 경로(MathUtil)와 스칼라 경로(MathUtilC)로 같은 입력에 돌린 결과
+    struct KernelComparison
+    {
+        double simdMs = 0.0;   // 한 번 호출에 걸린 평균 시간
+        double scalarMs = 0.0;
+        bool equal = true;     // 두 경로의 출력이 비트 단위로 같은지
+    };
+
+    template <typename Kernel>
+    double TimeKernel(int iterations, Kernel kernel)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < iterations; i++)
+            kernel();
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+
+    KernelComparison CompareVertexTransform(size_t count, int iterations)
+    {
+        std::vector<V3F_C4B_T2F> src(count);
+        std::vector<V3F_C4B_T2F> simd(count);
+        std::vector<V3F_C4B_T2F> scalar(count);
+
+        // 배치에 들어가는 스프라이트와 비슷한 범위의 고정된 입력
+        for (size_t i = 0; i < count; i++)
+        {
+            src[i].vertices.set((float)(i % 1024) * 1.37f + 0.1f, (float)(i / 1024) * 3.13f - 0.7f, (float)(i % 7) * 0.3f);
+            src[i].colors = Color4B((GLubyte)i, (GLubyte)(i >> 8), (GLubyte)(i * 3), 255);
+            src[i].texCoords = Tex2F((float)(i % 64) / 64.0f, (float)(i % 32) / 32.0f);
+        }
+
+        Mat4 transform;
+        Mat4::createTranslation(123.5f, -45.25f, 0.0f, &transform);
+        transform.rotateZ(0.3f);
+        transform.rotateY(0.2f);
+        transform.scale(1.5f, 0.75f, 1.0f);
+
+        KernelComparison result;
+        result.simdMs = TimeKernel(iterations, [&]() { MathUtil::transformVertices(simd.data(), src.data(), count, transform); });
+        result.scalarMs = TimeKernel(iterations, [&]() { MathUtilC::transformVertices(transform.m, scalar.data(), src.data(), count); });
+        result.equal = memcmp(simd.data(), scalar.data(), count * sizeof(V3F_C4B_T2F)) == 0;
+
+        return result;
+    }
+
+    template <typename Index>
+    KernelComparison CompareIndexTransform(size_t count, int iterations, Index offset)
+    {
+        std::vector<unsigned short> src(count);
+        std::vector<Index> simd(count);
+        std::vector<Index> scalar(count);
+
+        for (size_t i = 0; i < count; i++)
+            src[i] = (unsigned short)((i / 6) * 4 + i % 6 % 4);
+
+        KernelComparison result;
+        result.simdMs = TimeKernel(iterations, [&]() { MathUtil::transformIndices(simd.data(), src.data(), count, offset); });
+        result.scalarMs = TimeKernel(iterations, [&]() { MathUtilC::transformIndices(scalar.data(), src.data(), count, offset); });
+        result.equal = memcmp(simd.data(), scalar.data(), count * sizeof(Index)) == 0;
+
+        return result;
+    }
+
+    void PrintKernelComparison(const char* label, const KernelComparison& comparison)
+    {
+        printf("  %s: simd %.3f  scalar %.3f (%.2fx), results %s\n", label, comparison.simdMs, comparison.scalarMs,
+            comparison.simdMs > 0.0 ? comparison.scalarMs / comparison.simdMs : 0.0, comparison.equal ? "equal" : "DIFFER");
+    }
+
+    // 스트리밍 링 버퍼 검사 결과
+    struct StreamStressResult
+    {
+        int ranges = 0;
+        int largeRanges = 0;   // 한 영역(_size / STREAM_REGION_COUNT)보다 큰 범위 수
+        int corruptedRanges = 0;
+    };
+
+    // 영역보다 큰 범위를 작은 범위 사이에 섞어 링에 예약하고, 각 범위를 GPU 복사로 읽게 한 뒤
+    // 복사된 값이 쓴 값과 같은지 확인 (펜스 없이 덮어쓴 범위가 있으면 값이 달라짐)
+    StreamStressResult StressStreamRing(int rangeCount)
+    {
+        const std::size_t ringSize = 64 * 1024;
+        const std::size_t regionSize = ringSize / backend::BufferGL::STREAM_REGION_COUNT;
+        const std::size_t rangeSizes[] = { regionSize / 4, regionSize * 2 + regionSize / 2, regionSize / 8, regionSize + 64 };
+
+        StreamStressResult result;
+        std::vector<std::pair<std::size_t, std::size_t>> ranges; // (링 안의 오프셋, 크기)
+        std::size_t totalSize = 0;
+
+        for (int i = 0; i < rangeCount; i++)
+            totalSize += rangeSizes[i % 4];
+
+        auto ring = static_cast<backend::BufferGL*>(backend::Device::getInstance()->newBuffer(ringSize, backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC));
+
+        if (ring == nullptr)
+            return result;
+
+        GLuint copy = 0;
+        glGenBuffers(1, &copy);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, copy);
+        glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_STREAM_READ);
+
+        std::size_t copyOffset = 0;
+
+        for (int i = 0; i < rangeCount; i++)
+        {
+            std::size_t size = rangeSizes[i % 4];
+            std::size_t offset = 0;
+            auto words = static_cast<uint32_t*>(ring->reserveStreamRange(size, sizeof(uint32_t), offset));
+
+            if (words == nullptr)
+                break;
+
+            for (std::size_t word = 0; word < size / sizeof(uint32_t); word++)
+                words[word] = ((uint32_t)i << 16) ^ (uint32_t)word;
+
+            ring->commitStreamRange(size);
+
+            // 그리기 대신 이 범위를 읽는 GPU 명령을 쌓아 둠
+            glBindBuffer(GL_COPY_READ_BUFFER, ring->getHandler());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, copyOffset, size);
+
+            ranges.push_back(std::make_pair(copyOffset, size));
+            copyOffset += size;
+            result.ranges++;
+
+            if (size > regionSize)
+                result.largeRanges++;
+        }
+
+        std::vector<uint32_t> copied(totalSize / sizeof(uint32_t));
+        glGetBufferSubData(GL_COPY_WRITE_BUFFER, 0, totalSize, copied.data());
+
+        for (int i = 0; i < result.ranges; i++)
+        {
+            const uint32_t* words = copied.data() + ranges[i].first / sizeof(uint32_t);
+
+            for (std::size_t word = 0; word < ranges[i].second / sizeof(uint32_t); word++)
+            {
+                if (words[word] != (((uint32_t)i << 16) ^ (uint32_t)word))
+                {
+                    result.corruptedRanges++;
+                    break;
+                }
+            }
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &copy);
+        ring->release();
+
+        return result;
+    }
+
+    long GetPeakMemoryKB()
+    {
+        struct rusage usage;
+
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+
+        return usage.ru_maxrss; // 리눅스에서는 KB 단위
+    }
+}
+
+class BenchmarkApp : public Application
+{
+public:
+    explicit BenchmarkApp(const BenchmarkOptions& options)
+        : options(options)
+    {
+    }
+
+    virtual void initGLContextAttrs() override
+    {
+        GLContextAttrs glContextAttrs = {8, 8, 8, 8, 24, 8, 0};
+
+        GLView::setGLContextAttrs(glContextAttrs);
+    }
+
+    virtual bool applicationDidFinishLaunching() override
+    {
+        auto director = Director::getInstance();
+
+        // 작은 보이지 않는 창에 그리고, 디자인 해상도를 박스 크기에 맞춰 키워 박스가 화면 비율에 잘리지 않게 함
+        auto glview = GLViewImpl::createOffscreen("Shape Merge Benchmark", Rect(0, 0, 640, 640));
+
+        if (glview == nullptr)
+            return false;
+
+        director->setOpenGLView(glview);
+        director->setDisplayStats(false);
+        director->setAnimationInterval(1.0f / 60);
+        director->getRenderer()->setBatchReorderingEnabled(true);
+        director->getRenderer()->setFrameTimingEnabled(true);
+
+        glview->setDesignResolutionSize(options.boxSize.width / 0.5f, options.boxSize.height / 0.7f, ResolutionPolicy::EXACT_FIT);
+
+        // 사운드 장치가 없는 머신에서 매 합치기마다 오디오 초기화를 시도하지 않도록 끔
+        AudioEngine::setEnabled(false);
+
+        ShapeGameScene::SetMaxBoxSize(options.boxSize);
+        ShapeGameScene::SetSnapshotEnabled(false); // 매번 같은 빈 보드에서 시작
+
+        auto scene = ShapeGameScene::CreateScene(options.replayPath);
+
+        for (auto child : scene->getChildren())
+        {
+            gameLayer = dynamic_cast<ShapeGameScene*>(child);
+
+            if (gameLayer != nullptr)
+                break;
+        }
+
+        director->runWithScene(scene);
+
+        return gameLayer != nullptr;
+    }
+
+    virtual void applicationDidEnterBackground() override {}
+    virtual void applicationWillEnterForeground() override {}
+
+    ShapeGameScene* GetGameLayer() const { return gameLayer; }
+
+private:
+    BenchmarkOptions options;
+    ShapeGameScene* gameLayer = nullptr;
+};
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    BenchmarkApp app(options);
+    app.initGLContextAttrs();
+
+    if (!app.applicationDidFinishLaunching())
+    {
+        fprintf(stderr, "benchmark: failed to create the offscreen view or the game scene\n");
+        return 1;
+    }
+
+    auto director = Director::getInstance();
+    auto glview = director->getOpenGLView();
+    auto gameLayer = app.GetGameLayer();
+    auto pool = ShapePool::GetInstance();
+
+    const float frameDelta = 1.0f / 60;
+    const bool scripted = options.replayPath.empty();
+
+    // 첫 프레임에서 씬이 실제로 올라가므로 측정 전에 한 번 돌리고 풀 통계를 초기화
+    director->mainLoop(frameDelta);
+    pool->ResetStats();
+
+    // mainLoop이 매 프레임 비우는 오토릴리즈 풀 (타입별 집계 포함)
+    auto autoreleasePool = PoolManager::getInstance()->getCurrentPool();
+    autoreleasePool->setTypeStatsEnabled(true);
+    autoreleasePool->resetStats();
+
+    SimulationStats startStats = gameLayer->GetStats();
+    SimulationStats previousStats = startStats;
+
+    std::vector<double> frameMs;
+    std::vector<double> physicsMs;
+    std::vector<double> glCalls;
+    std::vector<double> skippedGLCalls;
+    std::vector<double> drawnBatches;
+    std::vector<double> savedBatches;
+    std::vector<double> autoreleased;
+    frameMs.reserve(options.frames);
+    physicsMs.reserve(options.frames);
+    glCalls.reserve(options.frames);
+    skippedGLCalls.reserve(options.frames);
+    drawnBatches.reserve(options.frames);
+    savedBatches.reserve(options.frames);
+    autoreleased.reserve(options.frames);
+
+    int spawnIndex = 0;
+    int peakActiveShapes = 0;
+
+    auto benchStart = std::chrono::steady_clock::now();
+
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        // 스크립트 입력: 박스 윗부분을 황금비 간격으로 훑으며 삼각형 생성 (게임 오버 시 다음 터치가 재시작)
+        if (scripted && frame % options.spawnInterval == 0)
+        {
+            Rect box = gameLayer->GetBoxRect();
+            float margin = 40.0f;
+            float t = std::fmod(spawnIndex * 0.61803398875f, 1.0f);
+
+            gameLayer->QueueTouch(Vec2(box.getMinX() + margin + t * (box.size.width - margin * 2), box.getMaxY() - margin));
+            spawnIndex++;
+        }
+
+        auto frameStart = std::chrono::steady_clock::now();
+
+        glview->pollEvents();
+        director->mainLoop(frameDelta);
+
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+        const SimulationStats& stats = gameLayer->GetStats();
+        physicsMs.push_back((stats.physicsSeconds - previousStats.physicsSeconds) * 1000.0);
+        previousStats = stats;
+
+        // 상태 캐시는 다음 프레임 시작 시 직전 프레임 카운터를 넘겨주므로 한 프레임 늦게 집계됨
+        const auto& glStats = backend::StateCacheGL::getLastFrameStats();
+        glCalls.push_back(glStats.issuedCalls);
+        skippedGLCalls.push_back(glStats.skippedCalls);
+
+        auto renderer = director->getRenderer();
+        drawnBatches.push_back((double)renderer->getDrawnBatches());
+        savedBatches.push_back((double)renderer->getReorderSavedBatches());
+        autoreleased.push_back((double)autoreleasePool->getStats().frameCount);
+
+        peakActiveShapes = std::max(peakActiveShapes, pool->GetActiveCount());
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - benchStart).count();
+
+    const SimulationStats& endStats = gameLayer->GetStats();
+    uint32_t steps = endStats.steps - startStats.steps;
+    uint32_t merges = endStats.merges - startStats.merges;
+    double simulatedSeconds = (double)steps / 60.0;
+
+    int hits = pool->GetHitCount();
+    int misses = pool->GetMissCount();
+
+    printf("Shape Merge headless benchmark\n");
+    printf("  frames            : %d (%u physics steps, %.1f s simulated, %.2f s wall)\n", options.frames, steps, simulatedSeconds, wallSeconds);
+    printf("  box               : %.0fx%.0f, %s\n", options.boxSize.width, options.boxSize.height, scripted ? "scripted input" : options.replayPath.c_str());
+    printf("  frame time (ms)   : mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+        Mean(frameMs), Percentile(frameMs, 50), Percentile(frameMs, 90), Percentile(frameMs, 99), Percentile(frameMs, 100));
+    printf("  physics/frame (ms): mean %.3f  p50 %.3f  p99 %.3f  max %.3f\n",
+        Mean(physicsMs), Percentile(physicsMs, 50), Percentile(physicsMs, 99), Percentile(physicsMs, 100));
+    printf("  GL state/frame    : mean %.1f issued, %.1f skipped by the state cache\n", Mean(glCalls), Mean(skippedGLCalls));
+    printf("  batches/frame     : mean %.1f drawn, %.1f saved by reordering\n", Mean(drawnBatches), Mean(savedBatches));
+
+    // 렌더러는 최근 FRAME_TIMINGS_HISTORY 프레임만 보관하므로 마지막 구간의 평균
+    auto timings = director->getRenderer()->getAverageFrameTimings();
+    printf("  render/frame (ms) : visit %.3f  sort %.3f  upload %.3f  draw %.3f (last %d frames)\n",
+        timings.visitTime, timings.sortTime, timings.uploadTime, timings.drawTime, Renderer::FRAME_TIMINGS_HISTORY);
+
+    if (timings.gpuTime >= 0.0)
+        printf("  GPU/frame (ms)    : total %.3f  render targets %.3f  clears %.3f\n", timings.gpuTime, timings.gpuGroupTime, timings.gpuClearTime);
+    else
+        printf("  GPU/frame (ms)    : %s\n", director->getRenderer()->isGPUTimingSupported() ? "no results yet" : "timer queries not supported");
+
+    printf("  autorelease/frame : mean %.1f  max %.0f", Mean(autoreleased), Percentile(autoreleased, 100));
+
+    for (const auto& type : autoreleasePool->getTopTypes(3))
+        printf("  %s x%zu", type.first.c_str(), type.second);
+
+    printf(" (top types of the last frame)\n");
+
+    // 렌더러가 배치마다 쓰는 커널을 VBO_SIZE 크기 입력으로 비교
+    PrintKernelComparison("vertex xform (ms) ", CompareVertexTransform(Renderer::VBO_SIZE, 200));
+    PrintKernelComparison("index16 (ms)      ", CompareIndexTransform<unsigned short>(Renderer::INDEX_VBO_SIZE, 200, 1000));
+    PrintKernelComparison("index32 (ms)      ", CompareIndexTransform<unsigned int>(Renderer::INDEX_VBO_SIZE, 200, 100000));
+
+    auto streamStress = StressStreamRing(256);
+    printf("  stream ring       : %d ranges (%d larger than a region), %d corrupted\n",
+        streamStress.ranges, streamStress.largeRanges, streamStress.corruptedRanges);
+
+    printf("  merges            : %u (%.1f per simulated s, %.1f per wall s)\n",
+        merges, simulatedSeconds > 0.0 ? merges / simulatedSeconds : 0.0, wallSeconds > 0.0 ? merges / wallSeconds : 0.0);
+    printf("  pool              : %d hits, %d misses (%.1f%% hit rate), %d shapes allocated\n",
+        hits, misses, (hits + misses) > 0 ? 100.0 * hits / (hits + misses) : 0.0, pool->GetTotalCount());
+    printf("  shapes            : peak %d active, %u game overs\n", peakActiveShapes, endStats.gameOvers - startStats.gameOvers);
+    printf("  peak memory       : %.1f MB\n", GetPeakMemoryKB() / 1024.0);
+
+    // Application::run과 같은 순서로 정리
+    director->end();
+    director->mainLoop();
+
+    ShapePool::DestroyInstance();
+    ShapeTextureAtlas::DestroyInstance();
+    ShapeGeometry::Clear();
+
+    return 0;
+}